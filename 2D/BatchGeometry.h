@@ -0,0 +1,476 @@
+#ifndef BATCHGEOMETRY_H
+#define BATCHGEOMETRY_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name:   BatchGeometry.h
+//
+//  Desc:   versions of the geometry.h and Transformations.h functions
+//          that test many points (or segments) against one segment, one
+//          circle or one frame in a single call. The points are passed as
+//          one array of x and one array of y. With SSE2 two elements are
+//          done per instruction, anything left over, and every element
+//          without SSE2, by the single element functions.
+//
+//          Every function gives exactly what its single element version
+//          gives, so they can be swapped in without changing any results.
+//          The SSE2 paths work in double, so a SINGLE_PRECISION build,
+//          whose single element functions work in float, does without
+//          them.
+//
+//------------------------------------------------------------------------
+#include "2D/Vector2D.h"
+#include "2D/C2DMatrix.h"
+#include "2D/geometry.h"
+#include "2D/Transformations.h"
+#include "misc/simd.h"
+
+
+#if defined(SIMD_SSE2) && !defined(SINGLE_PRECISION)
+  #define BATCH_GEOMETRY_SSE2
+#endif
+
+#ifdef BATCH_GEOMETRY_SSE2
+//------------------------- DistToLineSegmentSqSimd ----------------------
+//
+//  DistToLineSegmentSq for two segments and two points
+//------------------------------------------------------------------------
+inline __m128d DistToLineSegmentSqSimd(__m128d ax, __m128d ay,
+                                       __m128d bx, __m128d by,
+                                       __m128d px, __m128d py)
+{
+  const __m128d zero = _mm_setzero_pd();
+
+  __m128d dotA = _mm_add_pd(_mm_mul_pd(_mm_sub_pd(px, ax), _mm_sub_pd(bx, ax)),
+                            _mm_mul_pd(_mm_sub_pd(py, ay), _mm_sub_pd(by, ay)));
+
+  __m128d dotB = _mm_add_pd(_mm_mul_pd(_mm_sub_pd(px, bx), _mm_sub_pd(ax, bx)),
+                            _mm_mul_pd(_mm_sub_pd(py, by), _mm_sub_pd(ay, by)));
+
+  //Vec2DDistanceSq adds the y term first
+  __m128d dx = _mm_sub_pd(px, ax);
+  __m128d dy = _mm_sub_pd(py, ay);
+  __m128d ToA = _mm_add_pd(_mm_mul_pd(dy, dy), _mm_mul_pd(dx, dx));
+
+  dx = _mm_sub_pd(px, bx);
+  dy = _mm_sub_pd(py, by);
+  __m128d ToB = _mm_add_pd(_mm_mul_pd(dy, dy), _mm_mul_pd(dx, dx));
+
+  //the closest point along AB
+  __m128d sum = _mm_add_pd(dotA, dotB);
+  __m128d cx = _mm_add_pd(ax, _mm_div_pd(_mm_mul_pd(_mm_sub_pd(bx, ax), dotA), sum));
+  __m128d cy = _mm_add_pd(ay, _mm_div_pd(_mm_mul_pd(_mm_sub_pd(by, ay), dotA), sum));
+
+  dx = _mm_sub_pd(cx, px);
+  dy = _mm_sub_pd(cy, py);
+  __m128d ToClosest = _mm_add_pd(_mm_mul_pd(dy, dy), _mm_mul_pd(dx, dx));
+
+  __m128d AtA = _mm_cmple_pd(dotA, zero);
+  __m128d AtB = _mm_andnot_pd(AtA, _mm_cmple_pd(dotB, zero));
+  __m128d between = _mm_andnot_pd(_mm_or_pd(AtA, AtB), _mm_cmpeq_pd(zero, zero));
+
+  return _mm_or_pd(_mm_or_pd(_mm_and_pd(AtA, ToA), _mm_and_pd(AtB, ToB)), _mm_and_pd(between, ToClosest));
+}
+
+//writes the two lanes of a mask to result as 1 or 0
+inline void StoreMask(__m128d mask, int* result)
+{
+  int bits = _mm_movemask_pd(mask);
+
+  result[0] = bits & 1;
+  result[1] = (bits >> 1) & 1;
+}
+
+//the lanes of a where mask is set and the lanes of b where it isn't
+inline __m128d SelectMask(__m128d mask, __m128d a, __m128d b)
+{
+  return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+#endif
+
+//-------------------------- PointsToLocalSpace --------------------------
+//
+//  PointToLocalSpace for n points. The local points are written to
+//  LocalX and LocalY
+//------------------------------------------------------------------------
+inline void PointsToLocalSpace(const double* PointX,
+                               const double* PointY,
+                               int           n,
+                               Vector2D      AgentHeading,
+                               Vector2D      AgentSide,
+                               Vector2D      AgentPosition,
+                               double*       LocalX,
+                               double*       LocalY)
+{
+  int i = 0;
+
+#ifdef BATCH_GEOMETRY_SSE2
+  const __m128d hx = _mm_set1_pd(AgentHeading.x);
+  const __m128d hy = _mm_set1_pd(AgentHeading.y);
+  const __m128d sx = _mm_set1_pd(AgentSide.x);
+  const __m128d sy = _mm_set1_pd(AgentSide.y);
+  const __m128d Tx = _mm_set1_pd(-AgentPosition.Dot(AgentHeading));
+  const __m128d Ty = _mm_set1_pd(-AgentPosition.Dot(AgentSide));
+
+  for (; i+1 < n; i += 2)
+  {
+    __m128d x = _mm_loadu_pd(PointX + i);
+    __m128d y = _mm_loadu_pd(PointY + i);
+
+    _mm_storeu_pd(LocalX + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(hx, x), _mm_mul_pd(hy, y)), Tx));
+    _mm_storeu_pd(LocalY + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(sx, x), _mm_mul_pd(sy, y)), Ty));
+  }
+#endif
+
+  for (; i < n; ++i)
+  {
+    Vector2D local = PointToLocalSpace(Vector2D(PointX[i], PointY[i]), AgentHeading, AgentSide, AgentPosition);
+
+    LocalX[i] = local.x;
+    LocalY[i] = local.y;
+  }
+}
+
+//------------------------- PointsWorldTransform -------------------------
+//
+//  WorldTransform for n points. The world points are written to WorldX
+//  and WorldY
+//------------------------------------------------------------------------
+inline void PointsWorldTransform(const double*   PointX,
+                                 const double*   PointY,
+                                 int             n,
+                                 const Vector2D& pos,
+                                 const Vector2D& forward,
+                                 const Vector2D& side,
+                                 const Vector2D& scale,
+                                 double*         WorldX,
+                                 double*         WorldY)
+{
+  //the same matrix WorldTransform makes
+  C2DMatrix matTransform;
+
+  if ( (scale.x != 1.0) || (scale.y != 1.0) )
+  {
+    matTransform.Scale(scale.x, scale.y);
+  }
+
+  matTransform.Rotate(forward, side);
+
+  matTransform.Translate(pos.x, pos.y);
+
+  int i = 0;
+
+#ifdef BATCH_GEOMETRY_SSE2
+  const __m128d m11 = _mm_set1_pd(matTransform._11());
+  const __m128d m12 = _mm_set1_pd(matTransform._12());
+  const __m128d m21 = _mm_set1_pd(matTransform._21());
+  const __m128d m22 = _mm_set1_pd(matTransform._22());
+  const __m128d m31 = _mm_set1_pd(matTransform._31());
+  const __m128d m32 = _mm_set1_pd(matTransform._32());
+
+  for (; i+1 < n; i += 2)
+  {
+    __m128d x = _mm_loadu_pd(PointX + i);
+    __m128d y = _mm_loadu_pd(PointY + i);
+
+    _mm_storeu_pd(WorldX + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(m11, x), _mm_mul_pd(m21, y)), m31));
+    _mm_storeu_pd(WorldY + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(m12, x), _mm_mul_pd(m22, y)), m32));
+  }
+#endif
+
+  for (; i < n; ++i)
+  {
+    Vector2D world(PointX[i], PointY[i]);
+
+    matTransform.TransformVector2Ds(world);
+
+    WorldX[i] = world.x;
+    WorldY[i] = world.y;
+  }
+}
+
+//------------------------- PointsDistToLineSegmentSq --------------------
+//
+//  DistToLineSegmentSq from the segment AB to each of n points
+//------------------------------------------------------------------------
+inline void PointsDistToLineSegmentSq(Vector2D      A,
+                                      Vector2D      B,
+                                      const double* PointX,
+                                      const double* PointY,
+                                      int           n,
+                                      double*       DistSq)
+{
+  int i = 0;
+
+#ifdef BATCH_GEOMETRY_SSE2
+  const __m128d ax = _mm_set1_pd(A.x);
+  const __m128d ay = _mm_set1_pd(A.y);
+  const __m128d bx = _mm_set1_pd(B.x);
+  const __m128d by = _mm_set1_pd(B.y);
+
+  for (; i+1 < n; i += 2)
+  {
+    _mm_storeu_pd(DistSq + i, DistToLineSegmentSqSimd(ax, ay, bx, by, _mm_loadu_pd(PointX + i), _mm_loadu_pd(PointY + i)));
+  }
+#endif
+
+  for (; i < n; ++i)
+  {
+    DistSq[i] = DistToLineSegmentSq(A, B, Vector2D(PointX[i], PointY[i]));
+  }
+}
+
+//---------------------------- PointsInCircle ----------------------------
+//
+//  PointInCircle for n points. result[i] is set to 1 if point i is
+//  inside the circle, 0 if it isn't
+//------------------------------------------------------------------------
+inline void PointsInCircle(Vector2D      Pos,
+                           double        radius,
+                           const double* PointX,
+                           const double* PointY,
+                           int           n,
+                           int*          result)
+{
+  int i = 0;
+
+#ifdef BATCH_GEOMETRY_SSE2
+  const __m128d cx = _mm_set1_pd(Pos.x);
+  const __m128d cy = _mm_set1_pd(Pos.y);
+  const __m128d RadiusSq = _mm_set1_pd(radius*radius);
+
+  for (; i+1 < n; i += 2)
+  {
+    __m128d dx = _mm_sub_pd(_mm_loadu_pd(PointX + i), cx);
+    __m128d dy = _mm_sub_pd(_mm_loadu_pd(PointY + i), cy);
+
+    StoreMask(_mm_cmplt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), RadiusSq), result + i);
+  }
+#endif
+
+  for (; i < n; ++i)
+  {
+    result[i] = PointInCircle(Pos, radius, Vector2D(PointX[i], PointY[i])) ? 1 : 0;
+  }
+}
+
+//-------------------------- CirclesTangentPoints ------------------------
+//
+//  GetTangentPoints from the point P to n circles, circle i centered on
+//  (CX[i], CY[i]) with radius R[i]. result[i] is set to 0 if P is inside
+//  or on circle i and its tangent points are left as they were,
+//  otherwise result[i] is set to 1 and the tangent points are written to
+//  (T1X[i], T1Y[i]) and (T2X[i], T2Y[i])
+//------------------------------------------------------------------------
+inline void CirclesTangentPoints(const double* CX,
+                                 const double* CY,
+                                 const double* R,
+                                 int           n,
+                                 Vector2D      P,
+                                 double*       T1X,
+                                 double*       T1Y,
+                                 double*       T2X,
+                                 double*       T2Y,
+                                 int*          result)
+{
+  int i = 0;
+
+#ifdef BATCH_GEOMETRY_SSE2
+  const __m128d px = _mm_set1_pd(P.x);
+  const __m128d py = _mm_set1_pd(P.y);
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d SignBit = _mm_set1_pd(-0.0);
+
+  for (; i+1 < n; i += 2)
+  {
+    __m128d cx = _mm_loadu_pd(CX + i);
+    __m128d cy = _mm_loadu_pd(CY + i);
+    __m128d r  = _mm_loadu_pd(R + i);
+
+    __m128d PmCx = _mm_sub_pd(px, cx);
+    __m128d PmCy = _mm_sub_pd(py, cy);
+
+    __m128d SqrLen = _mm_add_pd(_mm_mul_pd(PmCx, PmCx), _mm_mul_pd(PmCy, PmCy));
+    __m128d RSqr = _mm_mul_pd(r, r);
+
+    __m128d outside = _mm_cmpgt_pd(SqrLen, RSqr);
+
+    __m128d InvSqrLen = _mm_div_pd(one, SqrLen);
+    __m128d Root = _mm_sqrt_pd(_mm_andnot_pd(SignBit, _mm_sub_pd(SqrLen, RSqr)));
+
+    __m128d RPmCx = _mm_mul_pd(r, PmCx);
+    __m128d RPmCy = _mm_mul_pd(r, PmCy);
+    __m128d PmCyRoot = _mm_mul_pd(PmCy, Root);
+    __m128d PmCxRoot = _mm_mul_pd(PmCx, Root);
+
+    __m128d t1x = _mm_add_pd(cx, _mm_mul_pd(_mm_mul_pd(r, _mm_sub_pd(RPmCx, PmCyRoot)), InvSqrLen));
+    __m128d t1y = _mm_add_pd(cy, _mm_mul_pd(_mm_mul_pd(r, _mm_add_pd(RPmCy, PmCxRoot)), InvSqrLen));
+    __m128d t2x = _mm_add_pd(cx, _mm_mul_pd(_mm_mul_pd(r, _mm_add_pd(RPmCx, PmCyRoot)), InvSqrLen));
+    __m128d t2y = _mm_add_pd(cy, _mm_mul_pd(_mm_mul_pd(r, _mm_sub_pd(RPmCy, PmCxRoot)), InvSqrLen));
+
+    _mm_storeu_pd(T1X + i, SelectMask(outside, t1x, _mm_loadu_pd(T1X + i)));
+    _mm_storeu_pd(T1Y + i, SelectMask(outside, t1y, _mm_loadu_pd(T1Y + i)));
+    _mm_storeu_pd(T2X + i, SelectMask(outside, t2x, _mm_loadu_pd(T2X + i)));
+    _mm_storeu_pd(T2Y + i, SelectMask(outside, t2y, _mm_loadu_pd(T2Y + i)));
+
+    StoreMask(outside, result + i);
+  }
+#endif
+
+  for (; i < n; ++i)
+  {
+    Vector2D T1(T1X[i], T1Y[i]);
+    Vector2D T2(T2X[i], T2Y[i]);
+
+    result[i] = GetTangentPoints(Vector2D(CX[i], CY[i]), R[i], P, T1, T2) ? 1 : 0;
+
+    T1X[i] = T1.x;
+    T1Y[i] = T1.y;
+    T2X[i] = T2.x;
+    T2Y[i] = T2.y;
+  }
+}
+
+//--------------------------- LinesIntersection2D ------------------------
+//
+//  LineIntersection2D of n lines, line i running from (AX[i], AY[i]) to
+//  (BX[i], BY[i]), with the line CD. result[i] is set to 1 if line i
+//  crosses CD, 0 if it doesn't
+//------------------------------------------------------------------------
+inline void LinesIntersection2D(const double* AX,
+                                const double* AY,
+                                const double* BX,
+                                const double* BY,
+                                int           n,
+                                Vector2D      C,
+                                Vector2D      D,
+                                int*          result)
+{
+  int i = 0;
+
+#ifdef BATCH_GEOMETRY_SSE2
+  const __m128d cx = _mm_set1_pd(C.x);
+  const __m128d cy = _mm_set1_pd(C.y);
+  const __m128d DmCx = _mm_set1_pd(D.x - C.x);
+  const __m128d DmCy = _mm_set1_pd(D.y - C.y);
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d one = _mm_set1_pd(1.0);
+
+  for (; i+1 < n; i += 2)
+  {
+    __m128d ax = _mm_loadu_pd(AX + i);
+    __m128d ay = _mm_loadu_pd(AY + i);
+
+    __m128d AmCx = _mm_sub_pd(ax, cx);
+    __m128d AmCy = _mm_sub_pd(ay, cy);
+    __m128d BmAx = _mm_sub_pd(_mm_loadu_pd(BX + i), ax);
+    __m128d BmAy = _mm_sub_pd(_mm_loadu_pd(BY + i), ay);
+
+    __m128d rTop = _mm_sub_pd(_mm_mul_pd(AmCy, DmCx), _mm_mul_pd(AmCx, DmCy));
+    __m128d sTop = _mm_sub_pd(_mm_mul_pd(AmCy, BmAx), _mm_mul_pd(AmCx, BmAy));
+    __m128d Bot  = _mm_sub_pd(_mm_mul_pd(BmAx, DmCy), _mm_mul_pd(BmAy, DmCx));
+
+    __m128d invBot = _mm_div_pd(one, Bot);
+    __m128d r = _mm_mul_pd(rTop, invBot);
+    __m128d s = _mm_mul_pd(sTop, invBot);
+
+    //parallel lines never intersect
+    __m128d hit = _mm_cmpneq_pd(Bot, zero);
+
+    hit = _mm_and_pd(hit, _mm_and_pd(_mm_cmpgt_pd(r, zero), _mm_cmplt_pd(r, one)));
+    hit = _mm_and_pd(hit, _mm_and_pd(_mm_cmpgt_pd(s, zero), _mm_cmplt_pd(s, one)));
+
+    StoreMask(hit, result + i);
+  }
+#endif
+
+  for (; i < n; ++i)
+  {
+    result[i] = LineIntersection2D(Vector2D(AX[i], AY[i]), Vector2D(BX[i], BY[i]), C, D) ? 1 : 0;
+  }
+}
+
+//--------------------- LineSegmentsCircleIntersection -------------------
+//
+//  LineSegmentCircleIntersection for n segments, segment i running from
+//  (AX[i], AY[i]) to (BX[i], BY[i]). result[i] is set to 1 if segment i
+//  intersects the circle, 0 if it doesn't
+//------------------------------------------------------------------------
+inline void LineSegmentsCircleIntersection(const double* AX,
+                                           const double* AY,
+                                           const double* BX,
+                                           const double* BY,
+                                           int           n,
+                                           Vector2D      P,
+                                           double        radius,
+                                           int*          result)
+{
+  int i = 0;
+
+#ifdef BATCH_GEOMETRY_SSE2
+  const __m128d px = _mm_set1_pd(P.x);
+  const __m128d py = _mm_set1_pd(P.y);
+  const __m128d RadiusSq = _mm_set1_pd(radius*radius);
+
+  for (; i+1 < n; i += 2)
+  {
+    __m128d DistSq = DistToLineSegmentSqSimd(_mm_loadu_pd(AX + i), _mm_loadu_pd(AY + i),
+                                             _mm_loadu_pd(BX + i), _mm_loadu_pd(BY + i),
+                                             px, py);
+
+    StoreMask(_mm_cmplt_pd(DistSq, RadiusSq), result + i);
+  }
+#endif
+
+  for (; i < n; ++i)
+  {
+    result[i] = LineSegmentCircleIntersection(Vector2D(AX[i], AY[i]), Vector2D(BX[i], BY[i]), P, radius) ? 1 : 0;
+  }
+}
+
+//----------------------------- PointsNearRect ---------------------------
+//
+//  result[i] is set to 1 if point i is inside the rectangle grown by
+//  margin[i] on every side, 0 if it isn't
+//------------------------------------------------------------------------
+inline void PointsNearRect(const double* PointX,
+                           const double* PointY,
+                           const double* margin,
+                           int           n,
+                           double        left,
+                           double        top,
+                           double        right,
+                           double        bottom,
+                           int*          result)
+{
+  int i = 0;
+
+#ifdef BATCH_GEOMETRY_SSE2
+  const __m128d l = _mm_set1_pd(left);
+  const __m128d t = _mm_set1_pd(top);
+  const __m128d r = _mm_set1_pd(right);
+  const __m128d b = _mm_set1_pd(bottom);
+
+  for (; i+1 < n; i += 2)
+  {
+    __m128d x = _mm_loadu_pd(PointX + i);
+    __m128d y = _mm_loadu_pd(PointY + i);
+    __m128d m = _mm_loadu_pd(margin + i);
+
+    __m128d outside = _mm_or_pd(_mm_or_pd(_mm_cmplt_pd(x, _mm_sub_pd(l, m)), _mm_cmpgt_pd(x, _mm_add_pd(r, m))),
+                                _mm_or_pd(_mm_cmplt_pd(y, _mm_sub_pd(t, m)), _mm_cmpgt_pd(y, _mm_add_pd(b, m))));
+
+    StoreMask(_mm_andnot_pd(outside, _mm_cmpeq_pd(x, x)), result + i);
+  }
+#endif
+
+  for (; i < n; ++i)
+  {
+    bool outside = (PointX[i] < left - margin[i]) || (PointX[i] > right + margin[i]) ||
+                   (PointY[i] < top - margin[i]) || (PointY[i] > bottom + margin[i]);
+
+    result[i] = outside ? 0 : 1;
+  }
+}
+
+#endif
@@ -86,6 +86,18 @@ public:
   void _32(double val){m_Matrix._32 = val;}
   void _33(double val){m_Matrix._33 = val;}
 
+  double _11()const{return m_Matrix._11;}
+  double _12()const{return m_Matrix._12;}
+  double _13()const{return m_Matrix._13;}
+
+  double _21()const{return m_Matrix._21;}
+  double _22()const{return m_Matrix._22;}
+  double _23()const{return m_Matrix._23;}
+
+  double _31()const{return m_Matrix._31;}
+  double _32()const{return m_Matrix._32;}
+  double _33()const{return m_Matrix._33;}
+
 };
 
 
@@ -191,8 +203,8 @@ inline void C2DMatrix::Rotate(double rot)
 {
   C2DMatrix::Matrix mat;
 
-  double Sin = sin(rot);
-  double Cos = cos(rot);
+  double Sin = DetMath::Sin(rot);
+  double Cos = DetMath::Cos(rot);
   
   mat._11 = Cos;  mat._12 = Sin; mat._13 = 0;
   
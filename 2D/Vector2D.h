@@ -4,7 +4,13 @@
 //
 //  Name:   Vector2D.h
 //
-//  Desc:   2D vector struct
+//  Desc:   2D vector struct, templated on the type of its components.
+//          Vector2D is what the game uses. It has double components
+//          unless SINGLE_PRECISION is defined, which the ReleaseFloat
+//          configuration does, and then the entities, the ball and the
+//          geometry helpers all work in float. Vector2Dd and Vector2Df
+//          have double and float components whatever the build, for
+//          code that needs a given precision.
 //
 //  Author: Mat Buckland (fup@ai-junkie.com)
 //
@@ -16,55 +22,62 @@
 #include "misc/utils.h"
 
 
-struct Vector2D
+template <class real>
+struct Vector2DT
 {
-  double x;
-  double y;
+  typedef real value_type;
 
-  Vector2D():x(0.0),y(0.0){}
-  Vector2D(double a, double b):x(a),y(b){}
+  real x;
+  real y;
+
+  Vector2DT():x(0),y(0){}
+  Vector2DT(real a, real b):x(a),y(b){}
+
+  //converts from a vector of the other precision
+  template <class other>
+  explicit Vector2DT(const Vector2DT<other>& v):x((real)v.x),y((real)v.y){}
 
   //sets x and y to zero
-  void Zero(){x=0.0; y=0.0;}
+  void Zero(){x=0; y=0;}
 
   //returns true if both x and y are zero
   bool isZero()const{return (x*x + y*y) < MinDouble;}
 
   //returns the length of the vector
-  inline double    Length()const;
+  inline real      Length()const;
 
   //returns the squared length of the vector (thereby avoiding the sqrt)
-  inline double    LengthSq()const;
+  inline real      LengthSq()const;
 
   inline void      Normalize();
 
-  inline double    Dot(const Vector2D& v2)const;
+  inline real      Dot(const Vector2DT& v2)const;
 
   //returns positive if v2 is clockwise of this vector,
   //negative if anticlockwise (assuming the Y axis is pointing down,
   //X axis to right like a Window app)
-  inline int       Sign(const Vector2D& v2)const;
+  inline int       Sign(const Vector2DT& v2)const;
 
   //returns the vector that is perpendicular to this one.
-  inline Vector2D  Perp()const;
+  inline Vector2DT Perp()const;
 
   //adjusts x and y so that the length of the vector does not exceed max
-  inline void      Truncate(double max);
+  inline void      Truncate(real max);
 
   //returns the distance between this vector and th one passed as a parameter
-  inline double    Distance(const Vector2D &v2)const;
+  inline real      Distance(const Vector2DT &v2)const;
 
   //squared version of above.
-  inline double    DistanceSq(const Vector2D &v2)const;
+  inline real      DistanceSq(const Vector2DT &v2)const;
 
-  inline void      Reflect(const Vector2D& norm);
+  inline void      Reflect(const Vector2DT& norm);
 
   //returns the vector that is the reverse of this vector
-  inline Vector2D  GetReverse()const;
+  inline Vector2DT GetReverse()const;
 
 
   //we need some overloaded operators
-  const Vector2D& operator+=(const Vector2D &rhs)
+  const Vector2DT& operator+=(const Vector2DT &rhs)
   {
     x += rhs.x;
     y += rhs.y;
@@ -72,7 +85,7 @@ struct Vector2D
     return *this;
   }
 
-  const Vector2D& operator-=(const Vector2D &rhs)
+  const Vector2DT& operator-=(const Vector2DT &rhs)
   {
     x -= rhs.x;
     y -= rhs.y;
@@ -80,7 +93,7 @@ struct Vector2D
     return *this;
   }
 
-  const Vector2D& operator*=(const double& rhs)
+  const Vector2DT& operator*=(const real& rhs)
   {
     x *= rhs;
     y *= rhs;
@@ -88,7 +101,7 @@ struct Vector2D
     return *this;
   }
 
-  const Vector2D& operator/=(const double& rhs)
+  const Vector2DT& operator/=(const real& rhs)
   {
     x /= rhs;
     y /= rhs;
@@ -96,24 +109,42 @@ struct Vector2D
     return *this;
   }
 
-  bool operator==(const Vector2D& rhs)const
+  bool operator==(const Vector2DT& rhs)const
   {
     return (isEqual(x, rhs.x) && isEqual(y,rhs.y) );
   }
 
-  bool operator!=(const Vector2D& rhs)const
+  bool operator!=(const Vector2DT& rhs)const
   {
     return (x != rhs.x) || (y != rhs.y);
   }
   
 };
 
+//the game keeps its positions, velocities and headings in Vector2D, so
+//defining SINGLE_PRECISION builds the whole game in float
+#ifdef SINGLE_PRECISION
+typedef Vector2DT<float>  Vector2D;
+#else
+typedef Vector2DT<double> Vector2D;
+#endif
+
+typedef Vector2DT<double> Vector2Dd;
+typedef Vector2DT<float>  Vector2Df;
+
 //-----------------------------------------------------------------------some more operator overloads
-inline Vector2D operator*(const Vector2D &lhs, double rhs);
-inline Vector2D operator*(double lhs, const Vector2D &rhs);
-inline Vector2D operator-(const Vector2D &lhs, const Vector2D &rhs);
-inline Vector2D operator+(const Vector2D &lhs, const Vector2D &rhs);
-inline Vector2D operator/(const Vector2D &lhs, double val);
+//the scalars are taken as the vector's value_type so that any number
+//can be passed, as with the old double versions
+template <class real>
+inline Vector2DT<real> operator*(const Vector2DT<real> &lhs, typename Vector2DT<real>::value_type rhs);
+template <class real>
+inline Vector2DT<real> operator*(typename Vector2DT<real>::value_type lhs, const Vector2DT<real> &rhs);
+template <class real>
+inline Vector2DT<real> operator-(const Vector2DT<real> &lhs, const Vector2DT<real> &rhs);
+template <class real>
+inline Vector2DT<real> operator+(const Vector2DT<real> &lhs, const Vector2DT<real> &rhs);
+template <class real>
+inline Vector2DT<real> operator/(const Vector2DT<real> &lhs, typename Vector2DT<real>::value_type val);
 std::ostream& operator<<(std::ostream& os, const Vector2D& rhs);
 std::ifstream& operator>>(std::ifstream& is, Vector2D& lhs);
 
@@ -124,7 +155,8 @@ std::ifstream& operator>>(std::ifstream& is, Vector2D& lhs);
 //
 //  returns the length of a 2D vector
 //------------------------------------------------------------------------
-inline double Vector2D::Length()const
+template <class real>
+inline real Vector2DT<real>::Length()const
 {
   return sqrt(x * x + y * y);
 }
@@ -134,7 +166,8 @@ inline double Vector2D::Length()const
 //
 //  returns the squared length of a 2D vector
 //------------------------------------------------------------------------
-inline double Vector2D::LengthSq()const
+template <class real>
+inline real Vector2DT<real>::LengthSq()const
 {
   return (x * x + y * y);
 }
@@ -144,7 +177,8 @@ inline double Vector2D::LengthSq()const
 //
 //  calculates the dot product
 //------------------------------------------------------------------------
-inline double Vector2D::Dot(const Vector2D &v2)const
+template <class real>
+inline real Vector2DT<real>::Dot(const Vector2DT<real> &v2)const
 {
   return x*v2.x + y*v2.y;
 }
@@ -156,7 +190,8 @@ inline double Vector2D::Dot(const Vector2D &v2)const
 //------------------------------------------------------------------------
 enum {clockwise = 1, anticlockwise = -1};
 
-inline int Vector2D::Sign(const Vector2D& v2)const
+template <class real>
+inline int Vector2DT<real>::Sign(const Vector2DT<real>& v2)const
 {
   if (y*v2.x > x*v2.y)
   { 
@@ -172,19 +207,21 @@ inline int Vector2D::Sign(const Vector2D& v2)const
 //
 //  Returns a vector perpendicular to this vector
 //------------------------------------------------------------------------
-inline Vector2D Vector2D::Perp()const
+template <class real>
+inline Vector2DT<real> Vector2DT<real>::Perp()const
 {
-  return Vector2D(-y, x);
+  return Vector2DT<real>(-y, x);
 }
 
 //------------------------------ Distance --------------------------------
 //
 //  calculates the euclidean distance between two vectors
 //------------------------------------------------------------------------
-inline double Vector2D::Distance(const Vector2D &v2)const
+template <class real>
+inline real Vector2DT<real>::Distance(const Vector2DT<real> &v2)const
 {
-  double ySeparation = v2.y - y;
-  double xSeparation = v2.x - x;
+  real ySeparation = v2.y - y;
+  real xSeparation = v2.x - x;
 
   return sqrt(ySeparation*ySeparation + xSeparation*xSeparation);
 }
@@ -194,10 +231,11 @@ inline double Vector2D::Distance(const Vector2D &v2)const
 //
 //  calculates the euclidean distance squared between two vectors 
 //------------------------------------------------------------------------
-inline double Vector2D::DistanceSq(const Vector2D &v2)const
+template <class real>
+inline real Vector2DT<real>::DistanceSq(const Vector2DT<real> &v2)const
 {
-  double ySeparation = v2.y - y;
-  double xSeparation = v2.x - x;
+  real ySeparation = v2.y - y;
+  real xSeparation = v2.x - x;
 
   return ySeparation*ySeparation + xSeparation*xSeparation;
 }
@@ -206,7 +244,8 @@ inline double Vector2D::DistanceSq(const Vector2D &v2)const
 //
 //  truncates a vector so that its length does not exceed max
 //------------------------------------------------------------------------
-inline void Vector2D::Truncate(double max)
+template <class real>
+inline void Vector2DT<real>::Truncate(real max)
 {
   if (this->Length() > max)
   {
@@ -221,7 +260,8 @@ inline void Vector2D::Truncate(double max)
 //  given a normalized vector this method reflects the vector it
 //  is operating upon. (like the path of a ball bouncing off a wall)
 //------------------------------------------------------------------------
-inline void Vector2D::Reflect(const Vector2D& norm)
+template <class real>
+inline void Vector2DT<real>::Reflect(const Vector2DT<real>& norm)
 {
   *this += 2.0 * this->Dot(norm) * norm.GetReverse();
 }
@@ -230,9 +270,10 @@ inline void Vector2D::Reflect(const Vector2D& norm)
 //
 //  returns the vector that is the reverse of this vector
 //------------------------------------------------------------------------
-inline Vector2D Vector2D::GetReverse()const
+template <class real>
+inline Vector2DT<real> Vector2DT<real>::GetReverse()const
 {
-  return Vector2D(-this->x, -this->y);
+  return Vector2DT<real>(-this->x, -this->y);
 }
 
 
@@ -240,11 +281,12 @@ inline Vector2D Vector2D::GetReverse()const
 //
 //  normalizes a 2D Vector
 //------------------------------------------------------------------------
-inline void Vector2D::Normalize()
+template <class real>
+inline void Vector2DT<real>::Normalize()
 { 
-  double vector_length = this->Length();
+  real vector_length = this->Length();
 
-  if (vector_length > std::numeric_limits<double>::epsilon())
+  if (vector_length > std::numeric_limits<real>::epsilon())
   {
     this->x /= vector_length;
     this->y /= vector_length;
@@ -254,13 +296,14 @@ inline void Vector2D::Normalize()
 
 //------------------------------------------------------------------------non member functions
 
-inline Vector2D Vec2DNormalize(const Vector2D &v)
+template <class real>
+inline Vector2DT<real> Vec2DNormalize(const Vector2DT<real> &v)
 {
-  Vector2D vec = v;
+  Vector2DT<real> vec = v;
 
-  double vector_length = vec.Length();
+  real vector_length = vec.Length();
 
-  if (vector_length > std::numeric_limits<double>::epsilon())
+  if (vector_length > std::numeric_limits<real>::epsilon())
   {
     vec.x /= vector_length;
     vec.y /= vector_length;
@@ -270,30 +313,34 @@ inline Vector2D Vec2DNormalize(const Vector2D &v)
 }
 
 
-inline double Vec2DDistance(const Vector2D &v1, const Vector2D &v2)
+template <class real>
+inline real Vec2DDistance(const Vector2DT<real> &v1, const Vector2DT<real> &v2)
 {
 
-  double ySeparation = v2.y - v1.y;
-  double xSeparation = v2.x - v1.x;
+  real ySeparation = v2.y - v1.y;
+  real xSeparation = v2.x - v1.x;
 
   return sqrt(ySeparation*ySeparation + xSeparation*xSeparation);
 }
 
-inline double Vec2DDistanceSq(const Vector2D &v1, const Vector2D &v2)
+template <class real>
+inline real Vec2DDistanceSq(const Vector2DT<real> &v1, const Vector2DT<real> &v2)
 {
 
-  double ySeparation = v2.y - v1.y;
-  double xSeparation = v2.x - v1.x;
+  real ySeparation = v2.y - v1.y;
+  real xSeparation = v2.x - v1.x;
 
   return ySeparation*ySeparation + xSeparation*xSeparation;
 }
 
-inline double Vec2DLength(const Vector2D& v)
+template <class real>
+inline real Vec2DLength(const Vector2DT<real>& v)
 {
   return sqrt(v.x*v.x + v.y*v.y);
 }
 
-inline double Vec2DLengthSq(const Vector2D& v)
+template <class real>
+inline real Vec2DLengthSq(const Vector2DT<real>& v)
 {
   return (v.x*v.x + v.y*v.y);
 }
@@ -330,24 +377,27 @@ inline POINT VectorToPOINT(const Vector2D& v)
 
 
 //------------------------------------------------------------------------operator overloads
-inline Vector2D operator*(const Vector2D &lhs, double rhs)
+template <class real>
+inline Vector2DT<real> operator*(const Vector2DT<real> &lhs, typename Vector2DT<real>::value_type rhs)
 {
-  Vector2D result(lhs);
+  Vector2DT<real> result(lhs);
   result *= rhs;
   return result;
 }
 
-inline Vector2D operator*(double lhs, const Vector2D &rhs)
+template <class real>
+inline Vector2DT<real> operator*(typename Vector2DT<real>::value_type lhs, const Vector2DT<real> &rhs)
 {
-  Vector2D result(rhs);
+  Vector2DT<real> result(rhs);
   result *= lhs;
   return result;
 }
 
 //overload the - operator
-inline Vector2D operator-(const Vector2D &lhs, const Vector2D &rhs)
+template <class real>
+inline Vector2DT<real> operator-(const Vector2DT<real> &lhs, const Vector2DT<real> &rhs)
 {
-  Vector2D result(lhs);
+  Vector2DT<real> result(lhs);
   result.x -= rhs.x;
   result.y -= rhs.y;
   
@@ -355,9 +405,10 @@ inline Vector2D operator-(const Vector2D &lhs, const Vector2D &rhs)
 }
 
 //overload the + operator
-inline Vector2D operator+(const Vector2D &lhs, const Vector2D &rhs)
+template <class real>
+inline Vector2DT<real> operator+(const Vector2DT<real> &lhs, const Vector2DT<real> &rhs)
 {
-  Vector2D result(lhs);
+  Vector2DT<real> result(lhs);
   result.x += rhs.x;
   result.y += rhs.y;
   
@@ -365,9 +416,10 @@ inline Vector2D operator+(const Vector2D &lhs, const Vector2D &rhs)
 }
 
 //overload the / operator
-inline Vector2D operator/(const Vector2D &lhs, double val)
+template <class real>
+inline Vector2DT<real> operator/(const Vector2DT<real> &lhs, typename Vector2DT<real>::value_type val)
 {
-  Vector2D result(lhs);
+  Vector2DT<real> result(lhs);
   result.x /= val;
   result.y /= val;
 
@@ -0,0 +1,201 @@
+#ifndef WALLBROADPHASE_H
+#define WALLBROADPHASE_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name:   WallBroadphase.h
+//
+//  Desc:   static uniform grid over a set of wall segments. Each wall is
+//          stored in every cell its bounding box, grown by a margin,
+//          overlaps. A query with the box swept by the center of a
+//          moving circle of radius no bigger than the margin then returns
+//          every wall the circle could touch, without looking at the
+//          others. Walls are not expected to move; call Build again if
+//          they do.
+//
+//------------------------------------------------------------------------
+#include <vector>
+
+#include "2D/Vector2D.h"
+#include "2D/Wall2D.h"
+#include "misc/utils.h"
+
+
+class WallBroadphase
+{
+private:
+
+  //the bounds of the grid
+  double  m_dLeft;
+  double  m_dTop;
+  double  m_dCellSize;
+
+  int     m_iNumCellsX;
+  int     m_iNumCellsY;
+
+  //the wall indices of cell c are m_CellWalls[m_CellStart[c]] up to
+  //m_CellWalls[m_CellStart[c+1]]
+  std::vector<int>  m_CellStart;
+  std::vector<int>  m_CellWalls;
+
+  //a wall spanning several cells is only reported once per query. A wall
+  //has been reported when its stamp equals the number of the query
+  mutable std::vector<int>  m_Stamps;
+  mutable int               m_iQuery;
+
+
+  int CellX(double x)const
+  {
+    int col = (int)((x - m_dLeft) / m_dCellSize);
+
+    if (col < 0) return 0;
+    if (col > m_iNumCellsX-1) return m_iNumCellsX-1;
+
+    return col;
+  }
+
+  int CellY(double y)const
+  {
+    int row = (int)((y - m_dTop) / m_dCellSize);
+
+    if (row < 0) return 0;
+    if (row > m_iNumCellsY-1) return m_iNumCellsY-1;
+
+    return row;
+  }
+
+public:
+
+  WallBroadphase():m_dLeft(0),
+                   m_dTop(0),
+                   m_dCellSize(1),
+                   m_iNumCellsX(0),
+                   m_iNumCellsY(0),
+                   m_iQuery(0)
+  {}
+
+  //indexes the walls. margin should be at least the radius of anything
+  //that will be swept against them
+  void Build(const std::vector<Wall2D>& walls, double CellSize, double margin)
+  {
+    m_CellStart.clear();
+    m_CellWalls.clear();
+
+    m_Stamps.assign(walls.size(), 0);
+    m_iQuery = 0;
+
+    m_iNumCellsX = 0;
+    m_iNumCellsY = 0;
+
+    if (walls.empty()) return;
+
+    //the grid covers the grown bounding box of all the walls
+    double left   = MaxDouble;
+    double top    = MaxDouble;
+    double right  = -MaxDouble;
+    double bottom = -MaxDouble;
+
+    unsigned int w;
+
+    for (w=0; w<walls.size(); ++w)
+    {
+      left   = MinOf<double>(left,   MinOf(walls[w].From().x, walls[w].To().x));
+      top    = MinOf<double>(top,    MinOf(walls[w].From().y, walls[w].To().y));
+      right  = MaxOf<double>(right,  MaxOf(walls[w].From().x, walls[w].To().x));
+      bottom = MaxOf<double>(bottom, MaxOf(walls[w].From().y, walls[w].To().y));
+    }
+
+    m_dLeft     = left - margin;
+    m_dTop      = top - margin;
+    m_dCellSize = CellSize;
+
+    m_iNumCellsX = (int)((right + margin - m_dLeft) / m_dCellSize) + 1;
+    m_iNumCellsY = (int)((bottom + margin - m_dTop) / m_dCellSize) + 1;
+
+    //count the walls of each cell, then fill them in
+    std::vector<int> counts(m_iNumCellsX * m_iNumCellsY + 1, 0);
+
+    for (int pass=0; pass<2; ++pass)
+    {
+      for (w=0; w<walls.size(); ++w)
+      {
+        int x0 = CellX(MinOf(walls[w].From().x, walls[w].To().x) - margin);
+        int x1 = CellX(MaxOf(walls[w].From().x, walls[w].To().x) + margin);
+        int y0 = CellY(MinOf(walls[w].From().y, walls[w].To().y) - margin);
+        int y1 = CellY(MaxOf(walls[w].From().y, walls[w].To().y) + margin);
+
+        for (int y=y0; y<=y1; ++y)
+        {
+          for (int x=x0; x<=x1; ++x)
+          {
+            int cell = y * m_iNumCellsX + x;
+
+            if (pass == 0) ++counts[cell];
+
+            else m_CellWalls[m_CellStart[cell] + counts[cell]++] = w;
+          }
+        }
+      }
+
+      if (pass == 0)
+      {
+        m_CellStart.assign(counts.size(), 0);
+
+        for (unsigned int cell=1; cell<counts.size(); ++cell)
+        {
+          m_CellStart[cell] = m_CellStart[cell-1] + counts[cell-1];
+        }
+
+        m_CellWalls.resize(m_CellStart.back());
+
+        counts.assign(counts.size(), 0);
+      }
+    }
+  }
+
+  //fills Result with the indices of the walls stored in the cells the box
+  //overlaps, each one once
+  void Query(Vector2D TopLeft, Vector2D BottomRight, std::vector<int>& Result)const
+  {
+    Result.clear();
+
+    if (m_CellWalls.empty()) return;
+
+    //restart the stamps before the counter can wrap
+    if (++m_iQuery == MaxInt)
+    {
+      m_Stamps.assign(m_Stamps.size(), 0);
+      m_iQuery = 1;
+    }
+
+    int x0 = CellX(TopLeft.x);
+    int x1 = CellX(BottomRight.x);
+    int y0 = CellY(TopLeft.y);
+    int y1 = CellY(BottomRight.y);
+
+    for (int y=y0; y<=y1; ++y)
+    {
+      for (int x=x0; x<=x1; ++x)
+      {
+        int cell = y * m_iNumCellsX + x;
+
+        for (int i=m_CellStart[cell]; i<m_CellStart[cell+1]; ++i)
+        {
+          int w = m_CellWalls[i];
+
+          if (m_Stamps[w] != m_iQuery)
+          {
+            m_Stamps[w] = m_iQuery;
+
+            Result.push_back(w);
+          }
+        }
+      }
+    }
+  }
+
+  int NumCellsX()const{return m_iNumCellsX;}
+  int NumCellsY()const{return m_iNumCellsY;}
+};
+
+#endif
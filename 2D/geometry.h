@@ -626,6 +626,115 @@ inline bool GetLineSegmentCircleClosestIntersectionPoint(Vector2D A,
   return ipFound;
 }
 
+//--------------------- SweptCircleSegmentIntersection ------------------------
+//
+//  a circle of radius R moves from P along the displacement D. If it
+//  touches the line segment AB during the move this returns true, sets
+//  t to the fraction of D travelled at the moment of contact and sets
+//  normal to the contact normal (pointing from the segment towards the
+//  circle). The segment's end points are treated as round caps so a
+//  circle glancing off the end of a wall bounces correctly. Contacts
+//  the circle is moving away from are ignored, so a circle resting on
+//  a wall can always leave it
+//-----------------------------------------------------------------------------
+inline bool SweptCircleSegmentIntersection(Vector2D  P,
+                                           Vector2D  D,
+                                           double    R,
+                                           Vector2D  A,
+                                           Vector2D  B,
+                                           double&   t,
+                                           Vector2D& normal)
+{
+  bool   bHit = false;
+  double BestT = MaxDouble;
+
+  //first the face of the segment
+  Vector2D AB = B - A;
+  double   length = AB.Length();
+
+  if (length > MinDouble)
+  {
+    Vector2D dir = AB / length;
+    Vector2D n   = dir.Perp();
+
+    //work on the side of the segment the circle is on
+    double side = (P - A).Dot(n);
+
+    if (side < 0)
+    {
+      n    = n.GetReverse();
+      side = -side;
+    }
+
+    double closing = D.Dot(n);
+
+    //only a circle moving towards the segment can hit its face
+    if (closing < 0)
+    {
+      double ThisT = (side < R) ? 0.0 : (side - R) / -closing;
+
+      if (ThisT <= 1.0)
+      {
+        double along = (P + D*ThisT - A).Dot(dir);
+
+        if ( (along >= 0) && (along <= length) )
+        {
+          bHit   = true;
+          BestT  = ThisT;
+          normal = n;
+        }
+      }
+    }
+  }
+
+  //then the end points
+  Vector2D caps[2] = {A, B};
+
+  for (int cap=0; cap<2; ++cap)
+  {
+    Vector2D ToP = P - caps[cap];
+
+    double b = ToP.Dot(D);
+
+    //moving away from this end point
+    if (b >= 0) continue;
+
+    double c = ToP.LengthSq() - R*R;
+    double ThisT;
+
+    if (c <= 0)
+    {
+      ThisT = 0.0;
+    }
+
+    else
+    {
+      double a = D.LengthSq();
+
+      double discriminant = b*b - a*c;
+
+      if (discriminant < 0) continue;
+
+      ThisT = (-b - sqrt(discriminant)) / a;
+    }
+
+    if ( (ThisT <= 1.0) && (ThisT < BestT) )
+    {
+      Vector2D ToContact = P + D*ThisT - caps[cap];
+
+      if (ToContact.LengthSq() < MinDouble) continue;
+
+      bHit   = true;
+      BestT  = ThisT;
+      normal = Vec2DNormalize(ToContact);
+    }
+  }
+
+  if (bHit) t = BestT;
+
+  return bHit;
+}
+
 #endif
 
               
@@ -0,0 +1,353 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "misc/FastMath.h"
+#include "misc/utils.h"
+#include "time/Regulator.h"
+
+#include "BatchRunner.h"
+#include "FormationLoader.h"
+#include "MatchLanes.h"
+#include "ParamLoader.h"
+#include "SoccerPitch.h"
+#include "SoccerTeam.h"
+#include "ThreadPool.h"
+
+//The statistics WriteComparison compares, and their names.
+static int MatchResult::* const Statistics[] = { &MatchResult::m_iRedGoals, &MatchResult::m_iBlueGoals, &MatchResult::m_iRedPossession, &MatchResult::m_iBluePossession, &MatchResult::m_iRedShots, &MatchResult::m_iBlueShots, &MatchResult::m_iTicks };
+static const char* StatisticNames[] = { "red_goals", "blue_goals", "red_possession", "blue_possession", "red_shots", "blue_shots", "ticks" };
+
+const int NumStatistics = sizeof(Statistics) / sizeof(Statistics[0]);
+
+//The names of the termination rules in the results.
+static const char* Terminations[] = { "ticks", "goals", "difference", "stalled" };
+
+const int NumTerminations = sizeof(Terminations) / sizeof(Terminations[0]);
+
+//Works out the mean of a statistic over the results, and the variance of that mean.
+static void MeanOf(const std::vector<MatchResult>& results, int MatchResult::* statistic, double& mean, double& variance) {
+
+	mean = 0.0;
+	variance = 0.0;
+
+	if (results.empty()) return;
+
+	for (unsigned int r = 0; r < results.size(); ++r) mean += results[r].*statistic;
+	mean /= results.size();
+
+	if (results.size() < 2) return;
+
+	for (unsigned int r = 0; r < results.size(); ++r) variance += (results[r].*statistic - mean) * (results[r].*statistic - mean);
+	variance /= (results.size() - 1) * results.size();
+
+}
+
+BatchSettings::BatchSettings() :m_bMatchLanes(Prm.bMatchLanes), m_bFloatLanes(Prm.bFloatLanes), m_bFastMotion(Prm.bFastMotion) {}
+
+BatchRunner::BatchRunner(int NumWorkers, int cxClient, int cyClient, const BatchSettings& settings) :m_Settings(settings), m_Pitches(NumWorkers, (SoccerPitch*)NULL), m_Lanes(NumWorkers, (MatchLanes*)NULL), m_cxClient(cxClient), m_cyClient(cyClient) {
+
+	//Load the shared read-only data before the workers start.
+	ParamLoader::Instance();
+	FormationLoader::Instance();
+
+	DetMath::Use(Prm.bDeterministicMath);
+	DetMath::UseRandom(true);
+	FastMath::Use(Prm.bFastDecisionMath);
+
+	assert((Prm.MatchTickLimit > 0) && "<BatchRunner::BatchRunner>: a batch match needs a tick limit");
+
+	m_pPool = new ThreadPool(NumWorkers, std::bind(&BatchRunner::ReleaseWorker, this, std::placeholders::_1));
+
+}
+
+BatchRunner::~BatchRunner() {
+
+	//The workers free their pitches as they stop.
+	delete m_pPool;
+
+}
+
+//-----------------------------------------Run------------------------------------------
+//---------------------------------------------------------------------------------------
+void BatchRunner::Run(const std::vector<unsigned int>& seeds, std::vector<MatchResult>& results) {
+
+	m_Seeds = seeds;
+	m_Results.assign(seeds.size(), MatchResult());
+
+	//Each match writes only to its own result.
+	if (m_Settings.m_bMatchLanes) {
+		for (unsigned int first = 0; first < m_Seeds.size(); first += MatchLanes::LanesPerGroup(m_Settings.m_bFloatLanes)) m_pPool->Submit(std::bind(&BatchRunner::PlayMatches, this, first, std::placeholders::_1));
+	}
+
+	else {
+		for (unsigned int match = 0; match < m_Seeds.size(); ++match) m_pPool->Submit(std::bind(&BatchRunner::PlayMatch, this, match, std::placeholders::_1));
+	}
+
+	m_pPool->WaitForAll();
+
+	results = m_Results;
+
+}
+
+//---------------------------------------PlayMatch--------------------------------------
+//---------------------------------------------------------------------------------------
+void BatchRunner::PlayMatch(int match, int worker) {
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if (!m_Pitches[worker]) m_Pitches[worker] = new SoccerPitch(m_cxClient, m_cyClient);
+
+	SoccerPitch* pitch = m_Pitches[worker];
+
+	//Seed and restart the clock before the reset so it draws the same numbers every time.
+	SeedRandom(m_Seeds[match]);
+	RegulatorClock::UseSimulatedTime();
+
+	pitch->Reset();
+
+	const double TickMilliseconds = 1000.0 / Prm.FrameRate;
+
+	MatchResult& result = m_Results[match];
+
+	while (!IsFinished(pitch, result.m_Termination)) {
+
+		RegulatorClock::Advance(TickMilliseconds);
+		pitch->Update();
+
+	}
+
+	RecordResult(match, pitch, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+}
+
+//--------------------------------------PlayMatches-------------------------------------
+//
+// The lanes are seeded and reset one after the other and then share the random number
+// generator, so each match depends on the whole group. A lane stops being updated once
+// its match is over; the others play on.
+//---------------------------------------------------------------------------------------
+void BatchRunner::PlayMatches(int first, int worker) {
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if (!m_Lanes[worker]) m_Lanes[worker] = new MatchLanes(m_cxClient, m_cyClient, m_Settings.m_bFloatLanes, m_Settings.m_bFastMotion);
+
+	MatchLanes* lanes = m_Lanes[worker];
+
+	RegulatorClock::UseSimulatedTime();
+
+	for (int lane = 0; lane < lanes->NumLanes(); ++lane) {
+
+		bool used = (first + lane < (int)m_Seeds.size());
+		lanes->SetActive(lane, used);
+
+		if (!used) continue;
+
+		SeedRandom(m_Seeds[first + lane]);
+		lanes->Pitch(lane)->Reset();
+
+	}
+
+	const double TickMilliseconds = 1000.0 / Prm.FrameRate;
+
+	while (true) {
+
+		for (int lane = 0; lane < lanes->NumLanes(); ++lane) {
+
+			if (!lanes->IsActive(lane) || !IsFinished(lanes->Pitch(lane), m_Results[first + lane].m_Termination)) continue;
+
+			RecordResult(first + lane, lanes->Pitch(lane), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			lanes->SetActive(lane, false);
+
+		}
+
+		if (!lanes->AnyActive()) break;
+
+		RegulatorClock::Advance(TickMilliseconds);
+		lanes->Update();
+
+	}
+
+}
+
+//-------------------------------------RecordResult-------------------------------------
+//---------------------------------------------------------------------------------------
+void BatchRunner::RecordResult(int match, const SoccerPitch* pitch, double WallTime) {
+
+	MatchResult& result = m_Results[match];
+
+	result.m_iSeed = m_Seeds[match];
+	result.m_iRedGoals = pitch->RedScore();
+	result.m_iBlueGoals = pitch->BlueScore();
+	result.m_iRedPossession = pitch->RedTeam()->PossessionTicks();
+	result.m_iBluePossession = pitch->BlueTeam()->PossessionTicks();
+	result.m_iRedShots = pitch->RedTeam()->NumShots();
+	result.m_iBlueShots = pitch->BlueTeam()->NumShots();
+	result.m_iTicks = pitch->MatchTicks();
+	result.m_iLongestUntouched = pitch->LongestUntouched();
+	result.m_dWallTime = WallTime;
+
+}
+
+//-------------------------------------ReleaseWorker------------------------------------
+//---------------------------------------------------------------------------------------
+void BatchRunner::ReleaseWorker(int worker) {
+
+	delete m_Pitches[worker];
+	m_Pitches[worker] = NULL;
+
+	delete m_Lanes[worker];
+	m_Lanes[worker] = NULL;
+
+}
+
+//--------------------------------------IsFinished--------------------------------------
+//---------------------------------------------------------------------------------------
+bool BatchRunner::IsFinished(const SoccerPitch* pitch, MatchResult::termination& reason)const {
+
+	int red = pitch->RedScore();
+	int blue = pitch->BlueScore();
+
+	if ((Prm.MatchGoalLimit > 0) && (red + blue >= Prm.MatchGoalLimit)) {
+		reason = MatchResult::goal_limit;
+		return true;
+	}
+
+	if ((Prm.MatchGoalDifferenceLimit > 0) && (abs(red - blue) >= Prm.MatchGoalDifferenceLimit)) {
+		reason = MatchResult::goal_difference;
+		return true;
+	}
+
+	if ((Prm.MatchStallTickLimit > 0) && (pitch->UntouchedTicks() >= Prm.MatchStallTickLimit)) {
+		reason = MatchResult::stalled;
+		return true;
+	}
+
+	if (pitch->MatchTicks() >= Prm.MatchTickLimit) {
+		reason = MatchResult::tick_limit;
+		return true;
+	}
+
+	return false;
+
+}
+
+//-------------------------------------WriteResults-------------------------------------
+//---------------------------------------------------------------------------------------
+void BatchRunner::WriteResults(std::ostream& os, const std::vector<MatchResult>& results) {
+
+	os << "seed,red_goals,blue_goals,red_possession,blue_possession,red_shots,blue_shots,ticks,wall_ms,end,longest_untouched\n";
+
+	for (unsigned int r = 0; r < results.size(); ++r) {
+
+		const MatchResult& result = results[r];
+
+		os << result.m_iSeed << ","
+			<< result.m_iRedGoals << "," << result.m_iBlueGoals << ","
+			<< result.m_iRedPossession << "," << result.m_iBluePossession << ","
+			<< result.m_iRedShots << "," << result.m_iBlueShots << ","
+			<< result.m_iTicks << ","
+			<< result.m_dWallTime << ","
+			<< Terminations[result.m_Termination] << ","
+			<< result.m_iLongestUntouched << "\n";
+
+	}
+
+}
+
+//-------------------------------------ReadResults--------------------------------------
+//---------------------------------------------------------------------------------------
+bool BatchRunner::ReadResults(std::istream& is, std::vector<MatchResult>& results) {
+
+	results.clear();
+
+	std::string line;
+
+	//Skip the header.
+	if (!std::getline(is, line)) return false;
+
+	while (std::getline(is, line)) {
+
+		if (line.empty()) continue;
+
+		//Turn the commas into spaces so the fields can be streamed in.
+		for (unsigned int c = 0; c < line.size(); ++c) if (line[c] == ',') line[c] = ' ';
+
+		std::istringstream fields(line);
+		MatchResult result;
+		std::string termination;
+
+		fields >> result.m_iSeed
+			>> result.m_iRedGoals >> result.m_iBlueGoals
+			>> result.m_iRedPossession >> result.m_iBluePossession
+			>> result.m_iRedShots >> result.m_iBlueShots
+			>> result.m_iTicks
+			>> result.m_dWallTime
+			>> termination
+			>> result.m_iLongestUntouched;
+
+		if (!fields) return false;
+
+		int t = 0;
+		while ((t < NumTerminations) && (termination != Terminations[t])) ++t;
+
+		if (t == NumTerminations) return false;
+
+		result.m_Termination = (MatchResult::termination)t;
+
+		results.push_back(result);
+
+	}
+
+	return true;
+
+}
+
+//--------------------------------------NumStalled--------------------------------------
+//---------------------------------------------------------------------------------------
+int BatchRunner::NumStalled(const std::vector<MatchResult>& results) {
+
+	int stalled = 0;
+
+	for (unsigned int r = 0; r < results.size(); ++r) {
+		if (results[r].m_Termination == MatchResult::stalled) ++stalled;
+	}
+
+	return stalled;
+
+}
+
+//------------------------------------WriteComparison-----------------------------------
+//
+// Matches played with different settings soon play out differently, so the batches are
+// compared by the means of their statistics rather than match by match. A difference
+// of a couple of standard errors or less is what the number of matches can put down to
+// chance.
+//---------------------------------------------------------------------------------------
+void BatchRunner::WriteComparison(std::ostream& os, const std::vector<MatchResult>& reference, const std::vector<MatchResult>& results) {
+
+	os << "statistic,reference_mean,mean,difference,standard_error\n";
+
+	for (int s = 0; s < NumStatistics; ++s) {
+
+		double ReferenceMean, ReferenceVariance;
+		double mean, variance;
+
+		MeanOf(reference, Statistics[s], ReferenceMean, ReferenceVariance);
+		MeanOf(results, Statistics[s], mean, variance);
+
+		os << StatisticNames[s] << ","
+			<< ReferenceMean << "," << mean << ","
+			<< mean - ReferenceMean << ","
+			<< sqrt(ReferenceVariance + variance) << "\n";
+
+	}
+
+}
@@ -0,0 +1,140 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: BatchRunner.h
+//
+//  Desc: Plays whole matches without rendering them, one per seed, on a
+//        pool of worker threads. Each worker creates one pitch the first
+//        time it needs one and resets it for every match after that.
+//        A match runs on a simulated clock until one of the early
+//        termination rules in the parameter file is met, and leaves a
+//        MatchResult behind.
+//
+//        A match only depends on its seed: the random number generator is
+//        seeded with it and the pitch is reset after seeding, whichever
+//        worker plays it and whatever that worker played before. The
+//        generator is the one of DetMath, which every worker keeps for
+//        itself, rather than rand(), which only some runtimes keep per
+//        thread.
+//
+//        With bMatchLanes set a worker plays a group of matches at a time,
+//        one per lane of a MatchLanes. The groups are always the same
+//        consecutive seeds, so a batch still gives the same results on any
+//        number of workers.
+//
+//------------------------------------------------------------------------
+#include <iosfwd>
+#include <vector>
+
+class MatchLanes;
+class SoccerPitch;
+class ThreadPool;
+
+//A compact record of one match.
+struct MatchResult {
+
+	enum termination{tick_limit, goal_limit, goal_difference, stalled};
+
+	unsigned int m_iSeed;
+
+	int m_iRedGoals;
+	int m_iBlueGoals;
+
+	//Number of updates each team had the ball.
+	int m_iRedPossession;
+	int m_iBluePossession;
+
+	int m_iRedShots;
+	int m_iBlueShots;
+
+	int m_iTicks;
+
+	//The most updates in a row the ball was in play without being touched.
+	int m_iLongestUntouched;
+
+	//Milliseconds taken to play the match.
+	double m_dWallTime;
+
+	termination m_Termination;
+
+	MatchResult() :m_iSeed(0), m_iRedGoals(0), m_iBlueGoals(0), m_iRedPossession(0), m_iBluePossession(0), m_iRedShots(0), m_iBlueShots(0), m_iTicks(0), m_iLongestUntouched(0), m_dWallTime(0.0), m_Termination(tick_limit) {}
+
+};
+
+//How the matches of a batch are played. Made with the values of the parameter file.
+struct BatchSettings {
+
+	//Play one match per lane of a MatchLanes.
+	bool m_bMatchLanes;
+
+	//Move the players of the lanes in single precision.
+	bool m_bFloatLanes;
+
+	//Move the players of the lanes the fast way.
+	bool m_bFastMotion;
+
+	BatchSettings();
+
+};
+
+class BatchRunner {
+
+private:
+	ThreadPool* m_pPool;
+
+	BatchSettings m_Settings;
+
+	//The pitch, or the lanes, of each worker. Only ever touched by its own worker.
+	std::vector<SoccerPitch*> m_Pitches;
+	std::vector<MatchLanes*> m_Lanes;
+
+	//Size of the pitches.
+	int m_cxClient;
+	int m_cyClient;
+
+	//The seeds and results of the matches being run.
+	std::vector<unsigned int> m_Seeds;
+	std::vector<MatchResult> m_Results;
+
+	//Plays match 'match' on the worker's pitch.
+	void PlayMatch(int match, int worker);
+
+	//Plays the matches from 'first' on, one per lane of the worker's lanes.
+	void PlayMatches(int first, int worker);
+
+	//Fills in the result of the match from the pitch it was played on.
+	void RecordResult(int match, const SoccerPitch* pitch, double WallTime);
+
+	//Frees the worker's pitch. Called on the worker's own thread as it exits.
+	void ReleaseWorker(int worker);
+
+	//Returns true if the match on the pitch should stop and sets 'reason' to the rule that stopped it.
+	bool IsFinished(const SoccerPitch* pitch, MatchResult::termination& reason)const;
+
+public:
+	BatchRunner(int NumWorkers, int cxClient, int cyClient, const BatchSettings& settings = BatchSettings());
+	~BatchRunner();
+
+	//Plays one match per seed. The results are in the same order as the seeds.
+	void Run(const std::vector<unsigned int>& seeds, std::vector<MatchResult>& results);
+
+	//Writes the results as comma separated values, one line per match after a header line.
+	static void WriteResults(std::ostream& os, const std::vector<MatchResult>& results);
+
+	//Reads results written by WriteResults, so batches played by different builds can be compared. Returns false
+	//if the stream doesn't hold them.
+	static bool ReadResults(std::istream& is, std::vector<MatchResult>& results);
+
+	//Number of matches stopped because nobody touched the ball any more. A batch with any of them has found a
+	//match the players can't finish.
+	static int NumStalled(const std::vector<MatchResult>& results);
+
+	//Writes, as comma separated values, the mean of each statistic over two batches played with different
+	//settings, the difference between them and the standard error of that difference.
+	static void WriteComparison(std::ostream& os, const std::vector<MatchResult>& reference, const std::vector<MatchResult>& results);
+
+};
+
+#endif // BATCHRUNNER_H
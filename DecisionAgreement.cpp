@@ -0,0 +1,193 @@
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <vector>
+
+#include "misc/FastMath.h"
+#include "misc/utils.h"
+
+#include "DecisionAgreement.h"
+#include "ParamLoader.h"
+#include "PlayerBase.h"
+#include "SoccerPitch.h"
+#include "SoccerTeam.h"
+
+//The FastMath functions WriteBenchmark times, each called with two numbers from [lo, hi].
+static double SqrtOf(double a, double) { return FastMath::Sqrt(a); }
+static double DistanceOf(double a, double b) { return FastMath::Distance(Vector2D(a, b), Vector2D(b, a)); }
+static double NormalizeOf(double a, double b) { return FastMath::Normalize(Vector2D(a, b)).x; }
+static double AcosOf(double a, double) { return FastMath::Acos(a); }
+static double Atan2Of(double a, double b) { return FastMath::Atan2(a, b); }
+
+struct BenchmarkedFunction {
+
+	const char* m_szName;
+	double(*m_pFunction)(double, double);
+	double m_dLo;
+	double m_dHi;
+
+};
+
+static const BenchmarkedFunction BenchmarkedFunctions[] = {
+	{ "sqrt", SqrtOf, 0.0, 10000.0 },
+	{ "distance", DistanceOf, -500.0, 500.0 },
+	{ "normalize", NormalizeOf, -500.0, 500.0 },
+	{ "acos", AcosOf, -1.0, 1.0 },
+	{ "atan2", Atan2Of, -500.0, 500.0 }
+};
+
+const int NumBenchmarkedFunctions = sizeof(BenchmarkedFunctions) / sizeof(BenchmarkedFunctions[0]);
+
+//The calls cycle through this many inputs, few enough to stay in the cache.
+const int NumBenchmarkInputs = 4096;
+
+//Calls the function NumCalls times and returns the milliseconds taken. The results are summed into sink so
+//the calls can't be optimized away.
+static double TimeCalls(double(*function)(double, double), const std::vector<double>& a, const std::vector<double>& b, int NumCalls, double& sink) {
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	double sum = 0.0;
+
+	for (int call = 0; call < NumCalls; ++call) sum += function(a[call % NumBenchmarkInputs], b[call % NumBenchmarkInputs]);
+
+	sink += sum;
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+}
+
+DecisionAgreement::DecisionAgreement() :m_iPasses(0), m_iPassDisagreements(0), m_iShots(0), m_iShotDisagreements(0), m_iSharedShots(0), m_dTargetShift(0.0), m_dMaxTargetShift(0.0) {}
+
+//----------------------------------------Sample----------------------------------------
+//---------------------------------------------------------------------------------------
+void DecisionAgreement::Sample(const SoccerPitch* pitch) {
+
+	bool WasInUse = FastMath::InUse();
+
+	SampleTeam(pitch->RedTeam());
+	SampleTeam(pitch->BlueTeam());
+
+	FastMath::Use(WasInUse);
+
+}
+
+//--------------------------------------SampleTeam--------------------------------------
+//---------------------------------------------------------------------------------------
+void DecisionAgreement::SampleTeam(const SoccerTeam* team) {
+
+	const std::vector<PlayerBase*>& players = team->Members();
+
+	for (unsigned int p = 0; p < players.size(); ++p) {
+
+		for (unsigned int r = 0; r < players.size(); ++r) {
+
+			if (r == p) continue;
+
+			FastMath::Use(false);
+			bool exact = team->IsPassSafeFromAllOpponents(players[p]->Pos(), players[r]->Pos(), players[r], Prm.MaxPassingForce);
+
+			FastMath::Use(true);
+			bool fast = team->IsPassSafeFromAllOpponents(players[p]->Pos(), players[r]->Pos(), players[r], Prm.MaxPassingForce);
+
+			++m_iPasses;
+			if (exact != fast) ++m_iPassDisagreements;
+
+		}
+
+		Vector2D ExactTarget;
+		Vector2D FastTarget;
+
+		FastMath::Use(false);
+		bool exact = team->CanShoot(players[p]->Pos(), Prm.MaxShootingForce, ExactTarget);
+
+		FastMath::Use(true);
+		bool fast = team->CanShoot(players[p]->Pos(), Prm.MaxShootingForce, FastTarget);
+
+		++m_iShots;
+		if (exact != fast) ++m_iShotDisagreements;
+
+		if (exact && fast) {
+
+			double shift = Vec2DDistance(ExactTarget, FastTarget);
+
+			++m_iSharedShots;
+			m_dTargetShift += shift;
+			m_dMaxTargetShift = MaxOf(m_dMaxTargetShift, shift);
+
+		}
+
+	}
+
+}
+
+//-----------------------------------------Write----------------------------------------
+//---------------------------------------------------------------------------------------
+void DecisionAgreement::Write(std::ostream& os)const {
+
+	os << "decision,asked,disagreements,disagreement_rate\n";
+	os << "pass_safe," << m_iPasses << "," << m_iPassDisagreements << "," << (m_iPasses ? (double)m_iPassDisagreements / m_iPasses : 0.0) << "\n";
+	os << "can_shoot," << m_iShots << "," << m_iShotDisagreements << "," << (m_iShots ? (double)m_iShotDisagreements / m_iShots : 0.0) << "\n";
+
+	os << "shots_found_both_ways,mean_target_shift,max_target_shift\n";
+	os << m_iSharedShots << "," << (m_iSharedShots ? m_dTargetShift / m_iSharedShots : 0.0) << "," << m_dMaxTargetShift << "\n";
+
+}
+
+//------------------------------------WriteBenchmark------------------------------------
+//
+// Both timings go through FastMath, so they are of what switching it on buys the game.
+// The inputs are spread evenly over each function's range, the second one shuffled.
+//---------------------------------------------------------------------------------------
+void DecisionAgreement::WriteBenchmark(std::ostream& os, int NumCalls) {
+
+	bool WasInUse = FastMath::InUse();
+
+	double sink = 0.0;
+
+	os << "function,calls,exact_ms,fast_ms,speedup,max_error\n";
+
+	for (int f = 0; f < NumBenchmarkedFunctions; ++f) {
+
+		const BenchmarkedFunction& bf = BenchmarkedFunctions[f];
+
+		std::vector<double> a(NumBenchmarkInputs);
+		std::vector<double> b(NumBenchmarkInputs);
+
+		for (int i = 0; i < NumBenchmarkInputs; ++i) {
+
+			a[i] = bf.m_dLo + (bf.m_dHi - bf.m_dLo) * (i + 0.5) / NumBenchmarkInputs;
+			b[i] = bf.m_dLo + (bf.m_dHi - bf.m_dLo) * ((i * 2654435761u) % NumBenchmarkInputs + 0.5) / NumBenchmarkInputs;
+
+		}
+
+		double MaxError = 0.0;
+
+		for (int i = 0; i < NumBenchmarkInputs; ++i) {
+
+			FastMath::Use(false);
+			double exact = bf.m_pFunction(a[i], b[i]);
+
+			FastMath::Use(true);
+			double fast = bf.m_pFunction(a[i], b[i]);
+
+			MaxError = MaxOf(MaxError, fabs(fast - exact));
+
+		}
+
+		FastMath::Use(false);
+		double ExactTime = TimeCalls(bf.m_pFunction, a, b, NumCalls, sink);
+
+		FastMath::Use(true);
+		double FastTime = TimeCalls(bf.m_pFunction, a, b, NumCalls, sink);
+
+		os << bf.m_szName << "," << NumCalls << "," << ExactTime << "," << FastTime << "," << (FastTime > 0.0 ? ExactTime / FastTime : 0.0) << "," << MaxError << "\n";
+
+	}
+
+	FastMath::Use(WasInUse);
+
+	//Keeps the sums alive.
+	if (sink == 1.0) os << "\n";
+
+}
@@ -0,0 +1,56 @@
+#ifndef DECISIONAGREEMENT_H
+#define DECISIONAGREEMENT_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: DecisionAgreement.h
+//
+//  Desc: Measures what the approximate math of FastMath costs and buys.
+//        Sample asks the pass safety and shooting questions of a pitch
+//        once with exact and once with approximate math and counts how
+//        often the answers differ. WriteBenchmark times the FastMath
+//        functions both ways and finds their largest errors.
+//
+//        The pitch is only asked questions, so sampling a match doesn't
+//        change how it plays out.
+//
+//------------------------------------------------------------------------
+#include <iosfwd>
+
+class SoccerPitch;
+class SoccerTeam;
+
+class DecisionAgreement {
+
+private:
+	//Number of decisions asked and number that came out differently with approximate math.
+	int m_iPasses;
+	int m_iPassDisagreements;
+	int m_iShots;
+	int m_iShotDisagreements;
+
+	//Shots found both ways, and how far apart, summed and at most, the two targets were.
+	int m_iSharedShots;
+	double m_dTargetShift;
+	double m_dMaxTargetShift;
+
+	//Asks the team's decisions both ways.
+	void SampleTeam(const SoccerTeam* team);
+
+public:
+	DecisionAgreement();
+
+	//Asks, for every player of both teams, whether a pass to each teammate is safe and whether he can shoot
+	//from where he stands, with exact and with approximate math. FastMath is left switched as it was found.
+	void Sample(const SoccerPitch* pitch);
+
+	//Writes the counts as comma separated values.
+	void Write(std::ostream& os)const;
+
+	//Times each FastMath function over NumCalls calls with exact and with approximate math, and writes the
+	//timings and the largest difference between the two as comma separated values.
+	static void WriteBenchmark(std::ostream& os, int NumCalls);
+
+};
+
+#endif // DECISIONAGREEMENT_H
@@ -2,7 +2,6 @@
 #include "2D/geometry.h"
 #include "2D/Transformations.h"
 #include "Debug/DebugConsole.h"
-#include "Game/EntityFunctionTemplates.h"
 #include "Game/Region.h"
 #include "misc/Cgdi.h"
 #include "time/Regulator.h"
@@ -12,6 +11,7 @@
 #include "PlayerBase.h"
 #include "SoccerTeam.h"
 #include "SteeringBehaviors.h"
+#include "ThinkTiers.h"
 
 #include <limits>
 
@@ -43,22 +43,73 @@ FieldPlayer::FieldPlayer(SoccerTeam* home_team, int home_region, State<FieldPlay
 
 }
 
+//-----------------------------------------Reset------------------------------------------
+//
+//----------------------------------------------------------------------------------------
+void FieldPlayer::Reset(Vector2D heading) {
+
+	PlayerBase::Reset(heading);
+
+	m_pStateMachine->SetCurrentState(Wait::Instance());
+	m_pStateMachine->SetPreviousState(Wait::Instance());
+	m_pStateMachine->CurrentState()->Enter(this);
+
+	m_pSteering->SeparationOn();
+
+	m_pKickLimiter->Restart();
+
+}
+
 //-----------------------------------------Update----------------------------------------
 //
 //----------------------------------------------------------------------------------------
 void FieldPlayer::Update() {
 
+	Think();
+	Steer();
+	CommitMove();
+
+}
+
+//-----------------------------------------Think-----------------------------------------
+//
+// A player whose think tier isn't due this update keeps to what he last decided.
+//----------------------------------------------------------------------------------------
+void FieldPlayer::Think() {
+
+	if (!Team()->GetThinkTiers()->IsDue(this)) return;
+
 	//Run the logic for the current state
 	m_pStateMachine->Update();
 
+	//A sleeping player who has decided to go somewhere is woken before he steers.
+	if (m_bAsleep && !IsIdle()) WakeUp();
+
+}
+
+//-----------------------------------------Steer-----------------------------------------
+//
+// Only the steering behaviors and the next state of this player are written. A sleeping
+// player holds still.
+//----------------------------------------------------------------------------------------
+void FieldPlayer::Steer() {
+
+	if (m_bAsleep) {
+		HoldStill();
+		return;
+	}
+
 	//Calculate the combined steering force
 	m_pSteering->Calculate();
 
+	Vector2D velocity = m_vVelocity;
+	Vector2D heading = m_vHeading;
+
 	//If no steering force is produced decelerate the player by applying a braking force.
 	if (m_pSteering->Force().isZero()) {
 
 		const double BrakingRate = 0.8;
-		m_vVelocity = m_vVelocity * BrakingRate;
+		velocity = velocity * BrakingRate;
 
 	}
 
@@ -69,28 +120,24 @@ void FieldPlayer::Update() {
 	Clamp(TurningForce, -Prm.PlayerMaxTurnRate, Prm.PlayerMaxTurnRate);
 
 	//Rotate the heading vector.
-	Vec2DRotateAroundOrigin(m_vHeading, TurningForce);
+	Vec2DRotateAroundOrigin(heading, TurningForce);
 
 	//Make sure the velocity vector points in the same direction as the heading vector
-	m_vVelocity = m_vHeading * m_vVelocity.Length();
-
-	//And recreate m_vSide.
-	m_vSide = m_vHeading.Perp();
+	velocity = heading * velocity.Length();
 
 	//Now to calculate the acceleration due to the force exerted by the forward component
-	//of the steering force in the direction of the player's heading.
-	Vector2D accel = m_vHeading * m_pSteering->ForwardComponent() / m_dMass;
+	//of the steering force in the direction of the new heading.
+	Vector2D accel = heading * heading.Dot(m_pSteering->Force()) / m_dMass;
 	
-	m_vVelocity += accel;
+	velocity += accel;
 
 	//Make sure player does not exceed maximum velocity.
-	m_vVelocity.Truncate(m_dMaxSpeed);
-
-	//Update the position.
-	m_vPosition += m_vVelocity;
+	velocity.Truncate(m_dMaxSpeed);
 
-	//Enforce a non-penetration constraint if desided.
-	if (Prm.bNonPenetrationConstraint) EnforceNonPenetrationContraint(this, AutoList<PlayerBase>::GetAllMembers());
+	m_vNextVelocity = velocity;
+	m_vNextHeading = heading;
+	m_vNextSide = heading.Perp();
+	m_vNextPosition = m_vPosition + velocity;
 
 }
 
@@ -99,7 +146,13 @@ void FieldPlayer::Update() {
 // Routes any messages appropriately.
 //----------------------------------------------------------------------------------------
 bool FieldPlayer::HandleMessage(const Telegram& msg) {
+
+	//Whatever the message asks is looked into on the player's next think.
+	Team()->GetThinkTiers()->Wake(this);
+	WakeUp();
+
 	return m_pStateMachine->HandleMessage(msg);
+
 }
 
 //-----------------------------------------Render----------------------------------------
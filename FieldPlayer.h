@@ -39,9 +39,15 @@ public:
 	FieldPlayer(SoccerTeam* home_team, int home_region, State<FieldPlayer>* start_state, Vector2D heading, Vector2D velocity, double mass, double max_force, double max_speed, double max_turn_rate, double scale, player_role role);
 	~FieldPlayer();
 
-	//Call this to update the player's position and orientation.
+	//Call this to update the player's position and orientation. Runs the three phases below in turn.
 	void Update();
 
+	void Think();
+	void Steer();
+
+	//Also puts the player back in the Wait state and restarts the kick regulator.
+	void Reset(Vector2D heading);
+
 	void Render();
 	bool HandleMessage(const Telegram& msg);
 	StateMachine<FieldPlayer>* GetFSM()const { return m_pStateMachine; }
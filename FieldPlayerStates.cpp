@@ -2,6 +2,7 @@
 #include "Debug/DebugConsole.h"
 #include "Messaging/MessageDispatcher.h"
 #include "Messaging/Telegram.h"
+#include "misc/FastMath.h"
 #include "time/Regulator.h"
 #include "FieldPlayer.h"
 #include "FieldPlayerStates.h"
@@ -109,7 +110,7 @@ bool GlobalPlayerState::OnMessage(FieldPlayer* player, const Telegram& telegram)
 		}
 
 		//Make the pass.
-		player->Ball()->Kick(receiver->Pos() - player->Ball()->Pos(), Prm.MaxPassingForce);
+		player->Ball()->Kick(receiver->Pos() - player->Ball()->Pos(), Prm.MaxPassingForce, player);
 
 		#ifdef PLAYER_STATE_INFO_ON
 			debug_con << "Player " << player->ID() << " passed ball to requesting player" << "";
@@ -144,7 +145,10 @@ ChaseBall* ChaseBall::Instance() {
 
 void ChaseBall::Enter(FieldPlayer* player) {
 
+	//The player going for the ball doesn't keep his distance from the others, or he
+	//can be held off a loose ball by the players around it.
 	player->Steering()->SeekOn();
+	player->Steering()->SeparationOff();
 
 	#ifdef PLAYER_STATE_INFO_ON
 		debug_con << "Player " << player->ID() << " enters chase state" << "";
@@ -155,12 +159,16 @@ void ChaseBall::Enter(FieldPlayer* player) {
 void ChaseBall::Execute(FieldPlayer* player) {
 
 	//If the ball is within kicking range the player changes state to KickBall.
-	if (player->BallWithinKickingRange()) player->GetFSM()->ChangeState(KickBall::Instance());
-	return;
+	if (player->BallWithinKickingRange()) {
+		player->GetFSM()->ChangeState(KickBall::Instance());
+		return;
+	}
 
 	//If the player is the closest player to the ball then he should keep chasing it.
-	if (player->IsClosestTeamMemberToBall()) player->Steering()->SetTarget(player->Ball()->Pos());
-	return;
+	if (player->IsClosestTeamMemberToBall()) {
+		player->Steering()->SetTarget(player->Ball()->Pos());
+		return;
+	}
 
 	//If the player is not closest to the ball anymore, he should return back to his home region and wait for another opportunity.
 	player->GetFSM()->ChangeState(ReturnToHomeRegion::Instance());
@@ -169,6 +177,7 @@ void ChaseBall::Execute(FieldPlayer* player) {
 
 void ChaseBall::Exit(FieldPlayer* player) {
 	player->Steering()->SeekOff();
+	player->Steering()->SeparationOn();
 }
 
 /** WAIT **/
@@ -294,6 +303,12 @@ void ReceiveBall::Execute(FieldPlayer* player) {
 	//If the player has 'arrived' at the steering target he should wait and turn to face the ball.
 	if (player->AtTarget()) {
 
+		//Unless the pass has already died on the way. Nobody else goes for the ball while he is the receiver.
+		if (player->Ball()->IsAtRest()) {
+			player->GetFSM()->ChangeState(ChaseBall::Instance());
+			return;
+		}
+
 		player->Steering()->ArriveOff();
 		player->Steering()->PursuitOff();
 		player->TrackBall();
@@ -335,9 +350,12 @@ void KickBall::Enter(FieldPlayer* player) {
 
 void KickBall::Execute(FieldPlayer* player) {
 
+	//If an opponent has got to the ball as well and taken control of it, the player takes it back.
+	if (!player->Team()->InControl()) player->Team()->SetControllingPlayer(player);
+
 	//Calculate the dot product of the vector pointing to the ball and the player's heading.
 	Vector2D ToBall = player->Ball()->Pos() - player->Pos();
-	double dot = player->Heading().Dot(Vec2DNormalize(ToBall));
+	double dot = player->Heading().Dot(FastMath::Normalize(ToBall));
 
 	//Cannot kick the ball if the goalkeeper is in possession or if it is behind the player or if there is already an assigned receiver.
 	//So just continue chasing the ball
@@ -375,7 +393,9 @@ void KickBall::Execute(FieldPlayer* player) {
 		//This is the direction the ball will be kicked in.
 		Vector2D KickDirection = BallTarget - player->Ball()->Pos();
 
-		player->Ball()->Kick(KickDirection, power);
+		player->Ball()->Kick(KickDirection, power, player);
+
+		player->Team()->IncrementShots();
 
 		//Change state.
 		player->GetFSM()->ChangeState(Wait::Instance());
@@ -393,22 +413,29 @@ void KickBall::Execute(FieldPlayer* player) {
 	power = Prm.MaxPassingForce * dot;
 
 	//Test if there are any potential candidates available to receive a pass.
-	if (player->IsThreatened() && player->Team()->FindPass(player, receiver, BallTarget, power, Prm.MinPassDist)) {
+	Vector2D ReceiveTarget;
+
+	if (player->IsThreatened() && player->Team()->FindPass(player, receiver, BallTarget, power, Prm.MinPassDist, &ReceiveTarget)) {
+
+		//A pass played off a wall is collected somewhere else than where it is kicked to.
+		bool bRebound = (ReceiveTarget != BallTarget);
 
 		//Add some noise to the kick.
 		BallTarget = player->Ball()->AddNoiseToKick(player->Ball()->Pos(), BallTarget);
 
+		if (!bRebound) ReceiveTarget = BallTarget;
+
 		//This is the direction the ball will be kicked in.
 		Vector2D KickDirection = BallTarget - player->Ball()->Pos();
 
-		player->Ball()->Kick(KickDirection, power);
+		player->Ball()->Kick(KickDirection, power, player);
 
 #ifdef PLAYER_STATE_INFO_ON
 		debug_con << "Player " << player->ID() << " passes the ball with force " << power << " to player " << receiver->ID() << " Target is " << BallTarget << "";
 #endif // PLAYER_STATE_INFO_ON
 
 		//Let the receiver know a pass is coming.
-		Dispatcher->DispatchMsg(SEND_MSG_IMMEDIATELY, player->ID(), receiver->ID(), Msg_ReceiveBall, &BallTarget);
+		Dispatcher->DispatchMsg(SEND_MSG_IMMEDIATELY, player->ID(), receiver->ID(), Msg_ReceiveBall, &ReceiveTarget);
 
 		//The player should wait at his current position unless instruced otherwise.
 		player->GetFSM()->ChangeState(Wait::Instance());
@@ -467,12 +494,12 @@ void Dribble::Execute(FieldPlayer* player) {
 		//This value works well when the player is attempting to control the ball and turn at the same time.
 		const double KickingForce = 0.8;
 
-		player->Ball()->Kick(direction, KickingForce);
+		player->Ball()->Kick(direction, KickingForce, player);
 
 	}
 
 	//Kick the ball down the field.
-	else player->Ball()->Kick(player->Team()->HomeGoal()->Facing(), Prm.MaxDribbleForce);
+	else player->Ball()->Kick(player->Team()->HomeGoal()->Facing(), Prm.MaxDribbleForce, player);
 
 	//The player has kicked the ball so he must now change state to follow it.
 	player->GetFSM()->ChangeState(ChaseBall::Instance());
@@ -502,8 +529,10 @@ void SupportAttacker::Enter(FieldPlayer* player) {
 void SupportAttacker::Execute(FieldPlayer* player) {
 
 	//If his team loses control go back home.
-	if (!player->Team()->InControl()) player->GetFSM()->ChangeState(ReturnToHomeRegion::Instance());
-	return;
+	if (!player->Team()->InControl()) {
+		player->GetFSM()->ChangeState(ReturnToHomeRegion::Instance());
+		return;
+	}
 
 	//If the best supporting spot changes, change the steering target.
 	if (player->Team()->GetSupportSpot() != player->Steering()->Target()) {
@@ -0,0 +1,61 @@
+#include "FormationLoader.h"
+#include "ParamLoader.h"
+#include "SoccerTeam.h"
+
+FormationLoader* FormationLoader::Instance() {
+
+	static FormationLoader instance;
+	return &instance;
+
+}
+
+FormationLoader::FormationLoader() :iniFileLoaderBase(Prm.FormationFile.c_str()) {
+
+	int NumPlayers = GetNextParameterInt();
+
+	assert((NumPlayers > 0) && "<FormationLoader::FormationLoader>: a team needs at least one player");
+
+	m_Slots.resize(NumPlayers);
+
+	int NumKeepers = 0;
+
+	for (int plyr = 0; plyr < NumPlayers; ++plyr) {
+
+		m_Slots[plyr].m_Role = RoleFromString(GetNextParameterString());
+
+		if (m_Slots[plyr].m_Role == PlayerBase::goal_keeper) ++NumKeepers;
+
+		for (int f = 0; f < NumFormations; ++f) m_Slots[plyr].m_BlueRegions[f] = GetNextParameterInt();
+		for (int f = 0; f < NumFormations; ++f) m_Slots[plyr].m_RedRegions[f] = GetNextParameterInt();
+
+	}
+
+	assert((NumKeepers == 1) && "<FormationLoader::FormationLoader>: a team must have exactly one goalkeeper");
+
+}
+
+//------------------------------------RoleFromString------------------------------------
+//---------------------------------------------------------------------------------------
+PlayerBase::player_role FormationLoader::RoleFromString(const std::string& role)const {
+
+	if (role == "goalkeeper") return PlayerBase::goal_keeper;
+	if (role == "attacker") return PlayerBase::attacker;
+	if (role == "defender") return PlayerBase::defender;
+
+	assert(false && "<FormationLoader::RoleFromString>: unknown role");
+
+	return PlayerBase::defender;
+
+}
+
+//--------------------------------------HomeRegion--------------------------------------
+//---------------------------------------------------------------------------------------
+int FormationLoader::HomeRegion(const SoccerTeam* team, formation f, int plyr)const {
+
+	assert((plyr >= 0) && (plyr < TeamSize()));
+
+	if (team->Color() == SoccerTeam::blue) return m_Slots[plyr].m_BlueRegions[f];
+
+	return m_Slots[plyr].m_RedRegions[f];
+
+}
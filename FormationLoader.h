@@ -0,0 +1,60 @@
+#ifndef FORMATIONLOADER_H
+#define FORMATIONLOADER_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: FormationLoader.h
+//
+//  Desc: Singleton class to load the team size, the role of each player
+//        and the home region of each player in every formation from the
+//        file named by the FormationFile parameter. Both teams field the
+//        same players; the regions are given separately for each team.
+//
+//------------------------------------------------------------------------
+#include <string>
+#include <vector>
+
+#include "misc/iniFileLoaderBase.h"
+#include "PlayerBase.h"
+
+#define Frm (*FormationLoader::Instance())
+
+class SoccerTeam;
+
+class FormationLoader : public iniFileLoaderBase {
+
+public:
+	//The formations a team switches between. Each team state uses one of them.
+	enum formation{defending, attacking, NumFormations};
+
+private:
+	//A data structure to hold what is known about one player of a team.
+	struct PlayerSlot {
+
+		PlayerBase::player_role m_Role;
+
+		//Home region in each formation.
+		int m_BlueRegions[NumFormations];
+		int m_RedRegions[NumFormations];
+
+	};
+
+	std::vector<PlayerSlot> m_Slots;
+
+	PlayerBase::player_role RoleFromString(const std::string& role)const;
+
+	FormationLoader();
+
+public:
+	static FormationLoader* Instance();
+
+	int TeamSize()const { return (int)m_Slots.size(); }
+
+	PlayerBase::player_role Role(int plyr)const { return m_Slots[plyr].m_Role; }
+
+	//The home region of player 'plyr' of the team in the given formation.
+	int HomeRegion(const SoccerTeam* team, formation f, int plyr)const;
+
+};
+
+#endif // FORMATIONLOADER_H
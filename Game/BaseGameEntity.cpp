@@ -1,7 +1,7 @@
 #include "BaseGameEntity.h"
 
 
-int BaseGameEntity::m_iNextValidID = 0;
+thread_local int BaseGameEntity::m_iNextValidID = 0;
 
 //------------------------------ ctor -----------------------------------------
 //-----------------------------------------------------------------------------
@@ -41,8 +41,9 @@ private:
   bool        m_bTag;
 
   //this is the next valid ID. Each time a BaseGameEntity is instantiated
-  //this value is updated
-  static int  m_iNextValidID;
+  //this value is updated. Each thread counts its own IDs, matching the
+  //per thread EntityManager
+  static thread_local int  m_iNextValidID;
 
   //this must be called within each constructor to make sure the ID is set
   //correctly. It verifies that the value passed to the method is greater
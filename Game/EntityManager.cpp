@@ -4,11 +4,12 @@
 
 //--------------------------- Instance ----------------------------------------
 //
-//   this class is a singleton
+//   this class is a singleton. Each thread has its own instance so that
+//   several pitches can be run side by side on different threads
 //-----------------------------------------------------------------------------
 EntityManager* EntityManager::Instance()
 {
-  static EntityManager instance;
+  static thread_local EntityManager instance;
 
   return &instance;
 }
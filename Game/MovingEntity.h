@@ -118,7 +118,7 @@ inline bool MovingEntity::RotateHeadingToFacePosition(Vector2D target)
   Clamp(dot, -1, 1);
 
   //first determine the angle between the heading vector and the target
-  double angle = acos(dot);
+  double angle = DetMath::Acos(dot);
 
   //return true if the player is facing the target
   if (angle < 0.00001) return true;
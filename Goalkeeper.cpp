@@ -1,5 +1,4 @@
 #include "2D/Transformations.h"
-#include "Game/EntityFunctionTemplates.h"
 #include "misc/Cgdi.h"
 #include "Goal.h"
 #include "Goalkeeper.h"
@@ -8,6 +7,7 @@
 #include "SoccerPitch.h"
 #include "SoccerTeam.h"
 #include "SteeringBehaviors.h"
+#include "ThinkTiers.h"
 
 GoalKeeper::GoalKeeper(SoccerTeam* home_team, int home_region, State<GoalKeeper>* start_state, Vector2D heading, Vector2D velocity, double mass, double max_force, double max_speed, double max_turn_rate, double scale) :
 	PlayerBase(home_team, home_region, heading, velocity, mass, max_force, max_speed, max_turn_rate, scale, PlayerBase::goal_keeper) {
@@ -21,12 +21,42 @@ GoalKeeper::GoalKeeper(SoccerTeam* home_team, int home_region, State<GoalKeeper>
 
 }
 
+//-----------------------------------------Reset------------------------------------------
+void GoalKeeper::Reset(Vector2D heading) {
+
+	PlayerBase::Reset(heading);
+
+	m_vLookAt.Zero();
+
+	m_pStateMachine->SetCurrentState(TendGoal::Instance());
+	m_pStateMachine->SetPreviousState(TendGoal::Instance());
+	m_pStateMachine->CurrentState()->Enter(this);
+
+}
+
 //-----------------------------------------Update-----------------------------------------
 void GoalKeeper::Update() {
 
+	Think();
+	Steer();
+	CommitMove();
+
+}
+
+//-----------------------------------------Think------------------------------------------
+void GoalKeeper::Think() {
+
+	//A goal keeper is always in the near tier, so this only skips the updates the keepers don't decide on.
+	if (!Team()->GetThinkTiers()->IsDue(this)) return;
+
 	//Run the logic for the current state.
 	m_pStateMachine->Update();
 
+}
+
+//-----------------------------------------Steer------------------------------------------
+void GoalKeeper::Steer() {
+
 	//Calculate the combined force from each steering behavior.
 	Vector2D SteeringForce = m_pSteering->Calculate();
 
@@ -34,27 +64,34 @@ void GoalKeeper::Update() {
 	Vector2D Acceleration = SteeringForce / m_dMass;
 
 	//Update velocity.
-	m_vVelocity += Acceleration;
+	m_vNextVelocity = m_vVelocity + Acceleration;
 
 	//Make sure player does not exceed maximum velocity.
-	m_vVelocity.Truncate(m_dMaxSpeed);
+	m_vNextVelocity.Truncate(m_dMaxSpeed);
 
 	//Update the position.
-	m_vPosition += m_vVelocity;
-
-	//Enforce a non-penetration constraint if desired.
-	if (Prm.bNonPenetrationConstraint) EnforceNonPenetrationContraint(this, AutoList<PlayerBase>::GetAllMembers());
+	m_vNextPosition = m_vPosition + m_vNextVelocity;
 
 	//Update the heading if the player has a non zero velocity.
-	if (!m_vVelocity.isZero()) {
+	m_vNextHeading = m_vHeading;
+	m_vNextSide = m_vSide;
+
+	if (!m_vNextVelocity.isZero()) {
 
-		m_vHeading = Vec2DNormalize(m_vVelocity);
-		m_vSide = m_vHeading.Perp();
+		m_vNextHeading = Vec2DNormalize(m_vNextVelocity);
+		m_vNextSide = m_vNextHeading.Perp();
 
 	}
 
+	UpdateLookAt();
+
+}
+
+//--------------------------------------UpdateLookAt--------------------------------------
+void GoalKeeper::UpdateLookAt() {
+
 	//Look-at vector always points toward the ball.
-	if (!Pitch()->GoalKeeperHasBall()) m_vLookAt = Vec2DNormalize(Ball()->Pos() - Pos());
+	if (!Pitch()->GoalKeeperHasBall()) m_vLookAt = Vec2DNormalize(Ball()->Pos() - m_vNextPosition);
 
 }
 
@@ -79,7 +116,11 @@ Vector2D GoalKeeper::GetRearInterposeTarget()const {
 // Route any messages appropriately.
 //----------------------------------------------------------------------------------------
 bool GoalKeeper::HandleMessage(const Telegram& msg) {
+
+	Team()->GetThinkTiers()->Wake(this);
+
 	return m_pStateMachine->HandleMessage(msg);
+
 }
 
 //-----------------------------------------Render----------------------------------------
@@ -29,6 +29,14 @@ public:
 
 	//These must be implemented
 	void Update();
+	void Think();
+	void Steer();
+
+	//Points the look-at vector at the ball from where the keeper is moving to. The last thing Steer does.
+	void UpdateLookAt();
+
+	//Also puts the keeper back in the TendGoal state.
+	void Reset(Vector2D heading);
 	void Render();
 	bool HandleMessage(const Telegram& msg);
 
@@ -207,18 +207,19 @@ void PutBallBackInPlay::Execute(GoalKeeper* keeper) {
 
 	PlayerBase* receiver = NULL;
 	Vector2D BallTarget;
+	Vector2D ReceiveTarget;
 
 	//Test if there are players further forward on the field we might be able to pass to. If so, make a pass.
-	if (keeper->Team()->FindPass(keeper, receiver, BallTarget, Prm.MaxPassingForce, Prm.GoalKeeperMinPassDist)) {
+	if (keeper->Team()->FindPass(keeper, receiver, BallTarget, Prm.MaxPassingForce, Prm.GoalKeeperMinPassDist, &ReceiveTarget)) {
 
 		//Make the pass.
-		keeper->Ball()->Kick(Vec2DNormalize(BallTarget - keeper->Ball()->Pos()), Prm.MaxPassingForce);
+		keeper->Ball()->Kick(Vec2DNormalize(BallTarget - keeper->Ball()->Pos()), Prm.MaxPassingForce, keeper);
 
 		//Goalkeeper no longer has ball.
 		keeper->Pitch()->SetGoalKeeperHasBall(false);
 
 		//Let the receiving player know the ball's comin' at him.
-		Dispatcher->DispatchMsg(SEND_MSG_IMMEDIATELY, keeper->ID(), receiver->ID(), Msg_ReceiveBall, &BallTarget);
+		Dispatcher->DispatchMsg(SEND_MSG_IMMEDIATELY, keeper->ID(), receiver->ID(), Msg_ReceiveBall, &ReceiveTarget);
 
 		//Go back to tending the goal
 		keeper->GetFSM()->ChangeState(TendGoal::Instance());
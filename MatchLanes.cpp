@@ -0,0 +1,215 @@
+#include <cassert>
+
+#include "MatchLanes.h"
+#include "ParamLoader.h"
+#include "PlayerBase.h"
+#include "PlayerMotion.h"
+#include "SoccerBall.h"
+#include "SoccerPitch.h"
+
+#ifdef SIMD_SSE2
+//Picks a where the mask is set and b where it isn't.
+inline __m128d Select(__m128d mask, __m128d a, __m128d b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+#endif
+
+MatchLanes::MatchLanes(int cxClient, int cyClient, bool bFloat, bool bFastMotion) :m_iNumLanes(LanesPerGroup(bFloat)), m_bFloat(bFloat), m_bFastMotion(bFastMotion), m_Active(m_iNumLanes, false) {
+
+	assert(Prm.bDoubleBufferedUpdate && "<MatchLanes::MatchLanes>: the pitches must use the buffered update");
+
+	for (int lane = 0; lane < m_iNumLanes; ++lane) m_Pitches.push_back(new SoccerPitch(cxClient, cyClient));
+
+	//Every pitch is made from the same formation so the players line up across the lanes.
+	if (m_bFloat) m_FloatPlayers.assign(m_Pitches[0]->Players().size(), PlayerMotionf(m_iNumLanes));
+	else m_Players.assign(m_Pitches[0]->Players().size(), PlayerMotion(m_iNumLanes));
+
+}
+
+MatchLanes::~MatchLanes() {
+
+	for (unsigned int lane = 0; lane < m_Pitches.size(); ++lane) delete m_Pitches[lane];
+
+}
+
+//--------------------------------------LanesPerGroup-----------------------------------
+//---------------------------------------------------------------------------------------
+int MatchLanes::LanesPerGroup(bool bFloat) {
+
+	return bFloat ? SimdFloatWidth : SimdDoubleWidth;
+
+}
+
+//----------------------------------------AnyActive-------------------------------------
+//---------------------------------------------------------------------------------------
+bool MatchLanes::AnyActive()const {
+
+	for (int lane = 0; lane < m_iNumLanes; ++lane) {
+		if (m_Active[lane]) return true;
+	}
+
+	return false;
+
+}
+
+//-----------------------------------------Update---------------------------------------
+//
+// The same steps as a buffered SoccerPitch::Update, with the ball and player physics of
+// all the lanes done together.
+//---------------------------------------------------------------------------------------
+void MatchLanes::Update() {
+
+	for (int lane = 0; lane < m_iNumLanes; ++lane) {
+
+		if (!m_Active[lane]) continue;
+
+		m_Pitches[lane]->AdvanceTick();
+		m_Pitches[lane]->Ball()->BeginUpdate();
+
+	}
+
+	UpdateBalls();
+
+	for (int lane = 0; lane < m_iNumLanes; ++lane) {
+
+		if (!m_Active[lane]) continue;
+
+		m_Pitches[lane]->ThinkPlayers();
+		m_Pitches[lane]->CalculateSteeringForces();
+
+	}
+
+	MovePlayers();
+
+	for (int lane = 0; lane < m_iNumLanes; ++lane) {
+
+		if (!m_Active[lane]) continue;
+
+		m_Pitches[lane]->CommitPlayers();
+		m_Pitches[lane]->EndUpdate();
+
+	}
+
+}
+
+//---------------------------------------UpdateBalls------------------------------------
+//---------------------------------------------------------------------------------------
+void MatchLanes::UpdateBalls() {
+
+	double VelX[MaxLanes];
+	double VelY[MaxLanes];
+	bool Moving[MaxLanes];
+
+	for (int lane = 0; lane < m_iNumLanes; ++lane) {
+
+		Vector2D velocity = m_Pitches[lane]->Ball()->Velocity();
+
+		VelX[lane] = velocity.x;
+		VelY[lane] = velocity.y;
+
+	}
+
+	for (int first = 0; first < m_iNumLanes; first += SimdDoubleWidth) ApplyFriction(VelX + first, VelY + first, Prm.Friction, Moving + first);
+
+	for (int lane = 0; lane < m_iNumLanes; ++lane) {
+
+		if (!m_Active[lane] || !Moving[lane]) continue;
+
+		SoccerBall* ball = m_Pitches[lane]->Ball();
+
+		ball->SetVelocity(Vector2D(VelX[lane], VelY[lane]));
+		ball->FinishUpdate();
+
+	}
+
+}
+
+//---------------------------------------MovePlayers------------------------------------
+//---------------------------------------------------------------------------------------
+void MatchLanes::MovePlayers() {
+
+	if (m_bFloat) MovePlayers(m_FloatPlayers, PlayerMotionf::fast);
+	else MovePlayers(m_Players, m_bFastMotion ? PlayerMotion::fast : PlayerMotion::reference);
+
+}
+
+template <class motion>
+void MatchLanes::MovePlayers(std::vector<motion>& players, typename motion::integration how) {
+
+	const std::vector<PlayerBase*>& roles = m_Pitches[0]->Players();
+
+	for (unsigned int p = 0; p < players.size(); ++p) {
+
+		motion& set = players[p];
+
+		//The lanes share the registers, so the player is only left out of the integration if he is asleep
+		//in every lane still playing. A sleeping player's lane isn't loaded and its result is thrown away.
+		bool awake = false;
+
+		for (int lane = 0; lane < m_iNumLanes; ++lane) {
+
+			PlayerBase* player = m_Pitches[lane]->Players()[p];
+
+			if (!player->IsAsleep()) {
+				set.Load(lane, player);
+				awake = awake || m_Active[lane];
+			}
+			else if (m_Active[lane]) player->HoldStill();
+
+		}
+
+		if (!awake) continue;
+
+		if (roles[p]->Role() == PlayerBase::goal_keeper) set.IntegrateGoalKeepers(how);
+		else set.IntegrateFieldPlayers(how);
+
+		for (int lane = 0; lane < m_iNumLanes; ++lane) {
+
+			PlayerBase* player = m_Pitches[lane]->Players()[p];
+
+			if (m_Active[lane] && !player->IsAsleep()) set.Store(lane, player);
+
+		}
+
+	}
+
+}
+
+//--------------------------------------ApplyFriction-----------------------------------
+//---------------------------------------------------------------------------------------
+void MatchLanes::ApplyFriction(double* VelX, double* VelY, double friction, bool* Moving) {
+
+#ifdef SIMD_SSE2
+	__m128d vx = _mm_loadu_pd(VelX);
+	__m128d vy = _mm_loadu_pd(VelY);
+	__m128d f = _mm_set1_pd(friction);
+
+	__m128d LengthSq = _mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy));
+	__m128d moving = _mm_cmpgt_pd(LengthSq, _mm_mul_pd(f, f));
+
+	//A moving ball is always longer than epsilon so Vec2DNormalize always divides.
+	__m128d length = _mm_sqrt_pd(LengthSq);
+
+	_mm_storeu_pd(VelX, Select(moving, _mm_add_pd(vx, _mm_mul_pd(_mm_div_pd(vx, length), f)), vx));
+	_mm_storeu_pd(VelY, Select(moving, _mm_add_pd(vy, _mm_mul_pd(_mm_div_pd(vy, length), f)), vy));
+
+	int mask = _mm_movemask_pd(moving);
+
+	for (int lane = 0; lane < SimdDoubleWidth; ++lane) Moving[lane] = (mask & (1 << lane)) != 0;
+#else
+	for (int lane = 0; lane < SimdDoubleWidth; ++lane) {
+
+		Vector2D velocity(VelX[lane], VelY[lane]);
+
+		Moving[lane] = velocity.LengthSq() > friction * friction;
+
+		if (!Moving[lane]) continue;
+
+		velocity += Vec2DNormalize(velocity) * friction;
+
+		VelX[lane] = velocity.x;
+		VelY[lane] = velocity.y;
+
+	}
+#endif
+
+}
+
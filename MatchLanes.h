@@ -0,0 +1,99 @@
+#ifndef MATCHLANES_H
+#define MATCHLANES_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: MatchLanes.h
+//
+//  Desc: Steps one pitch per SIMD lane together. The state machines and
+//        steering forces of each pitch are still worked out one pitch at
+//        a time, but the physics is done for every lane at once: the
+//        ball's friction and the integration of the players' motion run
+//        on blocks holding the same player (or the ball) of every lane,
+//        side by side, so one SSE instruction moves that player in every
+//        match.
+//
+//        The ball's friction gives bit for bit the same result as
+//        SoccerBall::Update, and the players are moved by PlayerMotion with
+//        one entry per lane. The pitches share the thread's random number
+//        generator though, so a match played in a lane depends on the
+//        matches in the other lanes.
+//
+//        With float lanes the players are moved in single precision, by
+//        PlayerMotionf, and there are four lanes instead of two. The balls
+//        are still moved in double precision.
+//
+//        Only buffered updates can be split up like this.
+//
+//------------------------------------------------------------------------
+#include <vector>
+
+#include "misc/simd.h"
+
+#include "PlayerMotion.h"
+
+class SoccerPitch;
+
+class MatchLanes {
+
+public:
+	//The most lanes a MatchLanes can have.
+	enum { MaxLanes = SimdFloatWidth };
+
+private:
+	int m_iNumLanes;
+
+	//Set if the players are moved in single precision.
+	bool m_bFloat;
+
+	//Set if the players are moved the fast way. They always are in single precision.
+	bool m_bFastMotion;
+
+	std::vector<SoccerPitch*> m_Pitches;
+
+	//Lanes whose pitch is updated. The others keep their pitch as it is.
+	std::vector<bool> m_Active;
+
+	//One set per player, in the order of SoccerPitch::Players, holding that player of every lane.
+	//Only the one of the lanes' precision is used.
+	std::vector<PlayerMotion> m_Players;
+	std::vector<PlayerMotionf> m_FloatPlayers;
+
+	//Applies the friction to the balls and moves the ones still moving.
+	void UpdateBalls();
+
+	//Works out where every player moves to this tick.
+	void MovePlayers();
+
+	template <class motion>
+	void MovePlayers(std::vector<motion>& players, typename motion::integration how);
+
+	//Applies the friction of SoccerBall::Update to the balls of SimdDoubleWidth lanes. Moving is set for
+	//the lanes whose ball is still moving, and only their velocity is changed.
+	static void ApplyFriction(double* VelX, double* VelY, double friction, bool* Moving);
+
+	MatchLanes(const MatchLanes&);
+	MatchLanes& operator=(const MatchLanes&);
+
+public:
+	MatchLanes(int cxClient, int cyClient, bool bFloat, bool bFastMotion);
+	~MatchLanes();
+
+	//Number of lanes a MatchLanes has, in single or double precision.
+	static int LanesPerGroup(bool bFloat);
+
+	int NumLanes()const { return m_iNumLanes; }
+
+	//Steps every active pitch one update.
+	void Update();
+
+	SoccerPitch* Pitch(int lane)const { return m_Pitches[lane]; }
+
+	bool IsActive(int lane)const { return m_Active[lane]; }
+	void SetActive(int lane, bool active) { m_Active[lane] = active; }
+
+	bool AnyActive()const;
+
+};
+
+#endif // MATCHLANES_H
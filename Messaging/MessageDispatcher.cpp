@@ -11,11 +11,12 @@ using std::set;
 
 //--------------------------- Instance ----------------------------------------
 //
-//   this class is a singleton
+//   this class is a singleton. Each thread has its own instance so that
+//   several pitches can be run side by side on different threads
 //-----------------------------------------------------------------------------
 MessageDispatcher* MessageDispatcher::Instance()
 {
-  static MessageDispatcher instance; 
+  static thread_local MessageDispatcher instance;
   
   return &instance;
 }
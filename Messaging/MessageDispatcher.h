@@ -64,6 +64,9 @@ public:
   //send out any delayed messages. This method is called each time through   
   //the main game loop.
   void DispatchDelayedMessages();
+
+  //throws away any delayed messages still waiting to be sent
+  void ClearDelayedMessages(){PriorityQ.clear();}
 };
 
 
@@ -0,0 +1,323 @@
+#include <math.h>
+
+#include "misc/utils.h"
+
+#include "NonPenetrationSolver.h"
+#include "ParamLoader.h"
+#include "PlayerBase.h"
+#include "SoccerPitch.h"
+#include "SoccerTeam.h"
+
+NonPenetrationSolver::NonPenetrationSolver(SoccerPitch* pitch) :m_pPitch(pitch), m_dLeft(0.0), m_dTop(0.0), m_dCellSize(1.0), m_iCellsX(0), m_iCellsY(0), m_iNumPairs(0) {}
+
+//----------------------------------------CellX/Y---------------------------------------
+//
+// Positions outside the grid are clamped to the border cells. Clamping never moves two
+// positions further apart, so overlapping players still end up in neighbouring cells.
+//---------------------------------------------------------------------------------------
+int NonPenetrationSolver::CellX(double x)const {
+
+	int col = (int)((x - m_dLeft) / m_dCellSize);
+
+	if (col < 0) return 0;
+	if (col > m_iCellsX - 1) return m_iCellsX - 1;
+
+	return col;
+
+}
+
+int NonPenetrationSolver::CellY(double y)const {
+
+	int row = (int)((y - m_dTop) / m_dCellSize);
+
+	if (row < 0) return 0;
+	if (row > m_iCellsY - 1) return m_iCellsY - 1;
+
+	return row;
+
+}
+
+//-----------------------------------------Gather---------------------------------------
+//
+// Copies the players of both teams into the arrays.
+//---------------------------------------------------------------------------------------
+void NonPenetrationSolver::Gather() {
+
+	m_Players.clear();
+	m_Players.insert(m_Players.end(), m_pPitch->RedTeam()->Members().begin(), m_pPitch->RedTeam()->Members().end());
+	m_Players.insert(m_Players.end(), m_pPitch->BlueTeam()->Members().begin(), m_pPitch->BlueTeam()->Members().end());
+
+	int NumPlayers = (int)m_Players.size();
+
+	m_PosX.resize(NumPlayers);
+	m_PosY.resize(NumPlayers);
+	m_Radius.resize(NumPlayers);
+	m_MoveX.resize(NumPlayers);
+	m_MoveY.resize(NumPlayers);
+
+	for (int p = 0; p < NumPlayers; ++p) {
+
+		m_PosX[p] = m_Players[p]->Pos().x;
+		m_PosY[p] = m_Players[p]->Pos().y;
+		m_Radius[p] = m_Players[p]->BRadius();
+
+	}
+
+}
+
+//---------------------------------------BuildGrid--------------------------------------
+//
+// The cells are as wide as the largest pair of radii so overlapping players are always
+// in the same or neighbouring cells. The players are sorted into the cells with a counting sort.
+//---------------------------------------------------------------------------------------
+void NonPenetrationSolver::BuildGrid() {
+
+	double MaxRadius = 0.0;
+
+	for (unsigned int p = 0; p < m_Radius.size(); ++p) MaxRadius = MaxOf(MaxRadius, m_Radius[p]);
+
+	const Region* area = m_pPitch->PlayingArea();
+
+	m_dLeft = area->Left();
+	m_dTop = area->Top();
+	m_dCellSize = MaxOf(2.0 * MaxRadius, 1.0);
+	m_iCellsX = (int)(area->Width() / m_dCellSize) + 1;
+	m_iCellsY = (int)(area->Height() / m_dCellSize) + 1;
+
+	int NumCells = m_iCellsX * m_iCellsY;
+
+	m_CellStart.assign(NumCells + 1, 0);
+	m_PlayerCell.resize(m_Players.size());
+	m_CellPlayers.resize(m_Players.size());
+
+	for (unsigned int p = 0; p < m_Players.size(); ++p) {
+
+		m_PlayerCell[p] = CellY(m_PosY[p]) * m_iCellsX + CellX(m_PosX[p]);
+		++m_CellStart[m_PlayerCell[p] + 1];
+
+	}
+
+	for (int cell = 0; cell < NumCells; ++cell) m_CellStart[cell + 1] += m_CellStart[cell];
+
+	//Fill the cells.
+	std::vector<int> cursor(m_CellStart.begin(), m_CellStart.end() - 1);
+
+	for (unsigned int p = 0; p < m_Players.size(); ++p) m_CellPlayers[cursor[m_PlayerCell[p]]++] = p;
+
+}
+
+//---------------------------------------FindPairs--------------------------------------
+//
+// Each player is tested against the players of his own and the eight neighbouring cells.
+// Only players with a higher index are taken, so each overlapping pair is recorded once.
+// The pairs are only looked for once per tick, before the relaxation. Players that are
+// pushed into each other while it runs are not separated until the next tick.
+//---------------------------------------------------------------------------------------
+void NonPenetrationSolver::FindPairs() {
+
+	m_PairA.clear();
+	m_PairB.clear();
+
+	for (unsigned int a = 0; a < m_Players.size(); ++a) {
+
+		int col = m_PlayerCell[a] % m_iCellsX;
+		int row = m_PlayerCell[a] / m_iCellsX;
+
+		for (int y = MaxOf(row - 1, 0); y <= MinOf(row + 1, m_iCellsY - 1); ++y) {
+
+			for (int x = MaxOf(col - 1, 0); x <= MinOf(col + 1, m_iCellsX - 1); ++x) {
+
+				int cell = y * m_iCellsX + x;
+
+				for (int i = m_CellStart[cell]; i < m_CellStart[cell + 1]; ++i) {
+
+					int b = m_CellPlayers[i];
+
+					if (b <= (int)a) continue;
+
+					double dx = m_PosX[b] - m_PosX[a];
+					double dy = m_PosY[b] - m_PosY[a];
+					double radii = m_Radius[a] + m_Radius[b];
+
+					if (dx * dx + dy * dy <= radii * radii) {
+
+						m_PairA.push_back(a);
+						m_PairB.push_back(b);
+
+					}
+
+				}
+
+			}
+
+		}
+
+	}
+
+	m_iNumPairs = (int)m_PairA.size();
+
+	m_PairMoveX.resize(m_iNumPairs);
+	m_PairMoveY.resize(m_iNumPairs);
+
+}
+
+//------------------------------------ListPlayerPairs-----------------------------------
+//
+// Lists the pairs of each player with a counting sort. The pairs of a player keep the
+// order they were found in, so summing them adds the corrections in the same order
+// every tick.
+//---------------------------------------------------------------------------------------
+void NonPenetrationSolver::ListPlayerPairs() {
+
+	int NumPlayers = (int)m_Players.size();
+
+	m_PlayerPairStart.assign(NumPlayers + 1, 0);
+	m_PlayerPairs.resize(2 * m_iNumPairs);
+
+	for (int p = 0; p < m_iNumPairs; ++p) {
+
+		++m_PlayerPairStart[m_PairA[p] + 1];
+		++m_PlayerPairStart[m_PairB[p] + 1];
+
+	}
+
+	for (int player = 0; player < NumPlayers; ++player) m_PlayerPairStart[player + 1] += m_PlayerPairStart[player];
+
+	std::vector<int> cursor(m_PlayerPairStart.begin(), m_PlayerPairStart.end() - 1);
+
+	for (int p = 0; p < m_iNumPairs; ++p) {
+
+		m_PlayerPairs[cursor[m_PairA[p]]++] = p;
+		m_PlayerPairs[cursor[m_PairB[p]]++] = p;
+
+	}
+
+}
+
+//---------------------------------------RelaxPairs-------------------------------------
+//---------------------------------------------------------------------------------------
+void NonPenetrationSolver::RelaxPairs(const int* PairA, const int* PairB, int First, int Last, const double* PosX, const double* PosY, const double* Radius, double* PairMoveX, double* PairMoveY) {
+
+	for (int p = First; p < Last; ++p) {
+
+		int a = PairA[p];
+		int b = PairB[p];
+
+		double dx = PosX[b] - PosX[a];
+		double dy = PosY[b] - PosY[a];
+		double dist = sqrt(dx * dx + dy * dy);
+
+		double overlap = Radius[a] + Radius[b] - dist;
+
+		PairMoveX[p] = 0.0;
+		PairMoveY[p] = 0.0;
+
+		if (overlap < 0) continue;
+
+		//Players exactly on top of each other are separated along the x axis.
+		double nx = 1.0;
+		double ny = 0.0;
+
+		if (dist > MinDouble) {
+
+			nx = dx / dist;
+			ny = dy / dist;
+
+		}
+
+		double half = overlap * 0.5;
+
+		PairMoveX[p] = nx * half;
+		PairMoveY[p] = ny * half;
+
+	}
+
+}
+
+//----------------------------------------SumMoves--------------------------------------
+//---------------------------------------------------------------------------------------
+void NonPenetrationSolver::SumMoves(const int* PairA, const int* PlayerPairStart, const int* PlayerPairs, int First, int Last, const double* PairMoveX, const double* PairMoveY, double* MoveX, double* MoveY) {
+
+	for (int player = First; player < Last; ++player) {
+
+		MoveX[player] = 0.0;
+		MoveY[player] = 0.0;
+
+		for (int i = PlayerPairStart[player]; i < PlayerPairStart[player + 1]; ++i) {
+
+			int p = PlayerPairs[i];
+
+			if (PairA[p] == player) {
+
+				MoveX[player] -= PairMoveX[p];
+				MoveY[player] -= PairMoveY[p];
+
+			} else {
+
+				MoveX[player] += PairMoveX[p];
+				MoveY[player] += PairMoveY[p];
+
+			}
+
+		}
+
+	}
+
+}
+
+//-----------------------------------------Relax----------------------------------------
+//---------------------------------------------------------------------------------------
+void NonPenetrationSolver::Relax() {
+
+	if (m_iNumPairs == 0) return;
+
+	ListPlayerPairs();
+
+	int NumPlayers = (int)m_Players.size();
+
+	for (int iteration = 0; iteration < Prm.NonPenetrationIterations; ++iteration) {
+
+		RelaxPairs(&m_PairA[0], &m_PairB[0], 0, m_iNumPairs, &m_PosX[0], &m_PosY[0], &m_Radius[0], &m_PairMoveX[0], &m_PairMoveY[0]);
+		SumMoves(&m_PairA[0], &m_PlayerPairStart[0], &m_PlayerPairs[0], 0, NumPlayers, &m_PairMoveX[0], &m_PairMoveY[0], &m_MoveX[0], &m_MoveY[0]);
+
+		for (unsigned int p = 0; p < m_Players.size(); ++p) {
+
+			m_PosX[p] += m_MoveX[p];
+			m_PosY[p] += m_MoveY[p];
+
+		}
+
+	}
+
+}
+
+//----------------------------------------Scatter---------------------------------------
+//
+// Writes the positions back to the players that were moved.
+//---------------------------------------------------------------------------------------
+void NonPenetrationSolver::Scatter() {
+
+	for (unsigned int p = 0; p < m_Players.size(); ++p) {
+
+		Vector2D pos(m_PosX[p], m_PosY[p]);
+
+		if (pos != m_Players[p]->Pos()) m_Players[p]->SetPos(pos);
+
+	}
+
+}
+
+//-----------------------------------------Solve----------------------------------------
+//---------------------------------------------------------------------------------------
+void NonPenetrationSolver::Solve() {
+
+	Gather();
+
+	if (m_Players.empty()) return;
+
+	BuildGrid();
+	FindPairs();
+	Relax();
+	Scatter();
+
+}
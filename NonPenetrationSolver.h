@@ -0,0 +1,97 @@
+#ifndef NONPENETRATIONSOLVER_H
+#define NONPENETRATIONSOLVER_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: NonPenetrationSolver.h
+//
+//  Desc: Keeps the players from overlapping each other. Once per tick,
+//        after every player has moved, the positions are copied into
+//        flat arrays, the overlapping pairs are found with a uniform grid
+//        and they are pushed apart over a few relaxation iterations.
+//        Each iteration works out every correction from the positions at
+//        the start of the iteration before applying any of them, so the
+//        result doesn't depend on the order the players are stored in.
+//        An iteration is two passes. The first works out the correction
+//        of each pair and the second sums the corrections of each player.
+//        Each pass only writes the slots of its own pairs or players, so
+//        either can be split into ranges that run on different workers.
+//
+//------------------------------------------------------------------------
+#include <vector>
+
+class PlayerBase;
+class SoccerPitch;
+
+class NonPenetrationSolver {
+
+private:
+	SoccerPitch* m_pPitch;
+
+	//The players in the order they were copied into the arrays below.
+	std::vector<PlayerBase*> m_Players;
+
+	//Positions and radii of the players.
+	std::vector<double> m_PosX;
+	std::vector<double> m_PosY;
+	std::vector<double> m_Radius;
+
+	//Corrections summed for each player during an iteration.
+	std::vector<double> m_MoveX;
+	std::vector<double> m_MoveY;
+
+	//The overlapping pairs found this tick, m_PairA[p] < m_PairB[p].
+	std::vector<int> m_PairA;
+	std::vector<int> m_PairB;
+
+	//How far player B of each pair is moved during an iteration. Player A is moved the other way.
+	std::vector<double> m_PairMoveX;
+	std::vector<double> m_PairMoveY;
+
+	//The pairs of player p are m_PlayerPairs[m_PlayerPairStart[p]] up to m_PlayerPairs[m_PlayerPairStart[p + 1]],
+	//in the order they were found.
+	std::vector<int> m_PlayerPairStart;
+	std::vector<int> m_PlayerPairs;
+
+	//The grid. The players of cell c are m_CellPlayers[m_CellStart[c]] up to m_CellPlayers[m_CellStart[c + 1]].
+	double m_dLeft;
+	double m_dTop;
+	double m_dCellSize;
+	int m_iCellsX;
+	int m_iCellsY;
+	std::vector<int> m_CellStart;
+	std::vector<int> m_CellPlayers;
+	std::vector<int> m_PlayerCell;
+
+	//Number of pairs found at the last call to Solve.
+	int m_iNumPairs;
+
+	int CellX(double x)const;
+	int CellY(double y)const;
+
+	void Gather();
+	void BuildGrid();
+	void FindPairs();
+	void ListPlayerPairs();
+	void Relax();
+	void Scatter();
+
+public:
+	NonPenetrationSolver(SoccerPitch* pitch);
+
+	//Separates all the overlapping players on the pitch.
+	void Solve();
+
+	int NumPairs()const { return m_iNumPairs; }
+
+	//The first pass of a relaxation iteration, for the pairs First up to Last. Each correction is calculated from
+	//PosX, PosY and written to PairMoveX[p], PairMoveY[p]. Each player of an overlapping pair is moved half the overlap.
+	static void RelaxPairs(const int* PairA, const int* PairB, int First, int Last, const double* PosX, const double* PosY, const double* Radius, double* PairMoveX, double* PairMoveY);
+
+	//The second pass of a relaxation iteration, for the players First up to Last. The corrections of the pairs
+	//of each player are summed into MoveX[p], MoveY[p].
+	static void SumMoves(const int* PairA, const int* PlayerPairStart, const int* PlayerPairs, int First, int Last, const double* PairMoveX, const double* PairMoveY, double* MoveX, double* MoveY);
+
+};
+
+#endif // NONPENETRATIONSOLVER_H
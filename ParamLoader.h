@@ -23,6 +23,9 @@ class ParamLoader : public iniFileLoaderBase {
 public:
 	static ParamLoader* Instance();
 
+	//Sets the file the parameters are read from instead of "Params.ini". It must be called before the first call to Instance.
+	static void SetFileName(const std::string& name) { FileName() = name; }
+
 	double GoalWidth;
 	
 	int NumSupportSpotsX;
@@ -72,9 +75,6 @@ public:
 	double MaxShootingForce;
 	double MaxPassingForce;
 
-	//Number of times the SoccerTeam::CanShoot method attempts to find a valid shot.
-	int NumAttempsToFindValidStrike;
-
 	//The distance away from the center of its home region a player must be to be considered at home.
 	double WithinRangeOfHome;
 
@@ -117,9 +117,118 @@ public:
 	//Zero this to turn the constraint off.
 	bool bNonPenetrationConstraint;
 
+	//When true, support spot scoring and pass searches use the per-team pass safety field.
+	bool bPassSafetyField;
+
+	//Number of cells of the pass safety field.
+	int PassSafetyCellsX;
+	int PassSafetyCellsY;
+
+	//Number of cells of the pitch control map.
+	int PitchControlCellsX;
+	int PitchControlCellsY;
+
+	//Number of ticks a player keeps moving with his current velocity before heading for a cell.
+	double PitchControlReactionTime;
+
+	//Score given to a support spot the team gets to before the opponents.
+	double Spot_PitchControlScore;
+
+	//When true, the pass search also tries passes played off the top and bottom walls.
+	bool bReboundPasses;
+
+	//When true, the ball is swept against the walls each update and can bounce several times per update.
+	//Otherwise the old one-bounce test against every wall is used.
+	bool bContinuousBallCollision;
+
+	//Number of relaxation iterations of the non-penetration solver.
+	int NonPenetrationIterations;
+
+	//File the team size, the player roles and the formations are loaded from.
+	std::string FormationFile;
+
+	//Number of columns and rows of the region grid the players position themselves on.
+	int NumRegionsHorizontal;
+	int NumRegionsVertical;
+
+	//Early termination rules of the batch runner. A match stops after this many updates,
+	//once this many goals have been scored or once a team leads by this many goals. Zero turns a rule off.
+	int MatchTickLimit;
+	int MatchGoalLimit;
+	int MatchGoalDifferenceLimit;
+
+	//A batch match in play this many updates without a touch of the ball is stopped as stalled. Zero turns the check off.
+	int MatchStallTickLimit;
+
+	//Set to update the players from a snapshot of the last tick so their moves don't depend on the order they are updated in.
+	bool bDoubleBufferedUpdate;
+
+	//Number of threads the players steer on during a buffered update.
+	int NumUpdateThreads;
+
+	//Set to run a buffered update as a graph of tasks, so work that doesn't depend on other work can run at the same time.
+	bool bTaskGraphUpdate;
+
+	//Set for the batch runner to play one match per SIMD lane on each worker, with the physics of the matches done together.
+	bool bMatchLanes;
+
+	//Set to work out the steering forces of all the players of a pitch together during a buffered update.
+	bool bBatchSteering;
+
+	//Set to move all the players of a pitch together during a buffered update.
+	bool bBatchMotion;
+
+	//Set for the players to be moved by the fast integration instead of the reference one. See PlayerMotion.
+	bool bFastMotion;
+
+	//Set for the match lanes to move the players in single precision, four matches to a group instead of two.
+	bool bFloatLanes;
+
+	//Set to use the portable math and random numbers of DetMath, so a seed plays the same match on any build.
+	bool bDeterministicMath;
+
+	//Set for the decision making to use the approximate math of FastMath. See FastMath.h.
+	bool bFastDecisionMath;
+
+	//Set for the field players to think less often the further they are from the ball. See ThinkTiers.
+	bool bThinkTiers;
+	double ThinkTierNearRange;
+	double ThinkTierNearRangeSq;
+	double ThinkTierFarRange;
+	double ThinkTierFarRangeSq;
+	int ThinkTierMidInterval;
+	int ThinkTierFarInterval;
+
+	//Set for the support spots to be rescored a few at a time at the end of each update instead of all at once.
+	//See TimeSliceScheduler for the budget.
+	bool bTimeSlicedSupportSpots;
+	double TimeSliceBudget;
+	double TimeSliceSimulatedStepCost;
+
+	//Number of times per second the teams and players make their decisions. The physics still run at FrameRate.
+	double DecisionRate;
+
+	//Set for the field players standing still with nobody moving near them to be put to sleep. Movement within
+	//SleepWakeRange or the ball within SleepBallRange wakes them. See SoccerPitch::UpdateSleep.
+	bool bPlayerSleep;
+	double SleepWakeRange;
+	double SleepWakeRangeSq;
+	double SleepBallRange;
+	double SleepBallRangeSq;
+
+	//Set for the support spots to be scored on a thread of their own from a snapshot of the pitch. Batch matches
+	//publish each scan AsyncSupportSpotSimulatedLatency ticks after it started. See SupportSpotCalculator.
+	bool bAsyncSupportSpots;
+	int AsyncSupportSpotSimulatedLatency;
+
 
 private:
-	ParamLoader() :iniFileLoaderBase("Params.ini") {
+	static std::string& FileName() {
+		static std::string name("Params.ini");
+		return name;
+	}
+
+	ParamLoader() :iniFileLoaderBase(FileName().c_str()) {
 
 		GoalWidth = GetNextParameterDouble();
 
@@ -147,6 +256,12 @@ private:
 		PlayerInTargetRange = GetNextParameterDouble();
 		PlayerInTargetRangeSq = PlayerInTargetRange * PlayerInTargetRange;
 
+		PlayerKickingDistance = GetNextParameterDouble();
+		PlayerKickingDistance += BallSize;
+		PlayerKickingDistanceSq = PlayerKickingDistance * PlayerKickingDistance;
+
+		PlayerKickingFrequency = GetNextParameterDouble();
+
 		PlayerMass = GetNextParameterDouble();
 
 		PlayerMaxForce = GetNextParameterDouble();
@@ -157,17 +272,12 @@ private:
 		PlayerScale = GetNextParameterDouble();
 		PlayerComfortZone = GetNextParameterDouble();
 		PlayerComfortZoneSq = PlayerComfortZone * PlayerComfortZone;
-		PlayerKickingDistance += BallSize;
-		PlayerKickingDistanceSq = PlayerKickingDistance * PlayerKickingDistance;
-		PlayerKickingFrequency = GetNextParameterDouble();
 		PlayerKickingAccuracy = GetNextParameterDouble();
 
 		MaxDribbleForce = GetNextParameterDouble();
 		MaxShootingForce = GetNextParameterDouble();
 		MaxPassingForce = GetNextParameterDouble();
 
-		NumAttempsToFindValidStrike = GetNextParameterInt();
-
 		WithinRangeOfHome = GetNextParameterDouble();
 
 		WithinRangeOfSupportSpot = GetNextParameterDouble();
@@ -200,6 +310,76 @@ private:
 
 		bNonPenetrationConstraint = GetNextParameterBool();
 
+		bPassSafetyField = GetNextParameterBool();
+
+		PassSafetyCellsX = GetNextParameterInt();
+		PassSafetyCellsY = GetNextParameterInt();
+
+		PitchControlCellsX = GetNextParameterInt();
+		PitchControlCellsY = GetNextParameterInt();
+
+		PitchControlReactionTime = GetNextParameterDouble();
+
+		Spot_PitchControlScore = GetNextParameterDouble();
+
+		bReboundPasses = GetNextParameterBool();
+
+		bContinuousBallCollision = GetNextParameterBool();
+
+		NonPenetrationIterations = GetNextParameterInt();
+
+		FormationFile = GetNextParameterString();
+
+		NumRegionsHorizontal = GetNextParameterInt();
+		NumRegionsVertical = GetNextParameterInt();
+
+		MatchTickLimit = GetNextParameterInt();
+		MatchGoalLimit = GetNextParameterInt();
+		MatchGoalDifferenceLimit = GetNextParameterInt();
+		MatchStallTickLimit = GetNextParameterInt();
+
+		bDoubleBufferedUpdate = GetNextParameterBool();
+
+		NumUpdateThreads = GetNextParameterInt();
+
+		bTaskGraphUpdate = GetNextParameterBool();
+
+		bMatchLanes = GetNextParameterBool();
+
+		bBatchSteering = GetNextParameterBool();
+
+		bBatchMotion = GetNextParameterBool();
+		bFastMotion = GetNextParameterBool();
+
+		bFloatLanes = GetNextParameterBool();
+
+		bDeterministicMath = GetNextParameterBool();
+
+		bFastDecisionMath = GetNextParameterBool();
+
+		bThinkTiers = GetNextParameterBool();
+		ThinkTierNearRange = GetNextParameterDouble();
+		ThinkTierNearRangeSq = ThinkTierNearRange * ThinkTierNearRange;
+		ThinkTierFarRange = GetNextParameterDouble();
+		ThinkTierFarRangeSq = ThinkTierFarRange * ThinkTierFarRange;
+		ThinkTierMidInterval = GetNextParameterInt();
+		ThinkTierFarInterval = GetNextParameterInt();
+
+		bTimeSlicedSupportSpots = GetNextParameterBool();
+		TimeSliceBudget = GetNextParameterDouble();
+		TimeSliceSimulatedStepCost = GetNextParameterDouble();
+
+		DecisionRate = GetNextParameterDouble();
+
+		bPlayerSleep = GetNextParameterBool();
+		SleepWakeRange = GetNextParameterDouble();
+		SleepWakeRangeSq = SleepWakeRange * SleepWakeRange;
+		SleepBallRange = GetNextParameterDouble();
+		SleepBallRangeSq = SleepBallRange * SleepBallRange;
+
+		bAsyncSupportSpots = GetNextParameterBool();
+		AsyncSupportSpotSimulatedLatency = GetNextParameterInt();
+
 	}
 
 };
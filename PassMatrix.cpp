@@ -0,0 +1,125 @@
+#include "misc/utils.h"
+
+#include "ParamLoader.h"
+#include "PassMatrix.h"
+#include "PlayerBase.h"
+#include "SoccerPitch.h"
+#include "SoccerTeam.h"
+
+PassMatrix::PassMatrix(SoccerTeam* team) :m_pTeam(team), m_iHits(0), m_iMisses(0) {
+
+	m_iNumPlayers = (int)team->Members().size();
+
+	m_SafePasses.resize(m_iNumPlayers * m_iNumPlayers);
+	m_BestPasses.resize(m_iNumPlayers);
+
+}
+
+//---------------------------------------IndexOf----------------------------------------
+//---------------------------------------------------------------------------------------
+int PassMatrix::IndexOf(const PlayerBase* const player)const {
+
+	const std::vector<PlayerBase*>& Members = m_pTeam->Members();
+
+	for (unsigned int i = 0; i < Members.size(); ++i) if (Members[i] == player) return i;
+
+	return -1;
+
+}
+
+int PassMatrix::CurrentTick()const {
+	return m_pTeam->Pitch()->TickCount();
+}
+
+//---------------------------------------IsFresh----------------------------------------
+//
+// An entry can be reused if it was calculated this tick with the same force.
+//---------------------------------------------------------------------------------------
+bool PassMatrix::IsFresh(const PassEntry& entry, double force)const {
+	return (entry.m_iTick == CurrentTick()) && isEqual(entry.m_dForce, force);
+}
+
+//--------------------------------------IsPassSafe--------------------------------------
+//---------------------------------------------------------------------------------------
+bool PassMatrix::IsPassSafe(const PlayerBase* const passer, const PlayerBase* const receiver, double PassingForce) {
+
+	int from = IndexOf(passer);
+	int to = IndexOf(receiver);
+
+	//Not a pair of team members so there is nothing to cache.
+	if ((from < 0) || (to < 0)) {
+
+		++m_iMisses;
+		return m_pTeam->IsPassSafeFromAllOpponents(passer->Pos(), receiver->Pos(), receiver, PassingForce);
+
+	}
+
+	PassEntry& entry = m_SafePasses[from * m_iNumPlayers + to];
+
+	if (IsFresh(entry, PassingForce)) {
+
+		++m_iHits;
+		return entry.m_bResult;
+
+	}
+
+	++m_iMisses;
+
+	entry.m_iTick = CurrentTick();
+	entry.m_dForce = PassingForce;
+	entry.m_bResult = m_pTeam->IsPassSafeFromAllOpponents(passer->Pos(), receiver->Pos(), receiver, PassingForce);
+
+	return entry.m_bResult;
+
+}
+
+//--------------------------------GetBestPassToReceiver---------------------------------
+//---------------------------------------------------------------------------------------
+bool PassMatrix::GetBestPassToReceiver(const PlayerBase* const receiver, Vector2D& PassTarget, double power, Vector2D* ReceiveTarget) {
+
+	int to = IndexOf(receiver);
+
+	if (to < 0) {
+
+		++m_iMisses;
+		return m_pTeam->CalculateBestPassToReceiver(receiver, PassTarget, power, ReceiveTarget);
+
+	}
+
+	PassEntry& entry = m_BestPasses[to];
+
+	if (!IsFresh(entry, power)) {
+
+		++m_iMisses;
+
+		entry.m_iTick = CurrentTick();
+		entry.m_dForce = power;
+		entry.m_bResult = m_pTeam->CalculateBestPassToReceiver(receiver, entry.m_vTarget, power, &entry.m_vReceiveTarget);
+
+	}
+
+	else ++m_iHits;
+
+	//PassTarget is only written when a pass was found, as the uncached version does.
+	if (entry.m_bResult) {
+
+		PassTarget = entry.m_vTarget;
+		if (ReceiveTarget) *ReceiveTarget = entry.m_vReceiveTarget;
+
+	}
+
+	return entry.m_bResult;
+
+}
+
+//---------------------------------------HitRate----------------------------------------
+//---------------------------------------------------------------------------------------
+double PassMatrix::HitRate()const {
+
+	int total = m_iHits + m_iMisses;
+
+	if (total == 0) return 0.0;
+
+	return (double)m_iHits / (double)total;
+
+}
@@ -0,0 +1,86 @@
+#ifndef PASSMATRIX_H
+#define PASSMATRIX_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: PassMatrix.h
+//
+//  Desc: Per-tick cache of pass feasibility for a team. It has one row per
+//        team member (passer -> teammate safety) plus a row for the ball
+//        (ball -> teammate best pass target). Entries are filled lazily the
+//        first time they are asked for during a tick and are answered from
+//        the matrix for the rest of that tick.
+//
+//------------------------------------------------------------------------
+#include <vector>
+
+#include "2D/Vector2D.h"
+
+class PlayerBase;
+class SoccerTeam;
+
+class PassMatrix {
+
+private:
+	//A data structure to hold a cached answer.
+	struct PassEntry {
+
+		//The tick the answer was calculated in. Answers from any other tick are stale.
+		int m_iTick;
+
+		//The force the pass was evaluated with.
+		double m_dForce;
+
+		bool m_bResult;
+
+		//Ball row only: the best target found for the receiver and where he collects the ball.
+		Vector2D m_vTarget;
+		Vector2D m_vReceiveTarget;
+
+		PassEntry():m_iTick(-1), m_dForce(0.0), m_bResult(false){}
+
+	};
+
+private:
+	SoccerTeam* m_pTeam;
+
+	//Number of team members the matrix was sized for.
+	int m_iNumPlayers;
+
+	//Passer -> receiver safety, indexed [passer * m_iNumPlayers + receiver].
+	std::vector<PassEntry> m_SafePasses;
+
+	//Ball -> receiver best pass, indexed by receiver.
+	std::vector<PassEntry> m_BestPasses;
+
+	//Number of queries answered from the matrix and number that had to be calculated.
+	int m_iHits;
+	int m_iMisses;
+
+	//Returns the index of the player in the team's member list, or -1 if it isn't a member.
+	int IndexOf(const PlayerBase* const player)const;
+
+	int CurrentTick()const;
+
+	bool IsFresh(const PassEntry& entry, double force)const;
+
+public:
+	PassMatrix(SoccerTeam* team);
+
+	//Cached version of SoccerTeam::IsPassSafeFromAllOpponents for a pass from the passer's position to the receiver's position.
+	bool IsPassSafe(const PlayerBase* const passer, const PlayerBase* const receiver, double PassingForce);
+
+	//Cached version of SoccerTeam::CalculateBestPassToReceiver.
+	bool GetBestPassToReceiver(const PlayerBase* const receiver, Vector2D& PassTarget, double power, Vector2D* ReceiveTarget = NULL);
+
+	int Hits()const { return m_iHits; }
+	int Misses()const { return m_iMisses; }
+
+	//Fraction of the queries answered from the matrix.
+	double HitRate()const;
+
+	void ResetStatistics() { m_iHits = 0; m_iMisses = 0; }
+
+};
+
+#endif // PASSMATRIX_H
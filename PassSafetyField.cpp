@@ -0,0 +1,421 @@
+#include "misc/Cgdi.h"
+#include "misc/simd.h"
+#include "misc/utils.h"
+
+#include "ParamLoader.h"
+#include "PassSafetyField.h"
+#include "PlayerBase.h"
+#include "SoccerBall.h"
+#include "SoccerPitch.h"
+#include "SoccerTeam.h"
+
+//Distance the ball or an opponent must move before the layers depending on it are recalculated.
+const double RebuildTolerance = 0.5;
+
+//Extra distance allowed for the float kernels and the approximate math mode before a cell is blocked.
+const double BlockedTolerance = 1.0;
+
+//Margin given to cells the ball can't reach.
+const float UnreachableMargin = -MaxFloat;
+
+PassSafetyField::PassSafetyField(SoccerTeam* team, int CellsX, int CellsY, double PassingForce) :m_pTeam(team), m_iCellsX(CellsX), m_iCellsY(CellsY), m_dPassingForce(PassingForce), m_iTick(-1), m_iLayersRebuilt(0), m_iLayersReused(0) {
+
+	assert((CellsX > 0) && (CellsY > 0));
+
+	const Region* PlayingField = team->Pitch()->PlayingArea();
+
+	m_dLeft = PlayingField->Left();
+	m_dTop = PlayingField->Top();
+	m_dCellWidth = PlayingField->Width() / (double)m_iCellsX;
+	m_dCellHeight = PlayingField->Height() / (double)m_iCellsY;
+	m_dCellRadius = 0.5 * sqrt(m_dCellWidth * m_dCellWidth + m_dCellHeight * m_dCellHeight);
+
+	m_iNumCells = m_iCellsX * m_iCellsY;
+	m_iNumCellsPadded = SimdPaddedSize(m_iNumCells);
+
+	//The padding cells repeat the last cell so the kernels never work on garbage.
+	m_CellX.resize(m_iNumCellsPadded);
+	m_CellY.resize(m_iNumCellsPadded);
+
+	for (int cell = 0; cell < m_iNumCellsPadded; ++cell) {
+
+		int idx = (cell < m_iNumCells) ? cell : m_iNumCells - 1;
+
+		m_CellX[cell] = (float)(m_dLeft + ((idx % m_iCellsX) + 0.5) * m_dCellWidth);
+		m_CellY[cell] = (float)(m_dTop + ((idx / m_iCellsX) + 0.5) * m_dCellHeight);
+
+	}
+
+	m_BallTime.resize(m_iNumCellsPadded);
+	m_Safe.resize(m_iNumCellsPadded);
+	m_Margin.resize(m_iNumCellsPadded);
+	m_Blocked.resize(m_iNumCellsPadded);
+
+}
+
+//--------------------------------------CellIndex---------------------------------------
+//
+// Returns the cell containing pos. Positions outside the playing area are clamped to the border cells.
+//---------------------------------------------------------------------------------------
+int PassSafetyField::CellIndex(Vector2D pos)const {
+
+	int col = (int)((pos.x - m_dLeft) / m_dCellWidth);
+	int row = (int)((pos.y - m_dTop) / m_dCellHeight);
+
+	if (col < 0) col = 0;
+	if (col > m_iCellsX - 1) col = m_iCellsX - 1;
+	if (row < 0) row = 0;
+	if (row > m_iCellsY - 1) row = m_iCellsY - 1;
+
+	return row * m_iCellsX + col;
+
+}
+
+//----------------------------------------Update----------------------------------------
+//
+// Recalculates the layers whose inputs moved since they were built and combines them.
+// If the ball moved every layer depends on it and the whole field is rebuilt.
+//---------------------------------------------------------------------------------------
+void PassSafetyField::Update() {
+
+	int tick = m_pTeam->Pitch()->TickCount();
+
+	if (tick == m_iTick) return;
+	m_iTick = tick;
+
+	const SoccerBall* ball = m_pTeam->Pitch()->Ball();
+	const std::vector<PlayerBase*>& Opponents = m_pTeam->Opponents()->Members();
+
+	bool bFullRebuild = (m_OppPos.size() != Opponents.size());
+
+	if (bFullRebuild) {
+
+		m_OppPos.assign(Opponents.size(), Vector2D());
+		m_OppSpeed.assign(Opponents.size(), 0.0);
+		m_OppSafe.resize(Opponents.size() * m_iNumCellsPadded);
+		m_OppMargin.resize(Opponents.size() * m_iNumCellsPadded);
+		m_OppBlocked.resize(Opponents.size() * m_iNumCellsPadded);
+
+	}
+
+	const double ToleranceSq = RebuildTolerance * RebuildTolerance;
+	const float speed = (float)(m_dPassingForce / ball->Mass());
+	const float friction = (float)Prm.Friction;
+
+	//A pass is kicked from the ball's current position, which may be off the one the field was built with.
+	const float TargetSlack = (float)(m_dCellRadius + RebuildTolerance);
+	const float OppSlack = (float)(2.0 * RebuildTolerance + BlockedTolerance);
+
+	bool bBallMoved = bFullRebuild || (Vec2DDistanceSq(ball->Pos(), m_vBallPos) > ToleranceSq);
+
+	if (bBallMoved) {
+
+		m_vBallPos = ball->Pos();
+		CalculateBallTimes(&m_CellX[0], &m_CellY[0], m_iNumCellsPadded, (float)m_vBallPos.x, (float)m_vBallPos.y, speed, friction, &m_BallTime[0]);
+
+	}
+
+	bool bChanged = bBallMoved;
+
+	for (unsigned int opp = 0; opp < Opponents.size(); ++opp) {
+
+		const PlayerBase* pOpp = Opponents[opp];
+
+		if (bBallMoved || (Vec2DDistanceSq(pOpp->Pos(), m_OppPos[opp]) > ToleranceSq) || (pOpp->MaxSpeed() != m_OppSpeed[opp])) {
+
+			m_OppPos[opp] = pOpp->Pos();
+			m_OppSpeed[opp] = pOpp->MaxSpeed();
+
+			CalculateOpponentLayer(&m_CellX[0], &m_CellY[0], &m_BallTime[0], m_iNumCellsPadded, (float)m_vBallPos.x, (float)m_vBallPos.y, speed, friction, (float)m_OppPos[opp].x, (float)m_OppPos[opp].y, (float)m_OppSpeed[opp], (float)(ball->BRadius() + pOpp->BRadius()), TargetSlack, OppSlack, &m_OppSafe[opp * m_iNumCellsPadded], &m_OppMargin[opp * m_iNumCellsPadded], &m_OppBlocked[opp * m_iNumCellsPadded]);
+
+			++m_iLayersRebuilt;
+			bChanged = true;
+
+		}
+
+		else ++m_iLayersReused;
+
+	}
+
+	if (!bChanged) return;
+
+	//Combine the layers. A cell is safe if the ball can reach it and every opponent layer says it is safe.
+	//It is blocked if any one opponent blocks all of it.
+	for (int cell = 0; cell < m_iNumCellsPadded; ++cell) {
+
+		m_Safe[cell] = (m_BallTime[cell] >= 0.0f) ? 1.0f : 0.0f;
+		m_Margin[cell] = (m_BallTime[cell] >= 0.0f) ? MaxFloat : UnreachableMargin;
+		m_Blocked[cell] = 0.0f;
+
+	}
+
+	for (unsigned int opp = 0; opp < Opponents.size(); ++opp) {
+
+		const float* safe = &m_OppSafe[opp * m_iNumCellsPadded];
+		const float* margin = &m_OppMargin[opp * m_iNumCellsPadded];
+		const float* blocked = &m_OppBlocked[opp * m_iNumCellsPadded];
+
+#ifdef SIMD_SSE2
+		for (int cell = 0; cell < m_iNumCellsPadded; cell += SimdFloatWidth) {
+
+			_mm_storeu_ps(&m_Safe[cell], _mm_min_ps(_mm_loadu_ps(&m_Safe[cell]), _mm_loadu_ps(safe + cell)));
+			_mm_storeu_ps(&m_Margin[cell], _mm_min_ps(_mm_loadu_ps(&m_Margin[cell]), _mm_loadu_ps(margin + cell)));
+			_mm_storeu_ps(&m_Blocked[cell], _mm_max_ps(_mm_loadu_ps(&m_Blocked[cell]), _mm_loadu_ps(blocked + cell)));
+
+		}
+#else
+		for (int cell = 0; cell < m_iNumCellsPadded; ++cell) {
+
+			m_Safe[cell] = MinOf(m_Safe[cell], safe[cell]);
+			m_Margin[cell] = MinOf(m_Margin[cell], margin[cell]);
+			m_Blocked[cell] = MaxOf(m_Blocked[cell], blocked[cell]);
+
+		}
+#endif
+
+	}
+
+}
+
+//----------------------------------------IsSafe----------------------------------------
+//---------------------------------------------------------------------------------------
+bool PassSafetyField::IsSafe(Vector2D pos) {
+
+	Update();
+
+	return m_Safe[CellIndex(pos)] > 0.5f;
+
+}
+
+//----------------------------------------Margin----------------------------------------
+//---------------------------------------------------------------------------------------
+double PassSafetyField::Margin(Vector2D pos) {
+
+	Update();
+
+	return m_Margin[CellIndex(pos)];
+
+}
+
+//---------------------------------------IsBlocked--------------------------------------
+//---------------------------------------------------------------------------------------
+bool PassSafetyField::IsBlocked(Vector2D pos) {
+
+	Update();
+
+	return m_Blocked[CellIndex(pos)] > 0.5f;
+
+}
+
+//----------------------------------CalculateBallTimes----------------------------------
+//
+// Same equations as SoccerBall::TimeToCoverDistance.
+//---------------------------------------------------------------------------------------
+void PassSafetyField::CalculateBallTimes(const float* CellX, const float* CellY, int NumCells, float bx, float by, float speed, float friction, float* BallTime) {
+
+	const float SpeedSq = speed * speed;
+
+#ifdef SIMD_SSE2
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 MinusOne = _mm_set1_ps(-1.0f);
+	const __m128 vbx = _mm_set1_ps(bx);
+	const __m128 vby = _mm_set1_ps(by);
+	const __m128 vSpeed = _mm_set1_ps(speed);
+	const __m128 vSpeedSq = _mm_set1_ps(SpeedSq);
+	const __m128 vTwoFriction = _mm_set1_ps(2.0f * friction);
+	const __m128 vFriction = _mm_set1_ps(friction);
+
+	for (int i = 0; i < NumCells; i += SimdFloatWidth) {
+
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(CellX + i), vbx);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(CellY + i), vby);
+		__m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+		__m128 term = _mm_add_ps(vSpeedSq, _mm_mul_ps(vTwoFriction, dist));
+		__m128 reachable = _mm_cmpgt_ps(term, zero);
+		__m128 time = _mm_div_ps(_mm_sub_ps(_mm_sqrt_ps(_mm_max_ps(term, zero)), vSpeed), vFriction);
+
+		_mm_storeu_ps(BallTime + i, _mm_or_ps(_mm_and_ps(reachable, time), _mm_andnot_ps(reachable, MinusOne)));
+
+	}
+#else
+	for (int i = 0; i < NumCells; ++i) {
+
+		float dx = CellX[i] - bx;
+		float dy = CellY[i] - by;
+		float term = SpeedSq + 2.0f * friction * sqrtf(dx * dx + dy * dy);
+
+		BallTime[i] = (term > 0.0f) ? (sqrtf(term) - speed) / friction : -1.0f;
+
+	}
+#endif
+
+}
+
+//--------------------------------CalculateOpponentLayer--------------------------------
+//
+// Each cell center is treated as a pass target. The opponent is moved into the local space
+// of the pass and the pass is safe if the opponent is behind the kicker, is further from the
+// kicker than the target, or can't run to the line of the pass before the ball gets there.
+// The margin is the distance the opponent is left short of the cell when the ball arrives.
+//
+// Moving the target by up to TargetSlack turns the pass by at most 2 * TargetSlack / dist radians,
+// so along with the opponent moving by up to OppSlack, the opponent's local coordinates change by
+// at most 'spread'. The cell is blocked if the test still fails with the opponent that much closer
+// to the kicker and that much further from the line of the pass.
+//---------------------------------------------------------------------------------------
+void PassSafetyField::CalculateOpponentLayer(const float* CellX, const float* CellY, const float* BallTime, int NumCells, float bx, float by, float speed, float friction, float ox, float oy, float OppSpeed, float radii, float TargetSlack, float OppSlack, float* safe, float* margin, float* blocked) {
+
+	//Opponent position relative to the kicker.
+	const float rx = ox - bx;
+	const float ry = oy - by;
+	const float OppDistSq = rx * rx + ry * ry;
+	const float OppDist = sqrtf(OppDistSq);
+	const float SpeedSq = speed * speed;
+
+#ifdef SIMD_SSE2
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 MinusOne = _mm_set1_ps(-1.0f);
+	const __m128 SignBit = _mm_set1_ps(-0.0f);
+	const __m128 vbx = _mm_set1_ps(bx);
+	const __m128 vby = _mm_set1_ps(by);
+	const __m128 vox = _mm_set1_ps(ox);
+	const __m128 voy = _mm_set1_ps(oy);
+	const __m128 vrx = _mm_set1_ps(rx);
+	const __m128 vry = _mm_set1_ps(ry);
+	const __m128 vOppDistSq = _mm_set1_ps(OppDistSq);
+	const __m128 vSpeed = _mm_set1_ps(speed);
+	const __m128 vSpeedSq = _mm_set1_ps(SpeedSq);
+	const __m128 vTwoFriction = _mm_set1_ps(2.0f * friction);
+	const __m128 vFriction = _mm_set1_ps(friction);
+	const __m128 vOppSpeed = _mm_set1_ps(OppSpeed);
+	const __m128 vRadii = _mm_set1_ps(radii);
+	const __m128 vUnreachable = _mm_set1_ps(UnreachableMargin);
+	const __m128 vTargetSlack = _mm_set1_ps(TargetSlack);
+	const __m128 vOppSlack = _mm_set1_ps(OppSlack);
+	const __m128 vOppDist = _mm_set1_ps(OppDist);
+	const __m128 vTurn = _mm_set1_ps(2.0f * TargetSlack * OppDist);
+
+	for (int i = 0; i < NumCells; i += SimdFloatWidth) {
+
+		__m128 cx = _mm_loadu_ps(CellX + i);
+		__m128 cy = _mm_loadu_ps(CellY + i);
+
+		__m128 dx = _mm_sub_ps(cx, vbx);
+		__m128 dy = _mm_sub_ps(cy, vby);
+		__m128 DistSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+		__m128 dist = _mm_sqrt_ps(DistSq);
+		__m128 InvDist = _mm_and_ps(_mm_cmpgt_ps(dist, zero), _mm_div_ps(one, dist));
+
+		//Opponent in the local space of the pass.
+		__m128 LocalX = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(vrx, dx), _mm_mul_ps(vry, dy)), InvDist);
+		__m128 LocalY = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(vry, dx), _mm_mul_ps(vrx, dy)), InvDist);
+
+		__m128 clear = _mm_or_ps(_mm_cmplt_ps(LocalX, zero), _mm_cmplt_ps(DistSq, vOppDistSq));
+
+		//Time for the ball to draw level with the opponent.
+		__m128 term = _mm_add_ps(vSpeedSq, _mm_mul_ps(vTwoFriction, LocalX));
+		__m128 reachable = _mm_cmpgt_ps(term, zero);
+		__m128 time = _mm_div_ps(_mm_sub_ps(_mm_sqrt_ps(_mm_max_ps(term, zero)), vSpeed), vFriction);
+		time = _mm_or_ps(_mm_and_ps(reachable, time), _mm_andnot_ps(reachable, MinusOne));
+
+		__m128 reach = _mm_add_ps(_mm_mul_ps(vOppSpeed, time), vRadii);
+		clear = _mm_or_ps(clear, _mm_cmpge_ps(_mm_andnot_ps(SignBit, LocalY), reach));
+
+		_mm_storeu_ps(safe + i, _mm_and_ps(clear, one));
+
+		//Margin.
+		__m128 ex = _mm_sub_ps(cx, vox);
+		__m128 ey = _mm_sub_ps(cy, voy);
+		__m128 OppToCell = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)));
+		__m128 bt = _mm_loadu_ps(BallTime + i);
+		__m128 m = _mm_sub_ps(_mm_sub_ps(OppToCell, _mm_mul_ps(vOppSpeed, bt)), vRadii);
+		__m128 BallArrives = _mm_cmpge_ps(bt, zero);
+
+		_mm_storeu_ps(margin + i, _mm_or_ps(_mm_and_ps(BallArrives, m), _mm_andnot_ps(BallArrives, vUnreachable)));
+
+		//Blocked.
+		__m128 spread = _mm_add_ps(vOppSlack, _mm_mul_ps(vTurn, InvDist));
+		__m128 NearX = _mm_sub_ps(LocalX, spread);
+		__m128 FarX = _mm_add_ps(LocalX, spread);
+
+		__m128 block = _mm_cmpge_ps(_mm_sub_ps(dist, vTargetSlack), _mm_add_ps(vOppDist, vOppSlack));
+		block = _mm_and_ps(block, _mm_cmpge_ps(NearX, zero));
+		block = _mm_and_ps(block, _mm_cmpgt_ps(_mm_add_ps(vSpeedSq, _mm_mul_ps(vTwoFriction, FarX)), zero));
+
+		__m128 NearTerm = _mm_add_ps(vSpeedSq, _mm_mul_ps(vTwoFriction, NearX));
+		__m128 NearTime = _mm_div_ps(_mm_sub_ps(_mm_sqrt_ps(_mm_max_ps(NearTerm, zero)), vSpeed), vFriction);
+		__m128 NearReach = _mm_add_ps(_mm_mul_ps(vOppSpeed, NearTime), vRadii);
+		block = _mm_and_ps(block, _mm_cmplt_ps(_mm_add_ps(_mm_andnot_ps(SignBit, LocalY), spread), NearReach));
+
+		_mm_storeu_ps(blocked + i, _mm_and_ps(block, one));
+
+	}
+#else
+	for (int i = 0; i < NumCells; ++i) {
+
+		float dx = CellX[i] - bx;
+		float dy = CellY[i] - by;
+		float DistSq = dx * dx + dy * dy;
+		float dist = sqrtf(DistSq);
+		float InvDist = (dist > 0.0f) ? 1.0f / dist : 0.0f;
+
+		float LocalX = (rx * dx + ry * dy) * InvDist;
+		float LocalY = (ry * dx - rx * dy) * InvDist;
+
+		bool clear = (LocalX < 0.0f) || (DistSq < OppDistSq);
+
+		if (!clear) {
+
+			float term = SpeedSq + 2.0f * friction * LocalX;
+			float time = (term > 0.0f) ? (sqrtf(term) - speed) / friction : -1.0f;
+
+			clear = fabsf(LocalY) >= OppSpeed * time + radii;
+
+		}
+
+		safe[i] = clear ? 1.0f : 0.0f;
+
+		float ex = CellX[i] - ox;
+		float ey = CellY[i] - oy;
+
+		margin[i] = (BallTime[i] >= 0.0f) ? sqrtf(ex * ex + ey * ey) - OppSpeed * BallTime[i] - radii : UnreachableMargin;
+
+		float spread = OppSlack + 2.0f * TargetSlack * OppDist * InvDist;
+		float NearX = LocalX - spread;
+		float FarX = LocalX + spread;
+
+		bool block = (dist - TargetSlack >= OppDist + OppSlack) && (NearX >= 0.0f) && (SpeedSq + 2.0f * friction * FarX > 0.0f);
+
+		if (block) {
+
+			float NearTime = (sqrtf(SpeedSq + 2.0f * friction * NearX) - speed) / friction;
+
+			block = fabsf(LocalY) + spread < OppSpeed * NearTime + radii;
+
+		}
+
+		blocked[i] = block ? 1.0f : 0.0f;
+
+	}
+#endif
+
+}
+
+//----------------------------------------Render----------------------------------------
+//
+// Marks the safe cells with a small green circle.
+//---------------------------------------------------------------------------------------
+void PassSafetyField::Render()const {
+
+	gdi->HollowBrush();
+	gdi->GreenPen();
+
+	for (int cell = 0; cell < m_iNumCells; ++cell) {
+
+		if (m_Safe[cell] > 0.5f) gdi->Circle(Vector2D(m_CellX[cell], m_CellY[cell]), 1.0);
+
+	}
+
+}
@@ -0,0 +1,117 @@
+#ifndef PASSSAFETYFIELD_H
+#define PASSSAFETYFIELD_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: PassSafetyField.h
+//
+//  Desc: Grid over the playing area holding, for each cell, whether a pass
+//        kicked from the ball's position can reach the cell center without
+//        being intercepted by an opponent, and by how far the ball beats the
+//        nearest opponent to it. A second layer marks the cells where one
+//        opponent can intercept a pass to any point of the cell, which the
+//        pass search can reject without the exact test.
+//        The field is rebuilt lazily once per tick. When the ball has not
+//        moved only the layers of the opponents that moved are recalculated.
+//
+//------------------------------------------------------------------------
+#include <vector>
+
+#include "2D/Vector2D.h"
+
+class SoccerTeam;
+
+class PassSafetyField {
+
+private:
+	SoccerTeam* m_pTeam;
+
+	int m_iCellsX;
+	int m_iCellsY;
+
+	//Number of cells, and the same rounded up to a multiple of the SIMD width.
+	int m_iNumCells;
+	int m_iNumCellsPadded;
+
+	double m_dLeft;
+	double m_dTop;
+	double m_dCellWidth;
+	double m_dCellHeight;
+
+	//The force the passes are evaluated with.
+	double m_dPassingForce;
+
+	//Cell centers.
+	std::vector<float> m_CellX;
+	std::vector<float> m_CellY;
+
+	//Time the ball takes to reach each cell center, or a negative value if it can't reach it.
+	std::vector<float> m_BallTime;
+
+	//One layer per opponent, indexed [opp * m_iNumCellsPadded + cell].
+	//Safe holds 1.0 if the pass is safe from that opponent and 0.0 if not.
+	std::vector<float> m_OppSafe;
+	std::vector<float> m_OppMargin;
+	std::vector<float> m_OppBlocked;
+
+	//The layers combined over all the opponents.
+	std::vector<float> m_Safe;
+	std::vector<float> m_Margin;
+	std::vector<float> m_Blocked;
+
+	//Distance from a cell center to its corners.
+	double m_dCellRadius;
+
+	//Positions and speeds the field was last built with.
+	Vector2D m_vBallPos;
+	std::vector<Vector2D> m_OppPos;
+	std::vector<double> m_OppSpeed;
+
+	//The tick the field was last brought up to date.
+	int m_iTick;
+
+	//Number of opponent layers recalculated and number of layers that could be kept.
+	int m_iLayersRebuilt;
+	int m_iLayersReused;
+
+	//Brings the field up to date if it hasn't been already this tick.
+	void Update();
+
+	int CellIndex(Vector2D pos)const;
+
+public:
+	PassSafetyField(SoccerTeam* team, int CellsX, int CellsY, double PassingForce);
+
+	//Returns true if a pass from the ball's position to pos can't be intercepted.
+	bool IsSafe(Vector2D pos);
+
+	//Distance by which the nearest opponent fails to reach pos before the ball does.
+	//Negative if an opponent can get there first.
+	double Margin(Vector2D pos);
+
+	//Returns true if an opponent can intercept a pass to every point of the cell containing pos,
+	//allowing for the ball and the opponents having moved a little since the field was built.
+	bool IsBlocked(Vector2D pos);
+
+	//Brings the field up to date now rather than the first time it is asked something this tick.
+	void Refresh() { Update(); }
+
+	void Render()const;
+
+	int LayersRebuilt()const { return m_iLayersRebuilt; }
+	int LayersReused()const { return m_iLayersReused; }
+
+	//Calculates the time the ball, kicked from (bx, by) with speed 'speed', takes to reach each cell.
+	//Cells it can't reach get -1. 'friction' is the (negative) deceleration of the ball.
+	static void CalculateBallTimes(const float* CellX, const float* CellY, int NumCells, float bx, float by, float speed, float friction, float* BallTime);
+
+	//Calculates the layer of a single opponent at (ox, oy) running at 'OppSpeed'. 'radii' is the sum of
+	//the ball and opponent bounding radii. Applies the same test as SoccerTeam::IsPassSafeFromOpponent
+	//with no receiver, for every cell at once. NumCells must be a multiple of the SIMD width.
+	//A cell is blocked if the test fails for every target within TargetSlack of its center, with the
+	//opponent anywhere within OppSlack of (ox, oy) relative to the kicker.
+	static void CalculateOpponentLayer(const float* CellX, const float* CellY, const float* BallTime, int NumCells, float bx, float by, float speed, float friction, float ox, float oy, float OppSpeed, float radii, float TargetSlack, float OppSlack, float* safe, float* margin, float* blocked);
+
+};
+
+#endif // PASSSAFETYFIELD_H
@@ -0,0 +1,307 @@
+#include <algorithm>
+
+#include "2D/BatchGeometry.h"
+#include "2D/geometry.h"
+#include "misc/FastMath.h"
+#include "misc/utils.h"
+
+#include "Goal.h"
+#include "ParamLoader.h"
+#include "PassSafetyField.h"
+#include "PassSearch.h"
+#include "PlayerBase.h"
+#include "ShotSolver.h"
+#include "SoccerBall.h"
+#include "SoccerPitch.h"
+#include "SoccerTeam.h"
+
+//Fractions of the receiver's intercept range the tangent passes are tried at.
+const int NumTangentScales = 3;
+const double TangentScales[NumTangentScales] = { 0.3, 0.6, 0.9 };
+
+//Fractions of the receiver's intercept range through balls are played ahead of him.
+const int NumThroughScales = 2;
+const double ThroughScales[NumThroughScales] = { 0.5, 0.9 };
+
+PassSearch::PassSearch(SoccerTeam* team) :m_pTeam(team), m_iCandidatesGenerated(0), m_iCandidatesPruned(0), m_iFullTests(0) {}
+
+//-------------------------------------AddCandidate-------------------------------------
+//---------------------------------------------------------------------------------------
+void PassSearch::AddCandidate(std::vector<PassCandidate>& candidates, PassCandidate::pass_type type, Vector2D KickTarget, Vector2D ReceiveTarget) {
+
+	double score = -fabs(ReceiveTarget.x - m_pTeam->OpponentsGoal()->Center().x);
+
+	candidates.push_back(PassCandidate(type, KickTarget, ReceiveTarget, score));
+
+}
+
+//----------------------------------GenerateCandidates----------------------------------
+//---------------------------------------------------------------------------------------
+const std::vector<PassCandidate>& PassSearch::GenerateCandidates(const PlayerBase* const receiver, double power) {
+
+	const SoccerBall* ball = m_pTeam->Pitch()->Ball();
+	Vector2D BallPos = ball->Pos();
+	Vector2D ReceiverPos = receiver->Pos();
+
+	CandidateList& list = m_Lists[receiver];
+	std::vector<PassCandidate>& candidates = list.m_Candidates;
+
+	//The candidates generated last time are still the same if nothing they are worked out from has changed.
+	bool changed = (list.m_vBallPos != BallPos) || (list.m_vReceiverPos != ReceiverPos) || (list.m_vReceiverVelocity != receiver->Velocity()) || (list.m_dReceiverMaxSpeed != receiver->MaxSpeed()) || (list.m_dPower != power);
+
+	if (!changed) return candidates;
+
+	list.m_vBallPos = BallPos;
+	list.m_vReceiverPos = ReceiverPos;
+	list.m_vReceiverVelocity = receiver->Velocity();
+	list.m_dReceiverMaxSpeed = receiver->MaxSpeed();
+	list.m_dPower = power;
+
+	candidates.clear();
+
+	//First calculate how much time it will take for the ball to reach this receiver, if the receiver was to remain motionless.
+	double time = ball->TimeToCoverDistance(BallPos, ReceiverPos, power);
+
+	//No pass can be made if the ball can't even reach the receiver.
+	if (time < 0) return candidates;
+
+	//The maximum distance the receiver can cover in this time.
+	double InterceptRange = time * receiver->MaxSpeed();
+
+	//Straight to the receiver.
+	AddCandidate(candidates, PassCandidate::direct, ReceiverPos, ReceiverPos);
+
+	//The tangents from the ball to circles around the receiver, all worked out at once.
+	double CircleX[NumTangentScales], CircleY[NumTangentScales], radius[NumTangentScales];
+	double ip1X[NumTangentScales], ip1Y[NumTangentScales], ip2X[NumTangentScales], ip2Y[NumTangentScales];
+	int HasTangents[NumTangentScales];
+
+	for (int s = 0; s < NumTangentScales; ++s) {
+
+		CircleX[s] = ReceiverPos.x;
+		CircleY[s] = ReceiverPos.y;
+		radius[s] = InterceptRange * TangentScales[s];
+
+		ip1X[s] = ip1Y[s] = ip2X[s] = ip2Y[s] = 0.0;
+
+	}
+
+	CirclesTangentPoints(CircleX, CircleY, radius, NumTangentScales, BallPos, ip1X, ip1Y, ip2X, ip2Y, HasTangents);
+
+	for (int s = 0; s < NumTangentScales; ++s) {
+
+		if (HasTangents[s]) {
+
+			Vector2D ip1(ip1X[s], ip1Y[s]);
+			Vector2D ip2(ip2X[s], ip2Y[s]);
+
+			AddCandidate(candidates, PassCandidate::tangent, ip1, ip1);
+			AddCandidate(candidates, PassCandidate::tangent, ip2, ip2);
+
+		}
+
+	}
+
+	//Where the receiver will be if he carries on as he is.
+	if (!receiver->Velocity().isZero()) {
+
+		Vector2D LeadPos = ReceiverPos + receiver->Velocity() * time;
+		AddCandidate(candidates, PassCandidate::lead, LeadPos, LeadPos);
+
+	}
+
+	//Through balls, into the space ahead of the receiver.
+	Vector2D upfield = -1.0 * m_pTeam->OpponentsGoal()->Facing();
+	Vector2D diagonals[3] = { upfield, Vec2DNormalize(upfield + upfield.Perp()), Vec2DNormalize(upfield - upfield.Perp()) };
+
+	for (int d = 0; d < 3; ++d) {
+
+		for (int s = 0; s < NumThroughScales; ++s) {
+
+			Vector2D ThroughPos = ReceiverPos + diagonals[d] * InterceptRange * ThroughScales[s];
+			AddCandidate(candidates, PassCandidate::through, ThroughPos, ThroughPos);
+
+		}
+
+	}
+
+	//Passes played off the top and bottom walls. The receiver is mirrored in the line the ball's center follows
+	//when it touches the wall, and the ball is kicked at the point where the line to the mirror image crosses it.
+	if (Prm.bReboundPasses) {
+
+		const Region* area = m_pTeam->Pitch()->PlayingArea();
+		double WallLines[2] = { area->Top() + ball->BRadius(), area->Bottom() - ball->BRadius() };
+
+		for (int w = 0; w < 2; ++w) {
+
+			Vector2D mirror(ReceiverPos.x, 2.0 * WallLines[w] - ReceiverPos.y);
+
+			double dy = mirror.y - BallPos.y;
+			if (fabs(dy) < 1e-9) continue;
+
+			double t = (WallLines[w] - BallPos.y) / dy;
+			if ((t <= 0.0) || (t >= 1.0)) continue;
+
+			AddCandidate(candidates, PassCandidate::rebound, BallPos + (mirror - BallPos) * t, ReceiverPos);
+
+		}
+
+	}
+
+	m_iCandidatesGenerated += candidates.size();
+
+	std::stable_sort(candidates.begin(), candidates.end());
+
+	return candidates;
+
+}
+
+//---------------------------------------IsLegSafe--------------------------------------
+//
+// An opponent further from the leg than he can run while the ball travels it can't
+// intercept it, so only opponents inside the leg's bounding box grown by that distance
+// get the full test. When there is a receiver the opponent must also be further from the
+// target than the receiver, or the full test could still reject the pass. The bounding
+// test is done for all the opponents at once with PointsNearRect.
+//---------------------------------------------------------------------------------------
+bool PassSearch::IsLegSafe(Vector2D from, Vector2D to, const PlayerBase* const receiver, double force) {
+
+	const SoccerBall* ball = m_pTeam->Pitch()->Ball();
+
+	double LegTime = ball->TimeToCoverDistance(from, to, force);
+
+	double left = MinOf(from.x, to.x);
+	double right = MaxOf(from.x, to.x);
+	double top = MinOf(from.y, to.y);
+	double bottom = MaxOf(from.y, to.y);
+
+	double ReceiverDistSq = receiver ? Vec2DDistanceSq(receiver->Pos(), to) : 0.0;
+
+	const std::vector<PlayerBase*>& opponents = m_pTeam->Opponents()->Members();
+
+	int NumOpponents = (int)opponents.size();
+
+	m_OppX.resize(NumOpponents);
+	m_OppY.resize(NumOpponents);
+	m_OppReach.resize(NumOpponents);
+	m_OppNear.resize(NumOpponents);
+
+	for (int o = 0; o < NumOpponents; ++o) {
+
+		m_OppX[o] = opponents[o]->Pos().x;
+		m_OppY[o] = opponents[o]->Pos().y;
+		m_OppReach[o] = opponents[o]->MaxSpeed() * MaxOf(LegTime, 0.0) + ball->BRadius() + opponents[o]->BRadius();
+
+	}
+
+	if (NumOpponents > 0) PointsNearRect(&m_OppX[0], &m_OppY[0], &m_OppReach[0], NumOpponents, left, top, right, bottom, &m_OppNear[0]);
+
+	for (int o = 0; o < NumOpponents; ++o) {
+
+		if (!m_OppNear[o] && (!receiver || (Vec2DDistanceSq(opponents[o]->Pos(), to) > ReceiverDistSq))) continue;
+
+		if (!m_pTeam->IsPassSafeFromOpponent(from, to, receiver, opponents[o], force)) return false;
+
+	}
+
+	return true;
+
+}
+
+//-----------------------------------IsCandidateValid-----------------------------------
+//---------------------------------------------------------------------------------------
+bool PassSearch::IsCandidateValid(const PassCandidate& candidate, const PlayerBase* const receiver, double power) {
+
+	const SoccerBall* ball = m_pTeam->Pitch()->Ball();
+	Vector2D BallPos = ball->Pos();
+
+	//The receiver must collect the ball inside the playing area.
+	if (!m_pTeam->Pitch()->PlayingArea()->Inside(candidate.m_vReceiveTarget)) {
+
+		++m_iCandidatesPruned;
+		return false;
+
+	}
+
+	//The ball must get there.
+	double speed = power / ball->Mass();
+	double FirstLeg = FastMath::Distance(BallPos, candidate.m_vKickTarget);
+	double PathLength = FirstLeg;
+
+	if (candidate.m_Type == PassCandidate::rebound) PathLength += FastMath::Distance(candidate.m_vKickTarget, candidate.m_vReceiveTarget);
+
+	double BallTime = BallTimeToCover(PathLength, speed, Prm.Friction);
+
+	if (BallTime < 0) {
+
+		++m_iCandidatesPruned;
+		return false;
+
+	}
+
+	//The receiver must be able to get there before the ball stops being his.
+	if ((candidate.m_Type != PassCandidate::direct) && (FastMath::Distance(receiver->Pos(), candidate.m_vReceiveTarget) > receiver->MaxSpeed() * BallTime)) {
+
+		++m_iCandidatesPruned;
+		return false;
+
+	}
+
+	//The pass safety field throws away the targets in cells an opponent intercepts every pass to.
+	//Anywhere else the exact test below decides.
+	if (Prm.bPassSafetyField && (power == Prm.MaxPassingForce) && (candidate.m_Type != PassCandidate::rebound) && m_pTeam->PassSafety()->IsBlocked(candidate.m_vReceiveTarget)) {
+
+		++m_iCandidatesPruned;
+		return false;
+
+	}
+
+	++m_iFullTests;
+
+	if (candidate.m_Type == PassCandidate::rebound) {
+
+		//Both legs must be safe. The second leg starts at the speed the ball has left when it hits the wall.
+		double SpeedAtWall = FastMath::Sqrt(MaxOf(speed * speed + 2.0 * FirstLeg * Prm.Friction, 0.0));
+
+		return IsLegSafe(BallPos, candidate.m_vKickTarget, NULL, power) && IsLegSafe(candidate.m_vKickTarget, candidate.m_vReceiveTarget, receiver, SpeedAtWall * ball->Mass());
+
+	}
+
+	return IsLegSafe(BallPos, candidate.m_vKickTarget, receiver, power);
+
+}
+
+//-------------------------------------FindBestPass-------------------------------------
+//---------------------------------------------------------------------------------------
+bool PassSearch::FindBestPass(const PlayerBase* const receiver, double power, Vector2D& KickTarget, Vector2D& ReceiveTarget) {
+
+	const std::vector<PassCandidate>& candidates = GenerateCandidates(receiver, power);
+
+	//The candidates are sorted best first so the first valid one is the best.
+	for (unsigned int c = 0; c < candidates.size(); ++c) {
+
+		if (IsCandidateValid(candidates[c], receiver, power)) {
+
+			KickTarget = candidates[c].m_vKickTarget;
+			ReceiveTarget = candidates[c].m_vReceiveTarget;
+			return true;
+
+		}
+
+	}
+
+	return false;
+
+}
+
+//--------------------------------------UpperBound--------------------------------------
+//---------------------------------------------------------------------------------------
+double PassSearch::UpperBound(const PlayerBase* const receiver, double power) {
+
+	const std::vector<PassCandidate>& candidates = GenerateCandidates(receiver, power);
+
+	if (candidates.empty()) return -MaxDouble;
+
+	return candidates[0].m_dScore;
+
+}
@@ -0,0 +1,109 @@
+#ifndef PASSSEARCH_H
+#define PASSSEARCH_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: PassSearch.h
+//
+//  Desc: Branch-and-bound search for the best pass to a receiver.
+//        Many candidate passes are generated per receiver (direct, tangents
+//        at several ranges, lead passes, through balls and passes played off
+//        the side walls). The score of a candidate only depends on where the
+//        receiver collects the ball, so candidates are sorted by score and
+//        tested with the cheap tests first. The first candidate passing every
+//        test is the best one and the search stops there. The candidates
+//        of each receiver are kept until the ball or the receiver moves, so
+//        bounding the receivers and then searching them builds them once.
+//
+//------------------------------------------------------------------------
+#include <map>
+#include <vector>
+
+#include "2D/Vector2D.h"
+
+class PlayerBase;
+class SoccerTeam;
+
+struct PassCandidate {
+
+	enum pass_type{direct, tangent, lead, through, rebound};
+
+	pass_type m_Type;
+
+	//Where the ball is kicked towards. For a rebound this is the point on the wall.
+	Vector2D m_vKickTarget;
+
+	//Where the receiver collects the ball.
+	Vector2D m_vReceiveTarget;
+
+	//Higher is better. The closer the receive target is to the opponent's goal line the higher the score.
+	double m_dScore;
+
+	PassCandidate(pass_type type, Vector2D KickTarget, Vector2D ReceiveTarget, double score):m_Type(type), m_vKickTarget(KickTarget), m_vReceiveTarget(ReceiveTarget), m_dScore(score){}
+
+	bool operator<(const PassCandidate& rhs)const { return m_dScore > rhs.m_dScore; }
+
+};
+
+class PassSearch {
+
+private:
+	SoccerTeam* m_pTeam;
+
+	//The candidates last generated for a receiver and what they were generated from.
+	struct CandidateList {
+
+		Vector2D m_vBallPos;
+		Vector2D m_vReceiverPos;
+		Vector2D m_vReceiverVelocity;
+		double m_dReceiverMaxSpeed;
+		double m_dPower;
+
+		std::vector<PassCandidate> m_Candidates;
+
+		CandidateList():m_dReceiverMaxSpeed(-1.0), m_dPower(-1.0){}
+
+	};
+
+	std::map<const PlayerBase*, CandidateList> m_Lists;
+
+	//The opponents' positions and reaches for the bounding test of IsLegSafe, and its results.
+	std::vector<double> m_OppX;
+	std::vector<double> m_OppY;
+	std::vector<double> m_OppReach;
+	std::vector<int> m_OppNear;
+
+	//Statistics
+	int m_iCandidatesGenerated;
+	int m_iCandidatesPruned;
+	int m_iFullTests;
+
+	//Returns the passes to the receiver, sorted best first. They are only generated again if the ball or
+	//the receiver has moved since the last time, or the power is different.
+	const std::vector<PassCandidate>& GenerateCandidates(const PlayerBase* const receiver, double power);
+
+	void AddCandidate(std::vector<PassCandidate>& candidates, PassCandidate::pass_type type, Vector2D KickTarget, Vector2D ReceiveTarget);
+
+	//Interception test for one leg of a pass. Opponents too far from the leg to reach it in time are skipped
+	//before running SoccerTeam::IsPassSafeFromOpponent.
+	bool IsLegSafe(Vector2D from, Vector2D to, const PlayerBase* const receiver, double force);
+
+	//Runs the tests on a candidate, cheapest first.
+	bool IsCandidateValid(const PassCandidate& candidate, const PlayerBase* const receiver, double power);
+
+public:
+	PassSearch(SoccerTeam* team);
+
+	//Finds the best pass to the receiver that can't be intercepted. Returns false if there isn't one.
+	bool FindBestPass(const PlayerBase* const receiver, double power, Vector2D& KickTarget, Vector2D& ReceiveTarget);
+
+	//The best score any pass to the receiver could have, before testing whether the passes are possible.
+	double UpperBound(const PlayerBase* const receiver, double power);
+
+	int CandidatesGenerated()const { return m_iCandidatesGenerated; }
+	int CandidatesPruned()const { return m_iCandidatesPruned; }
+	int FullTests()const { return m_iFullTests; }
+
+};
+
+#endif // PASSSEARCH_H
@@ -0,0 +1,211 @@
+#include <algorithm>
+
+#include "misc/Cgdi.h"
+#include "misc/simd.h"
+#include "misc/utils.h"
+
+#include "ParamLoader.h"
+#include "PitchControl.h"
+#include "PlayerBase.h"
+#include "SoccerPitch.h"
+#include "SoccerTeam.h"
+
+PitchControl::PitchControl(SoccerPitch* pitch, int CellsX, int CellsY) :m_pPitch(pitch), m_iCellsX(CellsX), m_iCellsY(CellsY), m_iTick(-1) {
+
+	assert((CellsX > 0) && (CellsY > 0));
+
+	const Region* PlayingField = pitch->PlayingArea();
+
+	m_dLeft = PlayingField->Left();
+	m_dTop = PlayingField->Top();
+	m_dCellWidth = PlayingField->Width() / (double)m_iCellsX;
+	m_dCellHeight = PlayingField->Height() / (double)m_iCellsY;
+
+	m_iNumCells = m_iCellsX * m_iCellsY;
+	m_iNumCellsPadded = SimdPaddedSize(m_iNumCells);
+
+	//The padding cells repeat the last cell so the kernel never works on garbage.
+	m_CellX.resize(m_iNumCellsPadded);
+	m_CellY.resize(m_iNumCellsPadded);
+
+	for (int cell = 0; cell < m_iNumCellsPadded; ++cell) {
+
+		int idx = (cell < m_iNumCells) ? cell : m_iNumCells - 1;
+
+		m_CellX[cell] = (float)(m_dLeft + ((idx % m_iCellsX) + 0.5) * m_dCellWidth);
+		m_CellY[cell] = (float)(m_dTop + ((idx / m_iCellsX) + 0.5) * m_dCellHeight);
+
+	}
+
+	m_RedTime.resize(m_iNumCellsPadded);
+	m_BlueTime.resize(m_iNumCellsPadded);
+	m_OverallTime.resize(m_iNumCellsPadded);
+	m_Owner.resize(m_iNumCellsPadded);
+
+}
+
+//--------------------------------------CellIndex---------------------------------------
+//
+// Returns the cell containing pos. Positions outside the playing area are clamped to the border cells.
+//---------------------------------------------------------------------------------------
+int PitchControl::CellIndex(Vector2D pos)const {
+
+	int col = (int)((pos.x - m_dLeft) / m_dCellWidth);
+	int row = (int)((pos.y - m_dTop) / m_dCellHeight);
+
+	if (col < 0) col = 0;
+	if (col > m_iCellsX - 1) col = m_iCellsX - 1;
+	if (row < 0) row = 0;
+	if (row > m_iCellsY - 1) row = m_iCellsY - 1;
+
+	return row * m_iCellsX + col;
+
+}
+
+//----------------------------------------Update----------------------------------------
+//---------------------------------------------------------------------------------------
+void PitchControl::Update() {
+
+	int tick = m_pPitch->TickCount();
+
+	if (tick == m_iTick) return;
+	m_iTick = tick;
+
+	m_Players.clear();
+	m_Players.insert(m_Players.end(), m_pPitch->RedTeam()->Members().begin(), m_pPitch->RedTeam()->Members().end());
+	m_Players.insert(m_Players.end(), m_pPitch->BlueTeam()->Members().begin(), m_pPitch->BlueTeam()->Members().end());
+
+	std::fill(m_RedTime.begin(), m_RedTime.end(), MaxFloat);
+	std::fill(m_BlueTime.begin(), m_BlueTime.end(), MaxFloat);
+	std::fill(m_OverallTime.begin(), m_OverallTime.end(), MaxFloat);
+	std::fill(m_Owner.begin(), m_Owner.end(), 0.0f);
+
+	const double ReactionTime = Prm.PitchControlReactionTime;
+
+	for (unsigned int plyr = 0; plyr < m_Players.size(); ++plyr) {
+
+		const PlayerBase* p = m_Players[plyr];
+
+		//Where the player will be once he has reacted.
+		Vector2D ReactionPos = p->Pos() + p->Velocity() * ReactionTime;
+
+		//A player who can't move takes a very long time to get anywhere.
+		float InvSpeed = (p->MaxSpeed() > 0.0) ? (float)(1.0 / p->MaxSpeed()) : 1.0e6f;
+
+		float* BestTime = (p->Team()->Color() == SoccerTeam::red) ? &m_RedTime[0] : &m_BlueTime[0];
+
+		AccumulatePlayer(&m_CellX[0], &m_CellY[0], m_iNumCellsPadded, (float)ReactionPos.x, (float)ReactionPos.y, (float)ReactionTime, InvSpeed, (float)plyr, BestTime, &m_OverallTime[0], &m_Owner[0]);
+
+	}
+
+}
+
+//----------------------------------------TimeToReach-----------------------------------
+//---------------------------------------------------------------------------------------
+double PitchControl::TimeToReach(const SoccerTeam* team, Vector2D pos) {
+
+	Update();
+
+	if (team->Color() == SoccerTeam::red) return m_RedTime[CellIndex(pos)];
+
+	return m_BlueTime[CellIndex(pos)];
+
+}
+
+//----------------------------------------Dominance-------------------------------------
+//---------------------------------------------------------------------------------------
+double PitchControl::Dominance(Vector2D pos) {
+
+	Update();
+
+	int cell = CellIndex(pos);
+
+	return (double)m_RedTime[cell] - (double)m_BlueTime[cell];
+
+}
+
+//------------------------------------------Owner---------------------------------------
+//---------------------------------------------------------------------------------------
+PlayerBase* PitchControl::Owner(Vector2D pos) {
+
+	Update();
+
+	return OwnerOfCell(CellIndex(pos));
+
+}
+
+//-------------------------------------IsControlledBy-----------------------------------
+//---------------------------------------------------------------------------------------
+bool PitchControl::IsControlledBy(const SoccerTeam* team, Vector2D pos) {
+	return Owner(pos)->Team() == team;
+}
+
+//------------------------------------AccumulatePlayer----------------------------------
+//
+// The min and argmin are done with masks so four cells are handled per iteration.
+//---------------------------------------------------------------------------------------
+void PitchControl::AccumulatePlayer(const float* CellX, const float* CellY, int NumCells, float px, float py, float ReactionTime, float InvSpeed, float index, float* BestTime, float* OverallTime, float* Owner) {
+
+#ifdef SIMD_SSE2
+	const __m128 vpx = _mm_set1_ps(px);
+	const __m128 vpy = _mm_set1_ps(py);
+	const __m128 vReaction = _mm_set1_ps(ReactionTime);
+	const __m128 vInvSpeed = _mm_set1_ps(InvSpeed);
+	const __m128 vIndex = _mm_set1_ps(index);
+
+	for (int i = 0; i < NumCells; i += SimdFloatWidth) {
+
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(CellX + i), vpx);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(CellY + i), vpy);
+		__m128 time = _mm_add_ps(vReaction, _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))), vInvSpeed));
+
+		_mm_storeu_ps(BestTime + i, _mm_min_ps(_mm_loadu_ps(BestTime + i), time));
+
+		__m128 overall = _mm_loadu_ps(OverallTime + i);
+		__m128 faster = _mm_cmplt_ps(time, overall);
+
+		_mm_storeu_ps(OverallTime + i, _mm_min_ps(overall, time));
+		_mm_storeu_ps(Owner + i, _mm_or_ps(_mm_and_ps(faster, vIndex), _mm_andnot_ps(faster, _mm_loadu_ps(Owner + i))));
+
+	}
+#else
+	for (int i = 0; i < NumCells; ++i) {
+
+		float dx = CellX[i] - px;
+		float dy = CellY[i] - py;
+		float time = ReactionTime + sqrtf(dx * dx + dy * dy) * InvSpeed;
+
+		if (time < BestTime[i]) BestTime[i] = time;
+
+		if (time < OverallTime[i]) {
+
+			OverallTime[i] = time;
+			Owner[i] = index;
+
+		}
+
+	}
+#endif
+
+}
+
+//------------------------------------------Render--------------------------------------
+//
+// Marks each cell with the color of the team that gets there first.
+//---------------------------------------------------------------------------------------
+void PitchControl::Render()const {
+
+	if (m_Players.empty()) return;
+
+	gdi->HollowBrush();
+
+	for (int cell = 0; cell < m_iNumCells; ++cell) {
+
+		if (m_RedTime[cell] < m_BlueTime[cell]) gdi->RedPen();
+		else gdi->BluePen();
+
+		gdi->Circle(Vector2D(m_CellX[cell], m_CellY[cell]), 1.0);
+
+	}
+
+}
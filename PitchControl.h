@@ -0,0 +1,97 @@
+#ifndef PITCHCONTROL_H
+#define PITCHCONTROL_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: PitchControl.h
+//
+//  Desc: Time-to-reach map over the playing area. For every cell it holds
+//        the minimum time any red and any blue player needs to arrive at
+//        the cell center, and the player who gets there first.
+//        A player is assumed to keep moving with his current velocity for
+//        a reaction time and then to run straight to the cell at max speed.
+//        The map is rebuilt lazily, at most once per tick.
+//
+//------------------------------------------------------------------------
+#include <vector>
+
+#include "2D/Vector2D.h"
+
+class PlayerBase;
+class SoccerPitch;
+class SoccerTeam;
+
+class PitchControl {
+
+private:
+	SoccerPitch* m_pPitch;
+
+	int m_iCellsX;
+	int m_iCellsY;
+
+	//Number of cells, and the same rounded up to a multiple of the SIMD width.
+	int m_iNumCells;
+	int m_iNumCellsPadded;
+
+	double m_dLeft;
+	double m_dTop;
+	double m_dCellWidth;
+	double m_dCellHeight;
+
+	//Cell centers.
+	std::vector<float> m_CellX;
+	std::vector<float> m_CellY;
+
+	//Minimum time (in ticks) for each team to reach each cell.
+	std::vector<float> m_RedTime;
+	std::vector<float> m_BlueTime;
+
+	//Minimum time over both teams, and the index into m_Players of the player who reaches each cell first.
+	std::vector<float> m_OverallTime;
+	std::vector<float> m_Owner;
+
+	//The players in the order they were fed to the kernel.
+	std::vector<PlayerBase*> m_Players;
+
+	//The tick the map was last calculated.
+	int m_iTick;
+
+	//Recalculates the map if it hasn't been already this tick.
+	void Update();
+
+	int CellIndex(Vector2D pos)const;
+
+public:
+	PitchControl(SoccerPitch* pitch, int CellsX, int CellsY);
+
+	//Minimum time for any player of the given team to reach pos.
+	double TimeToReach(const SoccerTeam* team, Vector2D pos);
+
+	//Red time minus blue time at pos. Positive values mean blue gets there first.
+	double Dominance(Vector2D pos);
+
+	//The player who gets to pos first.
+	PlayerBase* Owner(Vector2D pos);
+
+	//Returns true if a player of 'team' gets to pos before any opponent.
+	bool IsControlledBy(const SoccerTeam* team, Vector2D pos);
+
+	int CellsX()const { return m_iCellsX; }
+	int CellsY()const { return m_iCellsY; }
+
+	//Direct access to the map for analytics, indexed [row * CellsX() + col]. Call Refresh first.
+	void Refresh() { Update(); }
+	const float* RedTimes()const { return &m_RedTime[0]; }
+	const float* BlueTimes()const { return &m_BlueTime[0]; }
+	PlayerBase* OwnerOfCell(int cell)const { return m_Players[(int)m_Owner[cell]]; }
+
+	void Render()const;
+
+	//For a single player, lowers BestTime to the player's time to reach each cell. 'px', 'py' is the
+	//position after the reaction time. Cells where the player is fastest overall get 'index' in Owner.
+	//NumCells must be a multiple of the SIMD width.
+	static void AccumulatePlayer(const float* CellX, const float* CellY, int NumCells, float px, float py, float ReactionTime, float InvSpeed, float index, float* BestTime, float* OverallTime, float* Owner);
+
+};
+
+#endif // PITCHCONTROL_H
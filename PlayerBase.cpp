@@ -21,7 +21,7 @@ PlayerBase::~PlayerBase() {
 }
 
 PlayerBase::PlayerBase(SoccerTeam* home_team, int home_region, Vector2D heading, Vector2D velocity, double mass, double max_force, double max_speed, double max_turn_rate, double scale, player_role role) :
-	MovingEntity(home_team->Pitch()->GetRegionFromIndex(home_region)->Center(), scale*10.0, velocity, max_speed, heading, mass, Vector2D(scale, scale), max_turn_rate, max_force), m_pTeam(home_team), m_dDistSqToBall(MaxFloat), m_iHomeRegion(home_region), m_iDefaultRegion(home_region), m_PlayerRole(role) {
+	MovingEntity(home_team->Pitch()->GetRegionFromIndex(home_region)->Center(), scale*10.0, velocity, max_speed, heading, mass, Vector2D(scale, scale), max_turn_rate, max_force), m_pTeam(home_team), m_iTeamIndex((int)home_team->Members().size()), m_dDistSqToBall(MaxFloat), m_iHomeRegion(home_region), m_iDefaultRegion(home_region), m_PlayerRole(role), m_bAsleep(false) {
 
 	//Setup the vertex buffers and calculate the bounding radius
 	const int NumPlayerVerts = 4;
@@ -45,6 +45,45 @@ PlayerBase::PlayerBase(SoccerTeam* home_team, int home_region, Vector2D heading,
 
 }
 
+//---------------------------------------CommitMove---------------------------------------
+//-----------------------------------------------------------------------------------------
+void PlayerBase::CommitMove() {
+
+	m_vPosition = m_vNextPosition;
+	m_vVelocity = m_vNextVelocity;
+	m_vHeading = m_vNextHeading;
+	m_vSide = m_vNextSide;
+
+}
+
+//-----------------------------------------Reset------------------------------------------
+//-----------------------------------------------------------------------------------------
+void PlayerBase::Reset(Vector2D heading) {
+
+	m_iHomeRegion = m_iDefaultRegion;
+
+	m_vPosition = HomeRegion()->Center();
+	m_vVelocity.Zero();
+	m_vHeading = heading;
+	m_vSide = m_vHeading.Perp();
+
+	m_dDistSqToBall = MaxFloat;
+
+	m_bAsleep = false;
+
+	m_pSteering->Reset();
+	m_pSteering->SetTarget(HomeRegion()->Center());
+
+}
+
+//-----------------------------------------IsIdle-----------------------------------------
+//-----------------------------------------------------------------------------------------
+bool PlayerBase::IsIdle()const {
+
+	return m_vVelocity.isZero() && m_pSteering->Force().isZero() && m_pSteering->OnlySeparationOn();
+
+}
+
 //----------------------------------------TrackBall---------------------------------------
 //
 // Sets the player's heading to point at the ball
@@ -165,7 +204,7 @@ bool PlayerBase::IsClosestTeamMemberToBall()const {
 }
 
 bool PlayerBase::IsClosestPlayerOnPitchToBall()const {
-	return IsClosestTeamMemberToBall() && (DistSqToBall() < Team()->Opponents()->ClosestDistToBallSq());
+	return (DistSqToBall() <= Team()->ClosestDistToBallSq()) && (DistSqToBall() < Team()->Opponents()->ClosestDistToBallSq());
 }
 
 bool PlayerBase::InHotRegion()const {
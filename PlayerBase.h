@@ -37,6 +37,10 @@ protected:
 	//A pointer to this player's team
 	SoccerTeam* m_pTeam;
 
+	//Where this player is in his team's member list. The team adds the players to the list in the order
+	//they are made, so it is the size of the list when he is made.
+	int m_iTeamIndex;
+
 	//The steering behaviors
 	SteeringBehaviors* m_pSteering;
 
@@ -56,10 +60,45 @@ protected:
 	//The buffer for the transformed vertices
 	std::vector<Vector2D> m_vecPlayerVBTrans;
 
+	//The kinematic state worked out by Steer. It replaces the current one at CommitMove.
+	Vector2D m_vNextPosition;
+	Vector2D m_vNextVelocity;
+	Vector2D m_vNextHeading;
+	Vector2D m_vNextSide;
+
+	//Set while the player is asleep. See SoccerPitch::UpdateSleep.
+	bool m_bAsleep;
+
 public:
 	PlayerBase(SoccerTeam* home_team, int home_region, Vector2D heading, Vector2D velocity, double mass, double max_force, double max_speed, double max_turn_rate, double scale, player_role role);
 	virtual ~PlayerBase();
 
+	//Puts the player back in the center of his default region, at rest and facing 'heading', ready for a new match.
+	virtual void Reset(Vector2D heading);
+
+	//The update of a player is split in three phases so that all the players can work from the same state of the pitch.
+	//Think runs the player's state machine. Steer calculates the steering force and the player's next position, velocity
+	//and heading without changing the current ones, so it can run for several players at once. CommitMove makes them current.
+	virtual void Think() = 0;
+	virtual void Steer() = 0;
+	void CommitMove();
+
+	//Sets the next kinematic state directly, for MatchLanes which steers the players of several pitches at once.
+	void SetNextMove(Vector2D position, Vector2D velocity, Vector2D heading, Vector2D side) { m_vNextPosition = position; m_vNextVelocity = velocity; m_vNextHeading = heading; m_vNextSide = side; }
+
+	//Makes the next kinematic state the current one, as Steer would for a player with no force on him at rest.
+	void HoldStill() { SetNextMove(m_vPosition, m_vVelocity, m_vHeading, m_vHeading.Perp()); }
+
+	//A sleeping player keeps his steering force at zero and holds still instead of steering. The pitch puts the
+	//field players to sleep and wakes them.
+	bool IsAsleep()const { return m_bAsleep; }
+	void PutToSleep() { m_bAsleep = true; }
+	void WakeUp() { m_bAsleep = false; }
+
+	//Returns true if the player is at rest with no force on him and no behavior on but separation, so he won't
+	//move until somebody comes near him or he decides to go somewhere.
+	bool IsIdle()const;
+
 	//Returns true if there is an opponent within this player's comfort zone
 	bool IsThreatened()const;
 
@@ -91,7 +130,7 @@ public:
 	//Returns true if the player is located at his steering target.
 	bool AtTarget()const;
 
-	//Returns true if the player is the closest player in his team to the ball.
+	//Returns true if the player is the closest field player in his team to the ball. Never true of the goalkeeper.
 	bool IsClosestTeamMemberToBall()const;
 
 	//Returns true if the point specified by 'position' is located in front of the player.
@@ -122,6 +161,7 @@ public:
 	const Region* const HomeRegion()const;
 	void SetHomeRegion(int NewRegion) { m_iHomeRegion = NewRegion; }
 	SoccerTeam* const Team()const { return m_pTeam; }
+	int TeamIndex()const { return m_iTeamIndex; }
 
 };
 
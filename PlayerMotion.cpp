@@ -0,0 +1,540 @@
+#include <cmath>
+#include <limits>
+
+#include "2D/Transformations.h"
+#include "misc/utils.h"
+
+#include "Goalkeeper.h"
+#include "ParamLoader.h"
+#include "PlayerBase.h"
+#include "PlayerMotion.h"
+#include "SteeringBehaviors.h"
+
+#ifdef SIMD_SSE2
+//Picks a where the mask is set and b where it isn't.
+inline __m128d Select(__m128d mask, __m128d a, __m128d b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+inline __m128 Select(__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+#endif
+
+template <class real>
+PlayerMotionT<real>::PlayerMotionT(int size) :m_iSize((size + SimdWidth<real>::value - 1) / SimdWidth<real>::value * SimdWidth<real>::value), m_iCount(m_iSize) {
+
+	m_PosX.assign(m_iSize, 0.0);
+	m_PosY.assign(m_iSize, 0.0);
+	m_VelX.assign(m_iSize, 0.0);
+	m_VelY.assign(m_iSize, 0.0);
+	m_HeadX.assign(m_iSize, 1.0);
+	m_HeadY.assign(m_iSize, 0.0);
+	m_SideX.assign(m_iSize, 0.0);
+	m_SideY.assign(m_iSize, 1.0);
+	m_ForceX.assign(m_iSize, 0.0);
+	m_ForceY.assign(m_iSize, 0.0);
+	m_Mass.assign(m_iSize, 1.0);
+	m_MaxSpeed.assign(m_iSize, 0.0);
+	m_MaxTurnRate.assign(m_iSize, 0.0);
+
+}
+
+//----------------------------------------SetCount--------------------------------------
+//---------------------------------------------------------------------------------------
+template <class real>
+void PlayerMotionT<real>::SetCount(int count) {
+
+	m_iCount = MinOf((count + SimdWidth<real>::value - 1) / SimdWidth<real>::value * SimdWidth<real>::value, m_iSize);
+
+}
+
+//------------------------------------------Load----------------------------------------
+//---------------------------------------------------------------------------------------
+template <class real>
+void PlayerMotionT<real>::Load(int i, const PlayerBase* player) {
+
+	m_PosX[i] = (real)player->Pos().x;
+	m_PosY[i] = (real)player->Pos().y;
+	m_VelX[i] = (real)player->Velocity().x;
+	m_VelY[i] = (real)player->Velocity().y;
+	m_HeadX[i] = (real)player->Heading().x;
+	m_HeadY[i] = (real)player->Heading().y;
+	m_SideX[i] = (real)player->Side().x;
+	m_SideY[i] = (real)player->Side().y;
+	m_ForceX[i] = (real)player->Steering()->Force().x;
+	m_ForceY[i] = (real)player->Steering()->Force().y;
+	m_Mass[i] = (real)player->Mass();
+	m_MaxSpeed[i] = (real)player->MaxSpeed();
+	m_MaxTurnRate[i] = (real)player->MaxTurnRate();
+
+}
+
+//-----------------------------------------Store----------------------------------------
+//---------------------------------------------------------------------------------------
+template <class real>
+void PlayerMotionT<real>::Store(int i, PlayerBase* player)const {
+
+	player->SetNextMove(Vector2D(m_PosX[i], m_PosY[i]), Vector2D(m_VelX[i], m_VelY[i]), Vector2D(m_HeadX[i], m_HeadY[i]), Vector2D(m_SideX[i], m_SideY[i]));
+
+	if (player->Role() == PlayerBase::goal_keeper) static_cast<GoalKeeper*>(player)->UpdateLookAt();
+
+}
+
+//-----------------------------------IntegrateFieldPlayers------------------------------
+//
+// The reference rotation is done the way Vec2DRotateAroundOrigin does it, multiplying
+// the rotation into an identity matrix first, so that the result is the same down to
+// the sign of a zero. Only sin and cos are worked out one lane at a time.
+//---------------------------------------------------------------------------------------
+template <>
+void PlayerMotionT<double>::IntegrateFieldPlayers(integration how) {
+
+	for (int i = 0; i < m_iCount; i += SimdDoubleWidth) {
+
+#ifdef SIMD_SSE2
+		const __m128d zero = _mm_setzero_pd();
+		const __m128d one = _mm_set1_pd(1.0);
+		const __m128d epsilon = _mm_set1_pd(std::numeric_limits<double>::epsilon());
+
+		__m128d vx = _mm_loadu_pd(&m_VelX[i]);
+		__m128d vy = _mm_loadu_pd(&m_VelY[i]);
+		__m128d hx = _mm_loadu_pd(&m_HeadX[i]);
+		__m128d hy = _mm_loadu_pd(&m_HeadY[i]);
+		__m128d fx = _mm_loadu_pd(&m_ForceX[i]);
+		__m128d fy = _mm_loadu_pd(&m_ForceY[i]);
+
+		//Brake if there is no steering force.
+		__m128d NoForce = _mm_cmplt_pd(_mm_add_pd(_mm_mul_pd(fx, fx), _mm_mul_pd(fy, fy)), _mm_set1_pd(MinDouble));
+
+		const __m128d BrakingRate = _mm_set1_pd(0.8);
+		vx = Select(NoForce, _mm_mul_pd(vx, BrakingRate), vx);
+		vy = Select(NoForce, _mm_mul_pd(vy, BrakingRate), vy);
+
+		//The side component of the force, clamped to the turn rate.
+		__m128d side = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(&m_SideX[i]), fx), _mm_mul_pd(_mm_loadu_pd(&m_SideY[i]), fy));
+		__m128d turn = _mm_mul_pd(side, _mm_loadu_pd(&m_MaxTurnRate[i]));
+
+		turn = _mm_max_pd(turn, _mm_set1_pd(-Prm.PlayerMaxTurnRate));
+		turn = _mm_min_pd(turn, _mm_set1_pd(Prm.PlayerMaxTurnRate));
+
+		double angle[SimdDoubleWidth];
+		double Sin[SimdDoubleWidth];
+		double Cos[SimdDoubleWidth];
+
+		_mm_storeu_pd(angle, turn);
+
+		for (int lane = 0; lane < SimdDoubleWidth; ++lane) {
+			Sin[lane] = DetMath::Sin(angle[lane]);
+			Cos[lane] = DetMath::Cos(angle[lane]);
+		}
+
+		__m128d s = _mm_loadu_pd(Sin);
+		__m128d c = _mm_loadu_pd(Cos);
+
+		__m128d mass = _mm_loadu_pd(&m_Mass[i]);
+		__m128d MaxSpeed = _mm_loadu_pd(&m_MaxSpeed[i]);
+
+		if (how == reference) {
+
+			__m128d ns = _mm_xor_pd(s, _mm_set1_pd(-0.0));
+			__m128d ZeroZero = _mm_mul_pd(zero, zero);
+
+			__m128d m11 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(one, c), _mm_mul_pd(zero, ns)), ZeroZero);
+			__m128d m12 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(one, s), _mm_mul_pd(zero, c)), ZeroZero);
+			__m128d m21 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(zero, c), _mm_mul_pd(one, ns)), ZeroZero);
+			__m128d m22 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(zero, s), _mm_mul_pd(one, c)), ZeroZero);
+			__m128d m31 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(zero, c), _mm_mul_pd(zero, ns)), _mm_mul_pd(one, zero));
+			__m128d m32 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(zero, s), _mm_mul_pd(zero, c)), _mm_mul_pd(one, zero));
+
+			__m128d RotatedX = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m11, hx), _mm_mul_pd(m21, hy)), m31);
+			__m128d RotatedY = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m12, hx), _mm_mul_pd(m22, hy)), m32);
+
+			hx = RotatedX;
+			hy = RotatedY;
+
+			//Point the velocity along the new heading.
+			__m128d speed = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy)));
+
+			vx = _mm_mul_pd(hx, speed);
+			vy = _mm_mul_pd(hy, speed);
+
+			//Accelerate by the forward component of the force.
+			__m128d forward = _mm_add_pd(_mm_mul_pd(hx, fx), _mm_mul_pd(hy, fy));
+
+			vx = _mm_add_pd(vx, _mm_div_pd(_mm_mul_pd(hx, forward), mass));
+			vy = _mm_add_pd(vy, _mm_div_pd(_mm_mul_pd(hy, forward), mass));
+
+			//Truncate to the max speed.
+			speed = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy)));
+
+			__m128d TooFast = _mm_cmpgt_pd(speed, MaxSpeed);
+			__m128d divides = _mm_cmpgt_pd(speed, epsilon);
+
+			vx = Select(TooFast, _mm_mul_pd(Select(divides, _mm_div_pd(vx, speed), vx), MaxSpeed), vx);
+			vy = Select(TooFast, _mm_mul_pd(Select(divides, _mm_div_pd(vy, speed), vy), MaxSpeed), vy);
+
+		}
+
+		else {
+
+			__m128d RotatedX = _mm_sub_pd(_mm_mul_pd(hx, c), _mm_mul_pd(hy, s));
+			__m128d RotatedY = _mm_add_pd(_mm_mul_pd(hx, s), _mm_mul_pd(hy, c));
+
+			hx = RotatedX;
+			hy = RotatedY;
+
+			//The heading is a unit vector, so the new speed is the old one plus the forward acceleration,
+			//and it can be clamped before the velocity is made from it.
+			__m128d forward = _mm_add_pd(_mm_mul_pd(hx, fx), _mm_mul_pd(hy, fy));
+			__m128d speed = _mm_add_pd(_mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy))), _mm_div_pd(forward, mass));
+
+			speed = _mm_min_pd(_mm_max_pd(speed, _mm_sub_pd(zero, MaxSpeed)), MaxSpeed);
+
+			vx = _mm_mul_pd(hx, speed);
+			vy = _mm_mul_pd(hy, speed);
+
+		}
+
+		_mm_storeu_pd(&m_PosX[i], _mm_add_pd(_mm_loadu_pd(&m_PosX[i]), vx));
+		_mm_storeu_pd(&m_PosY[i], _mm_add_pd(_mm_loadu_pd(&m_PosY[i]), vy));
+		_mm_storeu_pd(&m_VelX[i], vx);
+		_mm_storeu_pd(&m_VelY[i], vy);
+		_mm_storeu_pd(&m_HeadX[i], hx);
+		_mm_storeu_pd(&m_HeadY[i], hy);
+		_mm_storeu_pd(&m_SideX[i], _mm_xor_pd(hy, _mm_set1_pd(-0.0)));
+		_mm_storeu_pd(&m_SideY[i], hx);
+#else
+		for (int p = i; p < i + SimdDoubleWidth; ++p) {
+
+			Vector2D velocity(m_VelX[p], m_VelY[p]);
+			Vector2D heading(m_HeadX[p], m_HeadY[p]);
+			Vector2D force(m_ForceX[p], m_ForceY[p]);
+
+			if (force.isZero()) velocity = velocity * 0.8;
+
+			double TurningForce = Vector2D(m_SideX[p], m_SideY[p]).Dot(force) * m_MaxTurnRate[p];
+			Clamp(TurningForce, -Prm.PlayerMaxTurnRate, Prm.PlayerMaxTurnRate);
+
+			if (how == reference) {
+
+				Vec2DRotateAroundOrigin(heading, TurningForce);
+
+				velocity = heading * velocity.Length();
+				velocity += heading * heading.Dot(force) / m_Mass[p];
+				velocity.Truncate(m_MaxSpeed[p]);
+
+			}
+
+			else {
+
+				double s = DetMath::Sin(TurningForce);
+				double c = DetMath::Cos(TurningForce);
+
+				heading = Vector2D(heading.x * c - heading.y * s, heading.x * s + heading.y * c);
+
+				double speed = velocity.Length() + heading.Dot(force) / m_Mass[p];
+				Clamp(speed, -m_MaxSpeed[p], m_MaxSpeed[p]);
+
+				velocity = heading * speed;
+
+			}
+
+			m_PosX[p] += velocity.x;
+			m_PosY[p] += velocity.y;
+			m_VelX[p] = velocity.x;
+			m_VelY[p] = velocity.y;
+			m_HeadX[p] = heading.x;
+			m_HeadY[p] = heading.y;
+			m_SideX[p] = heading.Perp().x;
+			m_SideY[p] = heading.Perp().y;
+
+		}
+#endif
+
+	}
+
+}
+
+//-----------------------------------IntegrateGoalKeepers-------------------------------
+//---------------------------------------------------------------------------------------
+template <>
+void PlayerMotionT<double>::IntegrateGoalKeepers(integration how) {
+
+	for (int i = 0; i < m_iCount; i += SimdDoubleWidth) {
+
+#ifdef SIMD_SSE2
+		const __m128d epsilon = _mm_set1_pd(std::numeric_limits<double>::epsilon());
+
+		__m128d mass = _mm_loadu_pd(&m_Mass[i]);
+
+		__m128d vx = _mm_add_pd(_mm_loadu_pd(&m_VelX[i]), _mm_div_pd(_mm_loadu_pd(&m_ForceX[i]), mass));
+		__m128d vy = _mm_add_pd(_mm_loadu_pd(&m_VelY[i]), _mm_div_pd(_mm_loadu_pd(&m_ForceY[i]), mass));
+
+		__m128d MaxSpeed = _mm_loadu_pd(&m_MaxSpeed[i]);
+		__m128d SpeedSq = _mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy));
+		__m128d speed = _mm_sqrt_pd(SpeedSq);
+
+		__m128d hx;
+		__m128d hy;
+
+		if (how == reference) {
+
+			//Truncate to the max speed.
+			__m128d TooFast = _mm_cmpgt_pd(speed, MaxSpeed);
+			__m128d divides = _mm_cmpgt_pd(speed, epsilon);
+
+			vx = Select(TooFast, _mm_mul_pd(Select(divides, _mm_div_pd(vx, speed), vx), MaxSpeed), vx);
+			vy = Select(TooFast, _mm_mul_pd(Select(divides, _mm_div_pd(vy, speed), vy), MaxSpeed), vy);
+
+			//The heading is the normalized velocity, worked out again after the truncation.
+			SpeedSq = _mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy));
+
+			speed = _mm_sqrt_pd(SpeedSq);
+			divides = _mm_cmpgt_pd(speed, epsilon);
+
+			hx = Select(divides, _mm_div_pd(vx, speed), vx);
+			hy = Select(divides, _mm_div_pd(vy, speed), vy);
+
+		}
+
+		else {
+
+			//Truncating doesn't change the direction, so the heading comes from the same length.
+			hx = _mm_div_pd(vx, speed);
+			hy = _mm_div_pd(vy, speed);
+
+			__m128d TooFast = _mm_cmpgt_pd(speed, MaxSpeed);
+
+			vx = Select(TooFast, _mm_mul_pd(hx, MaxSpeed), vx);
+			vy = Select(TooFast, _mm_mul_pd(hy, MaxSpeed), vy);
+
+		}
+
+		//Face the way the keeper moves, if he moves.
+		__m128d moving = _mm_cmpge_pd(SpeedSq, _mm_set1_pd(MinDouble));
+
+		_mm_storeu_pd(&m_HeadX[i], Select(moving, hx, _mm_loadu_pd(&m_HeadX[i])));
+		_mm_storeu_pd(&m_HeadY[i], Select(moving, hy, _mm_loadu_pd(&m_HeadY[i])));
+		_mm_storeu_pd(&m_SideX[i], Select(moving, _mm_xor_pd(hy, _mm_set1_pd(-0.0)), _mm_loadu_pd(&m_SideX[i])));
+		_mm_storeu_pd(&m_SideY[i], Select(moving, hx, _mm_loadu_pd(&m_SideY[i])));
+
+		_mm_storeu_pd(&m_PosX[i], _mm_add_pd(_mm_loadu_pd(&m_PosX[i]), vx));
+		_mm_storeu_pd(&m_PosY[i], _mm_add_pd(_mm_loadu_pd(&m_PosY[i]), vy));
+		_mm_storeu_pd(&m_VelX[i], vx);
+		_mm_storeu_pd(&m_VelY[i], vy);
+#else
+		for (int p = i; p < i + SimdDoubleWidth; ++p) {
+
+			Vector2D velocity = Vector2D(m_VelX[p], m_VelY[p]) + Vector2D(m_ForceX[p], m_ForceY[p]) / m_Mass[p];
+			Vector2D heading;
+
+			if (how == reference) {
+
+				velocity.Truncate(m_MaxSpeed[p]);
+				heading = Vec2DNormalize(velocity);
+
+			}
+
+			else {
+
+				double speed = velocity.Length();
+
+				heading = velocity / speed;
+				if (speed > m_MaxSpeed[p]) velocity = heading * m_MaxSpeed[p];
+
+			}
+
+			m_PosX[p] += velocity.x;
+			m_PosY[p] += velocity.y;
+			m_VelX[p] = velocity.x;
+			m_VelY[p] = velocity.y;
+
+			if (velocity.isZero()) continue;
+
+			m_HeadX[p] = heading.x;
+			m_HeadY[p] = heading.y;
+			m_SideX[p] = heading.Perp().x;
+			m_SideY[p] = heading.Perp().y;
+
+		}
+#endif
+
+	}
+
+}
+
+//-----------------------------IntegrateFieldPlayers (float)----------------------------
+//
+// The fast integration, four players at a time.
+//---------------------------------------------------------------------------------------
+template <>
+void PlayerMotionT<float>::IntegrateFieldPlayers(integration) {
+
+	const float MaxTurnRate = (float)Prm.PlayerMaxTurnRate;
+
+	for (int i = 0; i < m_iCount; i += SimdFloatWidth) {
+
+#ifdef SIMD_SSE2
+		const __m128 zero = _mm_setzero_ps();
+
+		__m128 vx = _mm_loadu_ps(&m_VelX[i]);
+		__m128 vy = _mm_loadu_ps(&m_VelY[i]);
+		__m128 hx = _mm_loadu_ps(&m_HeadX[i]);
+		__m128 hy = _mm_loadu_ps(&m_HeadY[i]);
+		__m128 fx = _mm_loadu_ps(&m_ForceX[i]);
+		__m128 fy = _mm_loadu_ps(&m_ForceY[i]);
+
+		//Brake if there is no steering force. No float squared length is below MinDouble but zero.
+		__m128 NoForce = _mm_cmpeq_ps(_mm_add_ps(_mm_mul_ps(fx, fx), _mm_mul_ps(fy, fy)), zero);
+
+		const __m128 BrakingRate = _mm_set1_ps(0.8f);
+		vx = Select(NoForce, _mm_mul_ps(vx, BrakingRate), vx);
+		vy = Select(NoForce, _mm_mul_ps(vy, BrakingRate), vy);
+
+		//The side component of the force, clamped to the turn rate.
+		__m128 side = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m_SideX[i]), fx), _mm_mul_ps(_mm_loadu_ps(&m_SideY[i]), fy));
+		__m128 turn = _mm_mul_ps(side, _mm_loadu_ps(&m_MaxTurnRate[i]));
+
+		turn = _mm_max_ps(turn, _mm_set1_ps(-MaxTurnRate));
+		turn = _mm_min_ps(turn, _mm_set1_ps(MaxTurnRate));
+
+		float angle[SimdFloatWidth];
+		float Sin[SimdFloatWidth];
+		float Cos[SimdFloatWidth];
+
+		_mm_storeu_ps(angle, turn);
+
+		for (int lane = 0; lane < SimdFloatWidth; ++lane) {
+			Sin[lane] = DetMath::Sin(angle[lane]);
+			Cos[lane] = DetMath::Cos(angle[lane]);
+		}
+
+		__m128 s = _mm_loadu_ps(Sin);
+		__m128 c = _mm_loadu_ps(Cos);
+
+		__m128 RotatedX = _mm_sub_ps(_mm_mul_ps(hx, c), _mm_mul_ps(hy, s));
+		__m128 RotatedY = _mm_add_ps(_mm_mul_ps(hx, s), _mm_mul_ps(hy, c));
+
+		hx = RotatedX;
+		hy = RotatedY;
+
+		__m128 MaxSpeed = _mm_loadu_ps(&m_MaxSpeed[i]);
+
+		__m128 forward = _mm_add_ps(_mm_mul_ps(hx, fx), _mm_mul_ps(hy, fy));
+		__m128 speed = _mm_add_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy))), _mm_div_ps(forward, _mm_loadu_ps(&m_Mass[i])));
+
+		speed = _mm_min_ps(_mm_max_ps(speed, _mm_sub_ps(zero, MaxSpeed)), MaxSpeed);
+
+		vx = _mm_mul_ps(hx, speed);
+		vy = _mm_mul_ps(hy, speed);
+
+		_mm_storeu_ps(&m_PosX[i], _mm_add_ps(_mm_loadu_ps(&m_PosX[i]), vx));
+		_mm_storeu_ps(&m_PosY[i], _mm_add_ps(_mm_loadu_ps(&m_PosY[i]), vy));
+		_mm_storeu_ps(&m_VelX[i], vx);
+		_mm_storeu_ps(&m_VelY[i], vy);
+		_mm_storeu_ps(&m_HeadX[i], hx);
+		_mm_storeu_ps(&m_HeadY[i], hy);
+		_mm_storeu_ps(&m_SideX[i], _mm_xor_ps(hy, _mm_set1_ps(-0.0f)));
+		_mm_storeu_ps(&m_SideY[i], hx);
+#else
+		for (int p = i; p < i + SimdFloatWidth; ++p) {
+
+			Vector2Df velocity(m_VelX[p], m_VelY[p]);
+			Vector2Df heading(m_HeadX[p], m_HeadY[p]);
+			Vector2Df force(m_ForceX[p], m_ForceY[p]);
+
+			if (force.isZero()) velocity = velocity * 0.8f;
+
+			float TurningForce = Vector2Df(m_SideX[p], m_SideY[p]).Dot(force) * m_MaxTurnRate[p];
+			Clamp(TurningForce, -MaxTurnRate, MaxTurnRate);
+
+			float s = DetMath::Sin(TurningForce);
+			float c = DetMath::Cos(TurningForce);
+
+			heading = Vector2Df(heading.x * c - heading.y * s, heading.x * s + heading.y * c);
+
+			float speed = velocity.Length() + heading.Dot(force) / m_Mass[p];
+			Clamp(speed, -m_MaxSpeed[p], m_MaxSpeed[p]);
+
+			velocity = heading * speed;
+
+			m_PosX[p] += velocity.x;
+			m_PosY[p] += velocity.y;
+			m_VelX[p] = velocity.x;
+			m_VelY[p] = velocity.y;
+			m_HeadX[p] = heading.x;
+			m_HeadY[p] = heading.y;
+			m_SideX[p] = heading.Perp().x;
+			m_SideY[p] = heading.Perp().y;
+
+		}
+#endif
+
+	}
+
+}
+
+//-----------------------------IntegrateGoalKeepers (float)-----------------------------
+//---------------------------------------------------------------------------------------
+template <>
+void PlayerMotionT<float>::IntegrateGoalKeepers(integration) {
+
+	for (int i = 0; i < m_iCount; i += SimdFloatWidth) {
+
+#ifdef SIMD_SSE2
+		__m128 mass = _mm_loadu_ps(&m_Mass[i]);
+
+		__m128 vx = _mm_add_ps(_mm_loadu_ps(&m_VelX[i]), _mm_div_ps(_mm_loadu_ps(&m_ForceX[i]), mass));
+		__m128 vy = _mm_add_ps(_mm_loadu_ps(&m_VelY[i]), _mm_div_ps(_mm_loadu_ps(&m_ForceY[i]), mass));
+
+		__m128 MaxSpeed = _mm_loadu_ps(&m_MaxSpeed[i]);
+		__m128 SpeedSq = _mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy));
+		__m128 speed = _mm_sqrt_ps(SpeedSq);
+
+		__m128 hx = _mm_div_ps(vx, speed);
+		__m128 hy = _mm_div_ps(vy, speed);
+
+		__m128 TooFast = _mm_cmpgt_ps(speed, MaxSpeed);
+
+		vx = Select(TooFast, _mm_mul_ps(hx, MaxSpeed), vx);
+		vy = Select(TooFast, _mm_mul_ps(hy, MaxSpeed), vy);
+
+		//Face the way the keeper moves, if he moves.
+		__m128 moving = _mm_cmpgt_ps(SpeedSq, _mm_setzero_ps());
+
+		_mm_storeu_ps(&m_HeadX[i], Select(moving, hx, _mm_loadu_ps(&m_HeadX[i])));
+		_mm_storeu_ps(&m_HeadY[i], Select(moving, hy, _mm_loadu_ps(&m_HeadY[i])));
+		_mm_storeu_ps(&m_SideX[i], Select(moving, _mm_xor_ps(hy, _mm_set1_ps(-0.0f)), _mm_loadu_ps(&m_SideX[i])));
+		_mm_storeu_ps(&m_SideY[i], Select(moving, hx, _mm_loadu_ps(&m_SideY[i])));
+
+		_mm_storeu_ps(&m_PosX[i], _mm_add_ps(_mm_loadu_ps(&m_PosX[i]), vx));
+		_mm_storeu_ps(&m_PosY[i], _mm_add_ps(_mm_loadu_ps(&m_PosY[i]), vy));
+		_mm_storeu_ps(&m_VelX[i], vx);
+		_mm_storeu_ps(&m_VelY[i], vy);
+#else
+		for (int p = i; p < i + SimdFloatWidth; ++p) {
+
+			Vector2Df velocity = Vector2Df(m_VelX[p], m_VelY[p]) + Vector2Df(m_ForceX[p], m_ForceY[p]) / m_Mass[p];
+
+			float speed = velocity.Length();
+
+			Vector2Df heading = velocity / speed;
+			if (speed > m_MaxSpeed[p]) velocity = heading * m_MaxSpeed[p];
+
+			m_PosX[p] += velocity.x;
+			m_PosY[p] += velocity.y;
+			m_VelX[p] = velocity.x;
+			m_VelY[p] = velocity.y;
+
+			if (velocity.isZero()) continue;
+
+			m_HeadX[p] = heading.x;
+			m_HeadY[p] = heading.y;
+			m_SideX[p] = heading.Perp().x;
+			m_SideY[p] = heading.Perp().y;
+
+		}
+#endif
+
+	}
+
+}
+
+template class PlayerMotionT<double>;
+template class PlayerMotionT<float>;
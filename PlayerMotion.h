@@ -0,0 +1,86 @@
+#ifndef PLAYERMOTION_H
+#define PLAYERMOTION_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: PlayerMotion.h
+//
+//  Desc: The kinematic state of a set of players, one array per quantity,
+//        and the integration FieldPlayer::Steer and GoalKeeper::Steer do
+//        to move them on, done for a pair of players at a time with SSE2.
+//        A set holds either field players or goal keepers, never both.
+//
+//        The reference integration gives bit for bit the same moves as the
+//        players' own Steer, so recorded matches replay the same. The fast
+//        one rotates the heading with sin and cos directly, skips a square
+//        root and a division or two, and only agrees with it to rounding.
+//
+//        The state is held as doubles by PlayerMotion and as floats by
+//        PlayerMotionf, which does four players per SSE register instead of
+//        two. Only the fast integration is done in single precision.
+//
+//------------------------------------------------------------------------
+#include <vector>
+
+#include "misc/simd.h"
+
+class PlayerBase;
+
+template <class real>
+class PlayerMotionT {
+
+public:
+	enum integration { reference, fast };
+
+private:
+	//Padded to a whole number of SSE2 lanes.
+	int m_iSize;
+
+	//Number of entries integrated, padded the same way.
+	int m_iCount;
+
+	std::vector<real> m_PosX;
+	std::vector<real> m_PosY;
+	std::vector<real> m_VelX;
+	std::vector<real> m_VelY;
+	std::vector<real> m_HeadX;
+	std::vector<real> m_HeadY;
+	std::vector<real> m_SideX;
+	std::vector<real> m_SideY;
+	std::vector<real> m_ForceX;
+	std::vector<real> m_ForceY;
+	std::vector<real> m_Mass;
+	std::vector<real> m_MaxSpeed;
+	std::vector<real> m_MaxTurnRate;
+
+public:
+	PlayerMotionT(int size);
+
+	int Size()const { return m_iSize; }
+
+	//Only the first 'count' entries are integrated from now on, so a set with some players left out
+	//doesn't pay for them. The entries after them keep what they hold.
+	void SetCount(int count);
+
+	//Copies the player's state, and the steering force he has worked out, into entry i.
+	void Load(int i, const PlayerBase* player);
+
+	//Hands the move worked out for entry i to the player.
+	void Store(int i, PlayerBase* player)const;
+
+	//Replaces the position, velocity, heading and side of every entry by the next ones. A PlayerMotionf
+	//always integrates the fast way.
+	void IntegrateFieldPlayers(integration how);
+	void IntegrateGoalKeepers(integration how);
+
+};
+
+template <> void PlayerMotionT<double>::IntegrateFieldPlayers(integration how);
+template <> void PlayerMotionT<double>::IntegrateGoalKeepers(integration how);
+template <> void PlayerMotionT<float>::IntegrateFieldPlayers(integration how);
+template <> void PlayerMotionT<float>::IntegrateGoalKeepers(integration how);
+
+typedef PlayerMotionT<double> PlayerMotion;
+typedef PlayerMotionT<float>  PlayerMotionf;
+
+#endif // PLAYERMOTION_H
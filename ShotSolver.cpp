@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <math.h>
+
+#include "misc/FastMath.h"
+#include "misc/utils.h"
+
+#include "ShotSolver.h"
+
+//utils.h only has a rounded Pi, which is not good enough to tell directions that face the goal from those that don't.
+const double RightAngle = 1.5707963267948966;
+
+//Most steps taken to find the edge of an opponent's blocking cone, and how close to it they stop (radians).
+//Newton's method gets there in about five steps where bisection took forty.
+const int MaxRootSteps = 20;
+const double RootTolerance = 1e-12;
+
+//----------------------------------BallTimeToCover-------------------------------------
+//---------------------------------------------------------------------------------------
+double BallTimeToCover(double distance, double speed, double friction) {
+
+	double term = speed * speed + 2.0 * distance * friction;
+
+	if (term <= 0.0) return -1.0;
+
+	if (friction == 0.0) return distance / speed;
+
+	return (FastMath::Sqrt(term) - speed) / friction;
+
+}
+
+//---------------------------------BlockingHalfAngle------------------------------------
+//
+// The opponent is at distance r from the kicker. For a shot heading at angle a from the
+// direction of the opponent, the opponent is at x = r cos(a), y = r sin(a) in the local space
+// of the shot and intercepts it if r sin(a) < MaxSpeed * t(r cos(a)) + radii.
+// For 0 <= a <= 90 degrees the left side only grows and the right side only shrinks, so
+// the shots intercepted are exactly those with a below the root. The root is found with
+// Newton's method, starting from the angle the opponent covers if the ball went straight
+// at him. A step that would leave the bracket around the root bisects it instead.
+//---------------------------------------------------------------------------------------
+static double BlockingHalfAngle(double r, double MaxSpeed, double radii, double BallSpeed, double friction) {
+
+	//The opponent overlaps the ball: every shot that doesn't go behind him is blocked.
+	if (r <= radii) return RightAngle;
+
+	double low = 0.0;
+	double high = RightAngle;
+
+	double reach = MaxSpeed * BallTimeToCover(r, BallSpeed, friction) + radii;
+	double a = (reach < r) ? FastMath::Atan2(reach, FastMath::Sqrt(r * r - reach * reach)) : RightAngle * 0.5;
+
+	for (int step = 0; step < MaxRootSteps; ++step) {
+
+		double SinA = DetMath::Sin(a);
+		double CosA = DetMath::Cos(a);
+
+		//The opponent's distance from the shot less his reach, and its slope. The ball's speed when it
+		//passes him is the reciprocal of the slope of its time to cover the distance.
+		double dist = r * CosA;
+		double gap = r * SinA - (MaxSpeed * BallTimeToCover(dist, BallSpeed, friction) + radii);
+		double slope = r * CosA + MaxSpeed * r * SinA / FastMath::Sqrt(BallSpeed * BallSpeed + 2.0 * dist * friction);
+
+		if (gap < 0.0) low = a;
+		else high = a;
+
+		double next = a - gap / slope;
+
+		if ((next <= low) || (next >= high)) next = (low + high) * 0.5;
+
+		if (fabs(next - a) < RootTolerance) return next;
+
+		a = next;
+
+	}
+
+	return a;
+
+}
+
+//--------------------------------GetOpenShotIntervals----------------------------------
+//
+// The geometry is mirrored if necessary so the goal is always in the +x direction. Each
+// opponent then blocks a cone of directions, which maps onto an interval of the goal line.
+// The shots landing nearer to the kicker than the opponent are not blocked by him,
+// so that band is removed from the interval. The intervals are sorted and swept to find the gaps.
+//---------------------------------------------------------------------------------------
+void GetOpenShotIntervals(Vector2D BallPos, double BallSpeed, double BallRadius, double friction, double GoalX, double MinY, double MaxY, const std::vector<ShotOpponent>& opponents, std::vector<ShotInterval>& open) {
+
+	open.clear();
+
+	double dx = GoalX - BallPos.x;
+	double DistToLine = fabs(dx);
+	double dir = (dx >= 0.0) ? 1.0 : -1.0;
+
+	if (DistToLine < 1e-9) return;
+
+	//The furthest the ball can travel, and the part of the goal line within that range.
+	double MaxDist = (friction < 0.0) ? -(BallSpeed * BallSpeed) / (2.0 * friction) : MaxDouble;
+
+	if (MaxDist <= DistToLine) return;
+
+	double HalfRange = (MaxDist == MaxDouble) ? MaxDouble : FastMath::Sqrt(MaxDist * MaxDist - DistToLine * DistToLine);
+
+	double low = MaxOf(MinY, BallPos.y - HalfRange);
+	double high = MinOf(MaxY, BallPos.y + HalfRange);
+
+	if (low >= high) return;
+
+	std::vector<ShotInterval> blocked;
+
+	for (unsigned int opp = 0; opp < opponents.size(); ++opp) {
+
+		double rx = dir * (opponents[opp].m_vPos.x - BallPos.x);
+		double ry = opponents[opp].m_vPos.y - BallPos.y;
+		double r = FastMath::Sqrt(rx * rx + ry * ry);
+
+		//Only the shots that land further away than the opponent can be intercepted, so an opponent
+		//out of the ball's range can't intercept any of them.
+		if (r >= MaxDist) continue;
+
+		double HalfAngle = BlockingHalfAngle(r, opponents[opp].m_dMaxSpeed, BallRadius + opponents[opp].m_dBRadius, BallSpeed, friction);
+		double angle = FastMath::Atan2(ry, rx);
+
+		//Only directions heading towards the goal line reach it.
+		double LowAngle = MaxOf(angle - HalfAngle, -RightAngle);
+		double HighAngle = MinOf(angle + HalfAngle, RightAngle);
+
+		if (LowAngle >= HighAngle) continue;
+
+		double LowY = (LowAngle <= -RightAngle) ? -MaxDouble : BallPos.y + DistToLine * DetMath::Tan(LowAngle);
+		double HighY = (HighAngle >= RightAngle) ? MaxDouble : BallPos.y + DistToLine * DetMath::Tan(HighAngle);
+
+		//Remove the targets nearer to the kicker than the opponent.
+		double NearBand = (r > DistToLine) ? FastMath::Sqrt(r * r - DistToLine * DistToLine) : 0.0;
+
+		if (NearBand == 0.0) blocked.push_back(ShotInterval(LowY, HighY));
+
+		else {
+
+			if (LowY < BallPos.y - NearBand) blocked.push_back(ShotInterval(LowY, MinOf(HighY, BallPos.y - NearBand)));
+			if (HighY > BallPos.y + NearBand) blocked.push_back(ShotInterval(MaxOf(LowY, BallPos.y + NearBand), HighY));
+
+		}
+
+	}
+
+	std::sort(blocked.begin(), blocked.end());
+
+	//Sweep along the goal line collecting the gaps.
+	double cursor = low;
+
+	for (unsigned int b = 0; (b < blocked.size()) && (cursor < high); ++b) {
+
+		if (blocked[b].m_dLow > cursor) open.push_back(ShotInterval(cursor, MinOf(blocked[b].m_dLow, high)));
+
+		cursor = MaxOf(cursor, blocked[b].m_dHigh);
+
+	}
+
+	if (cursor < high) open.push_back(ShotInterval(cursor, high));
+
+}
+
+//---------------------------------GetBestShotInterval----------------------------------
+//
+// The goal mouth limits are treated like blocked parts, so the point with the largest
+// clearance is the center of the widest interval.
+//---------------------------------------------------------------------------------------
+const ShotInterval* GetBestShotInterval(const std::vector<ShotInterval>& open) {
+
+	const ShotInterval* best = NULL;
+
+	for (unsigned int i = 0; i < open.size(); ++i) {
+
+		if (!best || (open[i].Width() > best->Width())) best = &open[i];
+
+	}
+
+	return best;
+
+}
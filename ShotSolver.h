@@ -0,0 +1,59 @@
+#ifndef SHOTSOLVER_H
+#define SHOTSOLVER_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: ShotSolver.h
+//
+//  Desc: Exact solver for the shots that can't be intercepted. Each
+//        opponent's blocking cone is projected onto the goal line and the
+//        parts of the goal mouth left uncovered are returned as intervals.
+//        The blocking test is the one SoccerTeam::IsPassSafeFromOpponent
+//        applies with no receiver, so the answer matches what the random
+//        sampling used to find, without the sampling.
+//        The functions only work on plain data so they can be run on a
+//        snapshot of the pitch.
+//
+//------------------------------------------------------------------------
+#include <vector>
+
+#include "2D/Vector2D.h"
+
+//What the solver needs to know about an opponent.
+struct ShotOpponent {
+
+	Vector2D m_vPos;
+	double m_dMaxSpeed;
+	double m_dBRadius;
+
+	ShotOpponent(Vector2D pos, double MaxSpeed, double radius):m_vPos(pos), m_dMaxSpeed(MaxSpeed), m_dBRadius(radius){}
+
+};
+
+//A range of y values along the goal line.
+struct ShotInterval {
+
+	double m_dLow;
+	double m_dHigh;
+
+	ShotInterval(double low, double high):m_dLow(low), m_dHigh(high){}
+
+	double Width()const { return m_dHigh - m_dLow; }
+	double Center()const { return (m_dLow + m_dHigh) * 0.5; }
+
+	bool operator<(const ShotInterval& rhs)const { return m_dLow < rhs.m_dLow; }
+
+};
+
+//Time for the ball, kicked with speed 'speed', to cover 'distance'. Same equations as SoccerBall::TimeToCoverDistance,
+//returns -1 if the ball stops short.
+double BallTimeToCover(double distance, double speed, double friction);
+
+//Fills 'open' with the intervals of the goal line x = GoalX, between MinY and MaxY, that a ball kicked from BallPos
+//with speed 'BallSpeed' reaches without any of the opponents being able to intercept it. Sorted by y.
+void GetOpenShotIntervals(Vector2D BallPos, double BallSpeed, double BallRadius, double friction, double GoalX, double MinY, double MaxY, const std::vector<ShotOpponent>& opponents, std::vector<ShotInterval>& open);
+
+//Returns the interval with the largest clearance from the blocked parts of the goal line, or NULL if there are none.
+const ShotInterval* GetBestShotInterval(const std::vector<ShotInterval>& open);
+
+#endif // SHOTSOLVER_H
@@ -1,10 +1,25 @@
 #include "2D/geometry.h"
 #include "2D/Wall2D.h"
 #include "Debug/DebugConsole.h"
+#include "misc/FastMath.h"
 #include "misc/Cgdi.h"
 #include "ParamLoader.h"
+#include "PlayerBase.h"
 #include "SoccerBall.h"
 
+//Size of the cells of the wall grid.
+const double WallCellSize = 50.0;
+
+//The most bounces resolved in one update. Whatever is left of the move after that is dropped.
+const int MaxBouncesPerUpdate = 4;
+
+SoccerBall::SoccerBall(Vector2D pos, double BallSize, double mass, std::vector<Wall2D>& PitchBoundary) :
+	MovingEntity(pos, BallSize, Vector2D(0, 0), -1.0, Vector2D(0, 1), mass, Vector2D(1.0, 1.0), 0, 0), m_PitchBoundary(PitchBoundary), m_bDeferTouches(false), m_dPendingKickerDistSq(0.0), m_iNumPendingKicks(0), m_bPendingTrap(false), m_iNumTouches(0) {
+
+	m_WallGrid.Build(m_PitchBoundary, WallCellSize, BallSize);
+
+}
+
 //---------------------------------FuturePosition----------------------------------
 //
 // Given a time this method returns the ball position at that time in the future.
@@ -37,21 +52,27 @@ Vector2D SoccerBall::FuturePosition(double time)const {
 //----------------------------------------------------------------------------------
 double SoccerBall::TimeToCoverDistance(Vector2D A, Vector2D B, double force)const {
 
+	return TimeToCoverDistance(A, B, force, m_dMass);
+
+}
+
+double SoccerBall::TimeToCoverDistance(Vector2D A, Vector2D B, double force, double mass) {
+
 	//This will be the velocity of the ball in the next time step IF the player was to make the pass.
-	double speed = force / m_dMass;
+	double speed = force / mass;
 
 	//Calculates the velocity at B using the equation:
 	//
 	//v^2 = u^2 + 2as
 	
 	//First calculate s (distance between the two positions)
-	double DistanceToCover = Vec2DDistance(A, B);
+	double DistanceToCover = FastMath::Distance(A, B);
 	double term = speed * speed + 2.0 * DistanceToCover * Prm.Friction;
 
 	//If (u^2 + 2as) is negative it means the ball cannot reach point B.
 	if (term <= 0.0) return -1.0;
 
-	double v = sqrt(term);
+	double v = FastMath::Sqrt(term);
 
 	//It is possible for the ball to reach B and we know its speed when it gets there,
 	//so now it's easy to calculate the time using the equation:
@@ -101,7 +122,7 @@ void SoccerBall::TestCollisionWithWalls(const std::vector<Wall2D>& walls) {
 		
 		//Check to make sure the intersection point is actually on the line segment.
 		bool OnLineSegment = false;
-		if (LineIntersection2D(walls[w].From(), walls[w].To(), ThisCollisionPoint - walls[w].Normal()*20.0, ThisCollisionPoint - walls[w].Normal()*20.0)) OnLineSegment = true;
+		if (LineIntersection2D(walls[w].From(), walls[w].To(), ThisCollisionPoint - walls[w].Normal()*20.0, ThisCollisionPoint + walls[w].Normal()*20.0)) OnLineSegment = true;
 
 		//N.B: there is no test for collision with the end of a line segment now check to see if the collision point is within range of the velocity vector.
 		//Work in distance squared to avoid sqrt and if it's the closest hit found so far.
@@ -124,6 +145,64 @@ void SoccerBall::TestCollisionWithWalls(const std::vector<Wall2D>& walls) {
 
 }
 
+//---------------------------------MoveAndCollide-----------------------------------
+//
+// Sweeps the ball along its velocity against the walls near its path. At each contact
+// the ball is moved to the contact, its velocity is reflected and the rest of the move
+// carries on in the new direction, so a fast ball can't pass through a wall and can
+// bounce more than once in an update (into a corner for instance).
+//----------------------------------------------------------------------------------
+void SoccerBall::MoveAndCollide() {
+
+	Vector2D ToMove = m_vVelocity;
+
+	for (int bounce = 0; bounce <= MaxBouncesPerUpdate; ++bounce) {
+
+		Vector2D destination = m_vPosition + ToMove;
+
+		m_WallGrid.Query(Vector2D(MinOf(m_vPosition.x, destination.x), MinOf(m_vPosition.y, destination.y)), Vector2D(MaxOf(m_vPosition.x, destination.x), MaxOf(m_vPosition.y, destination.y)), m_NearbyWalls);
+
+		//Find the first wall the ball touches.
+		double FirstT = MaxDouble;
+		Vector2D FirstNormal;
+
+		for (unsigned int w = 0; w < m_NearbyWalls.size(); ++w) {
+
+			const Wall2D& wall = m_PitchBoundary[m_NearbyWalls[w]];
+
+			double t;
+			Vector2D normal;
+
+			if (SweptCircleSegmentIntersection(m_vPosition, ToMove, BRadius(), wall.From(), wall.To(), t, normal) && (t < FirstT)) {
+
+				FirstT = t;
+				FirstNormal = normal;
+
+			}
+
+		}
+
+		if (FirstT == MaxDouble) {
+
+			m_vPosition = destination;
+			return;
+
+		}
+
+		//Move to the contact and bounce what is left of the move.
+		m_vPosition += ToMove * FirstT;
+
+		ToMove *= 1.0 - FirstT;
+		ToMove.Reflect(FirstNormal);
+		m_vVelocity.Reflect(FirstNormal);
+
+		//Out of bounces, the ball stops at the last contact for this update.
+		if (bounce == MaxBouncesPerUpdate) return;
+
+	}
+
+}
+
 //---------------------------------AddNoiseToKick-----------------------------------
 //
 // This can be used to vary the accuracy of a player's kick. Just call it prior to kicking
@@ -145,7 +224,9 @@ Vector2D SoccerBall::AddNoiseToKick(Vector2D BallPos, Vector2D BallTarget) {
 // velocity to make sure it doesn't exceed the max allowable.
 //
 //----------------------------------------------------------------------------------
-void SoccerBall::Kick(Vector2D direction, double force) {
+void SoccerBall::Kick(Vector2D direction, double force, const PlayerBase* kicker) {
+
+	++m_iNumTouches;
 
 	//Ensure direction is normalized
 	direction.Normalize();
@@ -153,11 +234,55 @@ void SoccerBall::Kick(Vector2D direction, double force) {
 	//Calculate the acceleration
 	Vector2D acceleration = (direction * force) / m_dMass;
 
+	if (m_bDeferTouches) {
+
+		//Kicks that meet in the same update would cancel out if they were added up, so the
+		//player closest to the ball gets to it first.
+		double DistSq = Vec2DDistanceSq(kicker->Pos(), Pos());
+
+		if ((m_iNumPendingKicks == 0) || (DistSq < m_dPendingKickerDistSq)) {
+
+			m_vPendingKick = acceleration;
+			m_dPendingKickerDistSq = DistSq;
+
+		}
+
+		++m_iNumPendingKicks;
+		return;
+
+	}
+
 	//Update the velocity
 	m_vVelocity = acceleration;
 
 }
 
+//-----------------------------------------Trap------------------------------------
+//----------------------------------------------------------------------------------
+void SoccerBall::Trap() {
+
+	++m_iNumTouches;
+
+	if (m_bDeferTouches) m_bPendingTrap = true;
+	else m_vVelocity.Zero();
+
+}
+
+//------------------------------------CommitTouches--------------------------------
+//----------------------------------------------------------------------------------
+void SoccerBall::CommitTouches() {
+
+	if (m_bPendingTrap) m_vVelocity.Zero();
+
+	if (m_iNumPendingKicks > 0) m_vVelocity = m_vPendingKick;
+
+	m_bDeferTouches = false;
+	m_vPendingKick.Zero();
+	m_iNumPendingKicks = 0;
+	m_bPendingTrap = false;
+
+}
+
 //--------------------------------PlaceAtLocation----------------------------------
 //
 // Positions the ball at the desired location and sets the ball's velocity to zero.
@@ -178,22 +303,48 @@ void SoccerBall::PlaceAtPosition(Vector2D NewPos) {
 //----------------------------------------------------------------------------------
 void SoccerBall::Update() {
 
+	BeginUpdate();
+
+	//Simulate Prm.Friction. Make sure the speed is positive
+	if (!IsAtRest()) {
+
+		m_vVelocity += Vec2DNormalize(m_vVelocity) * Prm.Friction;
+
+		FinishUpdate();
+
+	}
+
+}
+
+//------------------------------------IsAtRest-------------------------------------
+//----------------------------------------------------------------------------------
+bool SoccerBall::IsAtRest()const {
+
+	return m_vVelocity.LengthSq() <= Prm.Friction * Prm.Friction;
+
+}
+
+//-----------------------------------BeginUpdate-----------------------------------
+//----------------------------------------------------------------------------------
+void SoccerBall::BeginUpdate() {
+
 	//Keep a record of the old position so the goal::scored method can used it for goal testing
 	m_vOldPos = m_vPosition;
 
 	//Tests for collisions
-	TestCollisionWithWalls(m_PitchBoundary);
+	if (!Prm.bContinuousBallCollision) TestCollisionWithWalls(m_PitchBoundary);
 
-	//Simulate Prm.Friction. Make sure the speed is positive
-	if (m_vVelocity.LengthSq() > Prm.Friction * Prm.Friction) {
+}
 
-		m_vVelocity += Vec2DNormalize(m_vVelocity) * Prm.Friction;
-		m_vPosition += m_vVelocity;
+//-----------------------------------FinishUpdate----------------------------------
+//----------------------------------------------------------------------------------
+void SoccerBall::FinishUpdate() {
 
-		//Update heading
-		m_vHeading = Vec2DNormalize(m_vVelocity);
+	if (Prm.bContinuousBallCollision) MoveAndCollide();
+	else m_vPosition += m_vVelocity;
 
-	}
+	//Update heading
+	m_vHeading = Vec2DNormalize(m_vVelocity);
 
 }
 
@@ -11,6 +11,7 @@
 //------------------------------------------------------------------------
 #include <vector>
 
+#include "2D/WallBroadphase.h"
 #include "Game/MovingEntity.h"
 #include "constants.h"
 
@@ -29,17 +30,42 @@ private:
 	//A local reference to the Walls that make up the pitch boundary (used in the collision detection).
 	const std::vector<Wall2D>& m_PitchBoundary;
 
+	//Grid over the pitch boundary so the ball is only swept against the walls near its path.
+	WallBroadphase m_WallGrid;
+
+	//The walls returned by the last broadphase query. Kept to avoid allocations.
+	std::vector<int> m_NearbyWalls;
+
+	//While the touches are deferred, kicks and traps are collected here and only change the ball at CommitTouches.
+	//m_dPendingKickerDistSq is how far from the ball the player who made the pending kick was.
+	bool m_bDeferTouches;
+	Vector2D m_vPendingKick;
+	double m_dPendingKickerDistSq;
+	int m_iNumPendingKicks;
+	bool m_bPendingTrap;
+
+	//Number of kicks and traps since the ball was created.
+	int m_iNumTouches;
+
+	//Moves the ball along its velocity for one update, bouncing off every wall it meets on the way.
+	void MoveAndCollide();
+
 public:
 	//Tests to see if the ball has collided with a ball and reflects the ball's
 	//velocity accordingly.
 	void TestCollisionWithWalls(const std::vector<Wall2D>& walls);
 
-	SoccerBall(Vector2D pos, double BallSize, double mass, std::vector<Wall2D>& PitchBoundary) :
-		MovingEntity(pos, BallSize, Vector2D(0, 0), -1.0, Vector2D(0, 1), mass, Vector2D(1.0, 1.0), 0, 0), m_PitchBoundary(PitchBoundary){}
+	//The pitch boundary must be complete when the ball is created, it is indexed here.
+	SoccerBall(Vector2D pos, double BallSize, double mass, std::vector<Wall2D>& PitchBoundary);
 
 	//Implement base class Update
 	void Update();
 
+	//The parts of Update before and after the friction is applied, for MatchLanes to apply the friction to
+	//several balls at once. FinishUpdate moves the ball and is only called if the ball is still moving.
+	void BeginUpdate();
+	void FinishUpdate();
+
 	//Implement base class Render
 	void Render();
 
@@ -49,18 +75,35 @@ public:
 	bool HandleMessage(const Telegram& msg) { return false; }
 
 	//This method applies a directional force to the ball (kikcs it!)
-	void Kick(Vector2D direction, double force);
+	void Kick(Vector2D direction, double force, const PlayerBase* kicker);
 
 	//Given a kicking force and a distance to traverse defined by start and finish points, 
 	//this method calculates how long it will take the ball to cover the distance.
 	double TimeToCoverDistance(Vector2D from, Vector2D to, double force)const;
 
+	//The same for a ball of the given mass. Doesn't read the ball, so it can be asked from any thread.
+	static double TimeToCoverDistance(Vector2D from, Vector2D to, double force, double mass);
+
 	//This method calculates where the ball will in 'time' seconds
 	Vector2D FuturePosition(double time)const;
 
 	//This is used by players and goalkeepers to 'trap' a ball -- to stop it dead.
 	//That player is then assumed to be in possession of the ball and m_pOwner is adjusted accordingly
-	void Trap() { m_vVelocity.Zero(); }
+	void Trap();
+
+	//Holds back the kicks and traps until CommitTouches so every player deciding in between sees the same ball.
+	void DeferTouches() { m_bDeferTouches = true; }
+
+	//Applies the touches held back since DeferTouches. A trap stops the ball and, of the kicks made meanwhile,
+	//the one by the player who was closest to the ball sets it off again, the first of them if several were
+	//as close. The state machines run in a fixed order, so the kick that wins doesn't depend on the number
+	//of threads.
+	void CommitTouches();
+
+	int NumTouches()const { return m_iNumTouches; }
+
+	//True once friction has stopped the ball.
+	bool IsAtRest()const;
 
 	Vector2D OldPos()const { return m_vOldPos; }
 
@@ -1,36 +1,71 @@
+#include <functional>
+
 #include "2D/geometry.h"
 #include "2D/Transformations.h"
 #include "Debug/DebugConsole.h"
 #include "Game/EntityManager.h"
 #include "Game/Region.h"
+#include "Messaging/MessageDispatcher.h"
 #include "misc/FrameCounter.h"
+#include "misc/Stream_Utility_Functions.h"
 
 #include "Goal.h"
+#include "NonPenetrationSolver.h"
 #include "ParamLoader.h"
+#include "PitchControl.h"
 #include "PlayerBase.h"
+#include "PlayerMotion.h"
 #include "SoccerBall.h"
 #include "SoccerPitch.h"
 #include "SoccerTeam.h"
+#include "SteeringBatch.h"
+#include "SteeringBehaviors.h"
+#include "TaskGraph.h"
 #include "TeamStates.h"
+#include "ThreadPool.h"
+#include "TimeSliceScheduler.h"
 
-const int NumRegionsHorizontal = 6;
-const int NumRegionsVertical = 3;
-
-SoccerPitch::SoccerPitch(int cx, int cy) : m_cxClient(cx), m_cyClient(cy), m_bPaused(false), m_bGoalKeeperHasBall(false), m_Regions(NumRegionsHorizontal * NumRegionsVertical), m_bGameOn(true) {
+SoccerPitch::SoccerPitch(int cx, int cy) : m_Regions(Prm.NumRegionsHorizontal * Prm.NumRegionsVertical), m_iRegionsHorizontal(Prm.NumRegionsHorizontal), m_iRegionsVertical(Prm.NumRegionsVertical), m_bGoalKeeperHasBall(false), m_bGameOn(true), m_bPaused(false), m_iTick(0), m_iMatchStartTick(0), m_iBallTouches(0), m_iUntouchedTicks(0), m_iLongestUntouched(0), m_cxClient(cx), m_cyClient(cy) {
 
 	//Define the playing area.
 	m_pPlayingArea = new Region(20, 20, cx - 20, cy - 20);
 
+	//The decisions are made every so many physics updates.
+	m_iDecisionInterval = 1;
+	if ((Prm.DecisionRate > 0.0) && (Prm.DecisionRate < Prm.FrameRate)) m_iDecisionInterval = (int)(Prm.FrameRate / Prm.DecisionRate + 0.5);
+
 	//Create the regions.
-	CreateRegions(PlayingArea()->Width() / (double)NumRegionsHorizontal, PlayingArea()->Height() / (double)NumRegionsVertical);
+	CreateRegions(PlayingArea()->Width() / (double)m_iRegionsHorizontal, PlayingArea()->Height() / (double)m_iRegionsVertical);
+	CalculateRegionNeighbours();
 
 	//Create the goals.
-	m_pRedGoal = new Goal(Vector2D(m_pPlayingArea->Left(), (cy - Prm.GoalWidth) / 2), Vector2D(m_pPlayingArea->Left(), (cy - Prm.GoalWidth) / 2), Vector2D(1, 0));
-	m_pBlueGoal = new Goal(Vector2D(m_pPlayingArea->Right(), (cy - Prm.GoalWidth) / 2), Vector2D(m_pPlayingArea->Right(), (cy - Prm.GoalWidth) / 2), Vector2D(-1, 0));
+	m_pRedGoal = new Goal(Vector2D(m_pPlayingArea->Left(), (cy - Prm.GoalWidth) / 2), Vector2D(m_pPlayingArea->Left(), cy - (cy - Prm.GoalWidth) / 2), Vector2D(1, 0));
+	m_pBlueGoal = new Goal(Vector2D(m_pPlayingArea->Right(), (cy - Prm.GoalWidth) / 2), Vector2D(m_pPlayingArea->Right(), cy - (cy - Prm.GoalWidth) / 2), Vector2D(-1, 0));
+
+	//Create the walls. The ball indexes them when it is created so they come first.
+	Vector2D TopLeft(m_pPlayingArea->Left(), m_pPlayingArea->Top());
+	Vector2D TopRight(m_pPlayingArea->Right(), m_pPlayingArea->Top());
+	Vector2D BottomLeft(m_pPlayingArea->Left(), m_pPlayingArea->Bottom());
+	Vector2D BottomRight(m_pPlayingArea->Right(), m_pPlayingArea->Bottom());
+
+	m_vecWalls.push_back(Wall2D(BottomLeft, m_pRedGoal->RightPost()));
+	m_vecWalls.push_back(Wall2D(m_pRedGoal->LeftPost(), TopLeft));
+	m_vecWalls.push_back(Wall2D(TopLeft, TopRight));
+	m_vecWalls.push_back(Wall2D(TopRight, m_pBlueGoal->LeftPost()));
+	m_vecWalls.push_back(Wall2D(m_pBlueGoal->RightPost(), BottomRight));
+	m_vecWalls.push_back(Wall2D(BottomRight, BottomLeft));
 
 	//Create the soccer ball.
 	m_pBall = new SoccerBall(Vector2D((double)m_cxClient / 2.0, (double)m_cyClient / 2.0), Prm.BallSize, Prm.BallMass, m_vecWalls);
 
+	//Create the time slice scheduler. The teams' jobs take themselves off it when they are deleted, so it
+	//has to outlive them.
+	m_pTimeSlicer = new TimeSliceScheduler(Prm.TimeSliceBudget);
+
+	//Start the support spot scans' thread. It lasts as long as the pitch so a scan doesn't have to start one.
+	m_pScanPool = NULL;
+	if (Prm.bAsyncSupportSpots) m_pScanPool = new ThreadPool(1);
+
 	//Create the teams.
 	m_pRedTeam = new SoccerTeam(m_pRedGoal, m_pBlueGoal, this, SoccerTeam::red);
 	m_pBlueTeam = new SoccerTeam(m_pBlueGoal, m_pRedGoal, this, SoccerTeam::blue);
@@ -39,18 +74,46 @@ SoccerPitch::SoccerPitch(int cx, int cy) : m_cxClient(cx), m_cyClient(cy), m_bPa
 	m_pRedTeam->SetOpponents(m_pBlueTeam);
 	m_pBlueTeam->SetOpponents(m_pRedTeam);
 
-	//Create the walls.
-	Vector2D TopLeft(m_pPlayingArea->Left(), m_pPlayingArea->Top());
-	Vector2D TopRight(m_pPlayingArea->Right(), m_pPlayingArea->Top());
-	Vector2D BottomLeft(m_pPlayingArea->Left(), m_pPlayingArea->Bottom());
-	Vector2D BottomRight(m_pPlayingArea->Right(), m_pPlayingArea->Bottom());
+	//Create the pitch control map.
+	m_pPitchControl = new PitchControl(this, Prm.PitchControlCellsX, Prm.PitchControlCellsY);
 
-	m_vecWalls.push_back(Wall2D(BottomLeft, m_pRedGoal->RightPost()));
-	m_vecWalls.push_back(Wall2D(m_pRedGoal->LeftPost(), TopLeft));
-	m_vecWalls.push_back(Wall2D(TopLeft, TopRight));
-	m_vecWalls.push_back(Wall2D(TopRight, m_pBlueGoal->LeftPost()));
-	m_vecWalls.push_back(Wall2D(m_pBlueGoal->RightPost(), BottomRight));
-	m_vecWalls.push_back(Wall2D(BottomRight, BottomLeft));
+	//Create the non-penetration solver.
+	m_pNonPenetrationSolver = new NonPenetrationSolver(this);
+
+	m_Players.insert(m_Players.end(), m_pRedTeam->Members().begin(), m_pRedTeam->Members().end());
+	m_Players.insert(m_Players.end(), m_pBlueTeam->Members().begin(), m_pBlueTeam->Members().end());
+
+	//Only start threads if the players are to steer on more than one.
+	m_pUpdatePool = NULL;
+	if (Prm.bDoubleBufferedUpdate && (Prm.NumUpdateThreads > 1)) m_pUpdatePool = new ThreadPool(Prm.NumUpdateThreads);
+
+	m_pSteeringBatch = NULL;
+	if (Prm.bDoubleBufferedUpdate && Prm.bBatchSteering) m_pSteeringBatch = new SteeringBatch(this);
+
+	m_pFieldPlayerMotion = NULL;
+	m_pGoalKeeperMotion = NULL;
+
+	if (Prm.bDoubleBufferedUpdate && Prm.bBatchMotion) {
+
+		for (unsigned int p = 0; p < m_Players.size(); ++p) {
+
+			if (m_Players[p]->Role() == PlayerBase::goal_keeper) m_GoalKeepers.push_back(m_Players[p]);
+			else m_FieldPlayers.push_back(m_Players[p]);
+
+		}
+
+		m_pFieldPlayerMotion = new PlayerMotion((int)m_FieldPlayers.size());
+		m_pGoalKeeperMotion = new PlayerMotion((int)m_GoalKeepers.size());
+
+	}
+
+	m_pTickGraph = NULL;
+	if (Prm.bDoubleBufferedUpdate && Prm.bTaskGraphUpdate) BuildTickGraph();
+
+	//Count the players in their starting regions.
+	UpdateRegionOccupancy();
+
+	ResetSleep();
 
 	ParamLoader* p = ParamLoader::Instance();
 
@@ -58,16 +121,37 @@ SoccerPitch::SoccerPitch(int cx, int cy) : m_cxClient(cx), m_cyClient(cy), m_bPa
 
 SoccerPitch::~SoccerPitch() {
 
+	//A background scan reads its team and the spots it scores, so stop both before anything is deleted.
+	m_pRedTeam->CancelSupportSpotScan();
+	m_pBlueTeam->CancelSupportSpotScan();
+
+	delete m_pScanPool;
+
 	delete m_pBall;
 
 	delete m_pRedTeam;
 	delete m_pBlueTeam;
 
+	delete m_pTimeSlicer;
+
 	delete m_pRedGoal;
 	delete m_pBlueGoal;
 
 	delete m_pPlayingArea;
 
+	delete m_pPitchControl;
+
+	delete m_pNonPenetrationSolver;
+
+	delete m_pTickGraph;
+
+	delete m_pSteeringBatch;
+
+	delete m_pFieldPlayerMotion;
+	delete m_pGoalKeeperMotion;
+
+	delete m_pUpdatePool;
+
 	for (unsigned int i = 0; i < m_Regions.size(); ++i) delete m_Regions[i];
 
 }
@@ -82,19 +166,56 @@ void SoccerPitch::Update() {
 
 	if (m_bPaused) return;
 
-	static int tick = 0;
+	++m_iTick;
+
+	if (m_pTickGraph) RunTickGraph();
+	else {
+
+		//Update the balls.
+		m_pBall->Update();
 
-	//Update the balls.
-	m_pBall->Update();
+		//Update the teams.
+		if (Prm.bDoubleBufferedUpdate) UpdatePlayersBuffered();
+		else {
+			m_pRedTeam->Update();
+			m_pBlueTeam->Update();
+		}
 
-	//Update the teams.
-	m_pRedTeam->Update();
-	m_pBlueTeam->Update();
+	}
+
+	EndUpdate();
+
+}
+
+//------------------------------------EndUpdate-------------------------------------
+//
+// What is left of an update once the ball and the players have moved.
+//-----------------------------------------------------------------------------------
+void SoccerPitch::EndUpdate() {
+
+	//Enforce a non-penetration constraint if desired.
+	if (Prm.bNonPenetrationConstraint) m_pNonPenetrationSolver->Solve();
+
+	//The players have finished moving for this tick.
+	UpdateRegionOccupancy();
+	UpdateSleep();
+
+	//Spend what is left of the update on the work spread over several updates.
+	m_pTimeSlicer->Run();
+
+	//Keep track of how long the ball has gone without being touched.
+	if ((m_pBall->NumTouches() != m_iBallTouches) || !m_bGameOn) m_iUntouchedTicks = 0;
+	else ++m_iUntouchedTicks;
+
+	m_iLongestUntouched = MaxOf(m_iLongestUntouched, m_iUntouchedTicks);
+
+	m_iBallTouches = m_pBall->NumTouches();
 
 	//If a goal has been detected reset the pitch ready for kickoff.
 	if (m_pBlueGoal->Scored(m_pBall) || m_pRedGoal->Scored(m_pBall)) {
 
 		m_bGameOn = false;
+		m_bGoalKeeperHasBall = false;
 
 		//Reset the ball.
 		m_pBall->PlaceAtPosition(Vector2D((double)m_cxClient / 2.0, (double)m_cyClient / 2.0));
@@ -107,24 +228,542 @@ void SoccerPitch::Update() {
 
 }
 
+//-------------------------------UpdatePlayersBuffered-------------------------------
+//
+// The players think and steer from the positions at the start of the update and from the
+// ball as it was before any of them touched it. The moves and the kicks are held back
+// until all of them have been updated, so red no longer gets to move before blue and the
+// order of the players within a team doesn't matter either.
+//-----------------------------------------------------------------------------------
+void SoccerPitch::UpdatePlayersBuffered() {
+
+	ThinkPlayers();
+
+	//Batched moves need every force first.
+	if (m_pFieldPlayerMotion) {
+
+		CalculateSteeringForces();
+		MovePlayers();
+
+		CommitPlayers();
+
+		return;
+
+	}
+
+	//Batched forces are worked out up front. Steer then picks them up.
+	if (m_pSteeringBatch) m_pSteeringBatch->Calculate();
+
+	//Steering only writes to the player doing it, so the players can steer at the same time.
+	if (m_pUpdatePool) {
+
+		int NumPlayers = (int)m_Players.size();
+		int NumWorkers = m_pUpdatePool->NumWorkers();
+
+		for (int w = 0; w < NumWorkers; ++w) m_pUpdatePool->Submit(std::bind(&SoccerPitch::SteerPlayers, this, w * NumPlayers / NumWorkers, (w + 1) * NumPlayers / NumWorkers));
+
+		m_pUpdatePool->WaitForAll();
+
+	}
+	else SteerPlayers(0, (int)m_Players.size());
+
+	CommitPlayers();
+
+}
+
+//-----------------------------------ThinkPlayers-----------------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::ThinkPlayers() {
+
+	m_pBall->DeferTouches();
+
+	m_pRedTeam->BeginTick();
+	m_pBlueTeam->BeginTick();
+
+	//The state machines send each other messages so they still run one at a time.
+	m_pRedTeam->Think();
+	m_pBlueTeam->Think();
+
+}
+
+//------------------------------CalculateSteeringForces-----------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::CalculateSteeringForces() {
+
+	if (m_pSteeringBatch) m_pSteeringBatch->Calculate();
+	else {
+		for (unsigned int p = 0; p < m_Players.size(); ++p) m_Players[p]->Steering()->Calculate();
+	}
+
+}
+
+//-----------------------------------SteerPlayers-----------------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::SteerPlayers(int first, int last) {
+
+	for (int p = first; p < last; ++p) m_Players[p]->Steer();
+
+}
+
+//-----------------------------------MovePlayers------------------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::MovePlayers() {
+
+	PlayerMotion::integration how = Prm.bFastMotion ? PlayerMotion::fast : PlayerMotion::reference;
+
+	//The sleeping field players are left out of the set, so they are neither loaded nor integrated.
+	m_AwakeFieldPlayers.clear();
+
+	for (unsigned int p = 0; p < m_FieldPlayers.size(); ++p) {
+		if (m_FieldPlayers[p]->IsAsleep()) m_FieldPlayers[p]->HoldStill();
+		else m_AwakeFieldPlayers.push_back(p);
+	}
+
+	for (unsigned int a = 0; a < m_AwakeFieldPlayers.size(); ++a) m_pFieldPlayerMotion->Load(a, m_FieldPlayers[m_AwakeFieldPlayers[a]]);
+	for (unsigned int p = 0; p < m_GoalKeepers.size(); ++p) m_pGoalKeeperMotion->Load(p, m_GoalKeepers[p]);
+
+	m_pFieldPlayerMotion->SetCount((int)m_AwakeFieldPlayers.size());
+
+	m_pFieldPlayerMotion->IntegrateFieldPlayers(how);
+	m_pGoalKeeperMotion->IntegrateGoalKeepers(how);
+
+	for (unsigned int a = 0; a < m_AwakeFieldPlayers.size(); ++a) m_pFieldPlayerMotion->Store(a, m_FieldPlayers[m_AwakeFieldPlayers[a]]);
+	for (unsigned int p = 0; p < m_GoalKeepers.size(); ++p) m_pGoalKeeperMotion->Store(p, m_GoalKeepers[p]);
+
+}
+
+//-----------------------------------CommitPlayers----------------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::CommitPlayers() {
+
+	for (unsigned int p = 0; p < m_Players.size(); ++p) m_Players[p]->CommitMove();
+
+	m_pRedTeam->EndTick();
+	m_pBlueTeam->EndTick();
+
+	m_pBall->CommitTouches();
+
+}
+
+//----------------------------------BuildTickGraph----------------------------------
+//
+// The same update as UpdatePlayersBuffered, split into tasks. The ball, the pitch
+// control map, the pass safety fields and the support spots only read the positions
+// the players start the update with, so they are worked out side by side before the
+// state machines run. Each team's support spots wait for its pass safety field and
+// the pitch control map because they are scored from them, and are scored again later
+// if a state machine changes an opponent's top speed first. The state machines still
+// run one after the other on the main thread, then every player steers as a task of
+// its own and the moves are committed together. Batched forces or moves take the
+// place of the tasks of the single players.
+//-----------------------------------------------------------------------------------
+void SoccerPitch::BuildTickGraph() {
+
+	m_pTickGraph = new TaskGraph();
+
+	int ball = m_pTickGraph->AddTask("ball", std::bind(&SoccerBall::Update, m_pBall));
+	int control = m_pTickGraph->AddTask("pitch control", std::bind(&SoccerPitch::UpdatePitchControl, this));
+
+	int RedClosest = m_pTickGraph->AddTask("red closest to ball", std::bind(&SoccerTeam::BeginTick, m_pRedTeam));
+	int BlueClosest = m_pTickGraph->AddTask("blue closest to ball", std::bind(&SoccerTeam::BeginTick, m_pBlueTeam));
+	int RedSafety = m_pTickGraph->AddTask("red pass safety", std::bind(&SoccerTeam::UpdatePassSafety, m_pRedTeam));
+	int BlueSafety = m_pTickGraph->AddTask("blue pass safety", std::bind(&SoccerTeam::UpdatePassSafety, m_pBlueTeam));
+	int RedSpots = m_pTickGraph->AddTask("red support spots", std::bind(&SoccerTeam::PrescoreSupportSpots, m_pRedTeam));
+	int BlueSpots = m_pTickGraph->AddTask("blue support spots", std::bind(&SoccerTeam::PrescoreSupportSpots, m_pBlueTeam));
+
+	m_pTickGraph->AddDependency(ball, RedClosest);
+	m_pTickGraph->AddDependency(ball, BlueClosest);
+	m_pTickGraph->AddDependency(ball, RedSafety);
+	m_pTickGraph->AddDependency(ball, BlueSafety);
+	m_pTickGraph->AddDependency(RedSafety, RedSpots);
+	m_pTickGraph->AddDependency(BlueSafety, BlueSpots);
+	m_pTickGraph->AddDependency(control, RedSpots);
+	m_pTickGraph->AddDependency(control, BlueSpots);
+
+	std::vector<int> ready;
+	ready.push_back(RedClosest);
+	ready.push_back(BlueClosest);
+	ready.push_back(RedSpots);
+	ready.push_back(BlueSpots);
+
+	int RedThought = AddThinkTasks(m_pRedTeam, "red", ready);
+	int thought = AddThinkTasks(m_pBlueTeam, "blue", std::vector<int>(1, RedThought));
+
+	//A player can be given a new target by any state machine, so steering waits for all of them.
+	//Batched forces are worked out in one task the players' steering waits for in turn.
+	if (m_pSteeringBatch) {
+
+		int forces = m_pTickGraph->AddTask("steering forces", std::bind(&SteeringBatch::Calculate, m_pSteeringBatch));
+		m_pTickGraph->AddDependency(thought, forces);
+
+		thought = forces;
+
+	}
+
+	std::vector<int> steer;
+
+	if (m_pFieldPlayerMotion) {
+
+		//Batched moves wait for the force of every player.
+		std::vector<int> forces(1, thought);
+
+		if (!m_pSteeringBatch) {
+
+			forces.clear();
+
+			for (unsigned int p = 0; p < m_Players.size(); ++p) {
+
+				forces.push_back(m_pTickGraph->AddTask("steering force " + ttos(p), std::bind(&SteeringBehaviors::Calculate, m_Players[p]->Steering())));
+				m_pTickGraph->AddDependency(thought, forces.back());
+
+			}
+
+		}
+
+		int move = m_pTickGraph->AddTask("move players", std::bind(&SoccerPitch::MovePlayers, this));
+
+		for (unsigned int f = 0; f < forces.size(); ++f) m_pTickGraph->AddDependency(forces[f], move);
+
+		steer.push_back(move);
+
+	}
+
+	else {
+
+		for (unsigned int p = 0; p < m_Players.size(); ++p) {
+
+			steer.push_back(m_pTickGraph->AddTask("steer " + ttos(p), std::bind(&PlayerBase::Steer, m_Players[p])));
+			m_pTickGraph->AddDependency(thought, steer.back());
+
+		}
+
+	}
+
+	int commit = m_pTickGraph->AddTask("commit", std::bind(&SoccerPitch::CommitPlayers, this), true);
+
+	for (unsigned int s = 0; s < steer.size(); ++s) m_pTickGraph->AddDependency(steer[s], commit);
+
+}
+
+//-----------------------------------AddThinkTasks----------------------------------
+//-----------------------------------------------------------------------------------
+int SoccerPitch::AddThinkTasks(SoccerTeam* team, const std::string& name, const std::vector<int>& after) {
+
+	int last = m_pTickGraph->AddTask(name + " team", std::bind(&SoccerTeam::UpdateStateMachine, team), true);
+
+	for (unsigned int a = 0; a < after.size(); ++a) m_pTickGraph->AddDependency(after[a], last);
+
+	for (unsigned int p = 0; p < team->Members().size(); ++p) {
+
+		int think = m_pTickGraph->AddTask(name + " think " + ttos(p), std::bind(&PlayerBase::Think, team->Members()[p]), true);
+		m_pTickGraph->AddDependency(last, think);
+
+		last = think;
+
+	}
+
+	return last;
+
+}
+
+//------------------------------------RunTickGraph----------------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::RunTickGraph() {
+
+	m_pBall->DeferTouches();
+
+	m_pRedTeam->PlanSupportSpots();
+	m_pBlueTeam->PlanSupportSpots();
+
+	m_pTickGraph->Run(m_pUpdatePool);
+
+}
+
+//---------------------------------UpdatePitchControl-------------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::UpdatePitchControl() {
+
+	if ((Prm.Spot_PitchControlScore > 0.0) && (m_pRedTeam->PrescoringSupportSpots() || m_pBlueTeam->PrescoringSupportSpots())) m_pPitchControl->Refresh();
+
+}
+
+//----------------------------------WriteTickGraph----------------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::WriteTickGraph(std::ostream& os) {
+
+	if (m_pTickGraph) {
+		m_pTickGraph->WriteDot(os, "SoccerPitch::Update");
+		return;
+	}
+
+	//Build one just to write it out. The updates carry on the way the parameters ask for.
+	BuildTickGraph();
+	m_pTickGraph->WriteDot(os, "SoccerPitch::Update");
+
+	delete m_pTickGraph;
+	m_pTickGraph = NULL;
+
+}
+
+//--------------------------------------Reset---------------------------------------
+//
+// The tick count carries on from the last match so that nothing stamped during it is
+// taken for this match's data. MatchTicks counts from here.
+//-----------------------------------------------------------------------------------
+void SoccerPitch::Reset() {
+
+	m_bPaused = false;
+	m_bGameOn = true;
+	m_bGoalKeeperHasBall = false;
+
+	m_iMatchStartTick = m_iTick;
+
+	m_iBallTouches = m_pBall->NumTouches();
+	m_iUntouchedTicks = 0;
+	m_iLongestUntouched = 0;
+
+	m_pRedGoal->ResetGoalsScored();
+	m_pBlueGoal->ResetGoalsScored();
+
+	//Forget any messages from the last match still waiting to be sent.
+	Dispatcher->ClearDelayedMessages();
+
+	//And any work the last match left unfinished.
+	m_pTimeSlicer->CancelAll();
+	m_pTimeSlicer->ResetStatistics();
+
+	//The ball goes first because the goalkeepers look at it when they are reset.
+	m_pBall->PlaceAtPosition(Vector2D((double)m_cxClient / 2.0, (double)m_cyClient / 2.0));
+
+	m_pRedTeam->Reset();
+	m_pBlueTeam->Reset();
+
+	UpdateRegionOccupancy();
+
+	ResetSleep();
+
+}
+
+//------------------------------------RedScore/BlueScore-----------------------------
+//-----------------------------------------------------------------------------------
+int SoccerPitch::RedScore()const { return m_pBlueGoal->NumGoalsScored(); }
+
+int SoccerPitch::BlueScore()const { return m_pRedGoal->NumGoalsScored(); }
+
 //----------------------------------CreateRegions-----------------------------------
+//
+// The regions are numbered from the bottom right corner of the playing area, up each
+// column and then one column to the left.
 //-----------------------------------------------------------------------------------
 void SoccerPitch::CreateRegions(double width, double height) {
 
-	//Index into the vector.
-	int idx = m_Regions.size() - 1;
-	
-	for (int col = 0; col < NumRegionsHorizontal; ++col) {
+	m_dRegionWidth = width;
+	m_dRegionHeight = height;
+
+	for (int col = 0; col < m_iRegionsHorizontal; ++col) {
+
+		for (int row = 0; row < m_iRegionsVertical; ++row) {
+
+			int idx = (int)m_Regions.size() - 1 - (col * m_iRegionsVertical + row);
+
+			m_Regions[idx] = new Region(PlayingArea()->Left() + col * width,
+				PlayingArea()->Top() + row * height,
+				PlayingArea()->Left() + (col + 1) * width,
+				PlayingArea()->Top() + (row + 1) * height, idx);
 
-		for (int row = 0; row < NumRegionsVertical; ++row) m_Regions[idx--] = new Region(PlayingArea()->Left() + col * width,
-			PlayingArea()->Top() + row * height,
-			PlayingArea()->Left() + (col + 1) * width,
-			PlayingArea()->Top() + (row + 1) * height, idx);
+		}
 
 	}
 
 }
 
+//------------------------------CalculateRegionNeighbours----------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::CalculateRegionNeighbours() {
+
+	m_RegionNeighbours.assign(m_Regions.size(), std::vector<int>());
+
+	for (int col = 0; col < m_iRegionsHorizontal; ++col) {
+
+		for (int row = 0; row < m_iRegionsVertical; ++row) {
+
+			int idx = (int)m_Regions.size() - 1 - (col * m_iRegionsVertical + row);
+
+			for (int x = MaxOf(col - 1, 0); x <= MinOf(col + 1, m_iRegionsHorizontal - 1); ++x) {
+
+				for (int y = MaxOf(row - 1, 0); y <= MinOf(row + 1, m_iRegionsVertical - 1); ++y) {
+
+					if ((x != col) || (y != row)) m_RegionNeighbours[idx].push_back((int)m_Regions.size() - 1 - (x * m_iRegionsVertical + y));
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+//------------------------------RegionIndexFromPosition------------------------------
+//-----------------------------------------------------------------------------------
+int SoccerPitch::RegionIndexFromPosition(Vector2D pos)const {
+
+	int col = (int)((pos.x - m_pPlayingArea->Left()) / m_dRegionWidth);
+	int row = (int)((pos.y - m_pPlayingArea->Top()) / m_dRegionHeight);
+
+	if (col < 0) col = 0;
+	if (col > m_iRegionsHorizontal - 1) col = m_iRegionsHorizontal - 1;
+	if (row < 0) row = 0;
+	if (row > m_iRegionsVertical - 1) row = m_iRegionsVertical - 1;
+
+	return (int)m_Regions.size() - 1 - (col * m_iRegionsVertical + row);
+
+}
+
+//-------------------------------UpdateRegionOccupancy-------------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::UpdateRegionOccupancy() {
+
+	m_RedOccupancy.assign(m_Regions.size(), 0);
+	m_BlueOccupancy.assign(m_Regions.size(), 0);
+
+	m_PlayerRegion.resize(m_Players.size());
+
+	for (unsigned int p = 0; p < m_Players.size(); ++p) {
+
+		m_PlayerRegion[p] = RegionIndexFromPosition(m_Players[p]->Pos());
+
+		if (m_Players[p]->Team() == m_pRedTeam) ++m_RedOccupancy[m_PlayerRegion[p]];
+		else ++m_BlueOccupancy[m_PlayerRegion[p]];
+
+	}
+
+	//A counting sort, so the players of a region are next to each other. Entry r + 1 of m_RegionStart starts
+	//out where region r begins and is moved on past each of its players, which leaves it where region r + 1 begins.
+	m_RegionStart.assign(m_Regions.size() + 1, 0);
+
+	for (unsigned int r = 1; r < m_Regions.size(); ++r) m_RegionStart[r + 1] = m_RegionStart[r] + m_RedOccupancy[r - 1] + m_BlueOccupancy[r - 1];
+
+	m_RegionPlayers.resize(m_Players.size());
+
+	for (unsigned int p = 0; p < m_Players.size(); ++p) m_RegionPlayers[m_RegionStart[m_PlayerRegion[p] + 1]++] = p;
+
+}
+
+//----------------------------------RegionOccupancy----------------------------------
+//-----------------------------------------------------------------------------------
+int SoccerPitch::RegionOccupancy(const SoccerTeam* team, int idx)const {
+
+	if (team->Color() == SoccerTeam::red) return m_RedOccupancy[idx];
+
+	return m_BlueOccupancy[idx];
+
+}
+
+//------------------------------------UpdateSleep------------------------------------
+//
+// A player moves if his velocity isn't zero or he was pushed since the last update.
+// Anybody moving within SleepWakeRange of an idle player could come within his view
+// distance by the next update and give him a separation force, so he is kept awake.
+// The goal keepers never sleep. The players woken by a message or by deciding to go
+// somewhere since the last update are counted as wakes here too.
+// If the regions are at least SleepWakeRange across, anybody that close is in the
+// player's region or one of its neighbours, so only those regions are searched.
+//-----------------------------------------------------------------------------------
+void SoccerPitch::UpdateSleep() {
+
+	if (!Prm.bPlayerSleep) return;
+
+	for (unsigned int p = 0; p < m_Players.size(); ++p) {
+
+		m_Moved[p] = !m_Players[p]->Velocity().isZero() || (m_Players[p]->Pos() != m_LastPositions[p]);
+		m_LastPositions[p] = m_Players[p]->Pos();
+
+	}
+
+	m_iNumAsleep = 0;
+
+	bool UseRegions = (Prm.SleepWakeRange <= m_dRegionWidth) && (Prm.SleepWakeRange <= m_dRegionHeight);
+
+	for (unsigned int p = 0; p < m_Players.size(); ++p) {
+
+		PlayerBase* player = m_Players[p];
+
+		if (m_WasAsleep[p] && !player->IsAsleep()) ++m_iWakes;
+
+		if (player->Role() != PlayerBase::goal_keeper) {
+
+			bool disturbed = m_Moved[p] || (Vec2DDistanceSq(player->Pos(), m_pBall->Pos()) < Prm.SleepBallRangeSq);
+
+			if (!disturbed && UseRegions) {
+
+				disturbed = IsMovingPlayerNear(p, m_PlayerRegion[p]);
+
+				const std::vector<int>& neighbours = m_RegionNeighbours[m_PlayerRegion[p]];
+
+				for (unsigned int n = 0; (n < neighbours.size()) && !disturbed; ++n) disturbed = IsMovingPlayerNear(p, neighbours[n]);
+
+			}
+
+			for (unsigned int q = 0; (q < m_Players.size()) && !disturbed && !UseRegions; ++q) {
+				if ((q != p) && m_Moved[q] && (Vec2DDistanceSq(player->Pos(), m_Players[q]->Pos()) < Prm.SleepWakeRangeSq)) disturbed = true;
+			}
+
+			if (player->IsAsleep() && disturbed) {
+				player->WakeUp();
+				++m_iWakes;
+			}
+			else if (!player->IsAsleep() && !disturbed && player->IsIdle()) {
+				player->PutToSleep();
+				++m_iSleeps;
+			}
+
+		}
+
+		if (player->IsAsleep()) ++m_iNumAsleep;
+
+		m_WasAsleep[p] = player->IsAsleep();
+
+	}
+
+	m_iSleepingPlayerTicks += m_iNumAsleep;
+
+}
+
+//--------------------------------IsMovingPlayerNear---------------------------------
+//-----------------------------------------------------------------------------------
+bool SoccerPitch::IsMovingPlayerNear(int p, int region)const {
+
+	for (int i = m_RegionStart[region]; i < m_RegionStart[region + 1]; ++i) {
+
+		int q = m_RegionPlayers[i];
+
+		if ((q != p) && m_Moved[q] && (Vec2DDistanceSq(m_Players[p]->Pos(), m_Players[q]->Pos()) < Prm.SleepWakeRangeSq)) return true;
+
+	}
+
+	return false;
+
+}
+
+//-------------------------------------ResetSleep------------------------------------
+//-----------------------------------------------------------------------------------
+void SoccerPitch::ResetSleep() {
+
+	m_LastPositions.resize(m_Players.size());
+	for (unsigned int p = 0; p < m_Players.size(); ++p) m_LastPositions[p] = m_Players[p]->Pos();
+
+	m_Moved.assign(m_Players.size(), false);
+	m_WasAsleep.assign(m_Players.size(), false);
+
+	m_iNumAsleep = 0;
+	m_iSleepingPlayerTicks = 0;
+	m_iSleeps = 0;
+	m_iWakes = 0;
+
+}
+
 //--------------------------------------Render--------------------------------------
 //-----------------------------------------------------------------------------------
 bool SoccerPitch::Render() {
@@ -139,6 +778,14 @@ bool SoccerPitch::Render() {
 		for (unsigned int r = 0; r < m_Regions.size(); ++r) m_Regions[r]->Render(true);
 	}
 
+	//#define SHOW_REGION_OCCUPANCY
+#ifdef SHOW_REGION_OCCUPANCY
+
+	gdi->TextColor(Cgdi::white);
+	for (unsigned int r = 0; r < m_Regions.size(); ++r) gdi->TextAtPos(m_Regions[r]->Left() + 3, m_Regions[r]->Top() + 3, ttos(m_RedOccupancy[r]) + "/" + ttos(m_BlueOccupancy[r]));
+
+#endif
+
 	//Render the goals.
 	gdi->HollowBrush();
 	gdi->RedPen();
@@ -154,6 +801,13 @@ bool SoccerPitch::Render() {
 	gdi->WhiteBrush();
 	gdi->Circle(m_pPlayingArea->Center(), 2.0);
 
+	//#define SHOW_PITCH_CONTROL
+#ifdef SHOW_PITCH_CONTROL
+
+	m_pPitchControl->Render();
+
+#endif
+
 	//Render the ball.
 	gdi->WhitePen();
 	gdi->WhiteBrush();
@@ -167,6 +821,22 @@ bool SoccerPitch::Render() {
 	gdi->WhitePen();
 	for (unsigned int w = 0; w < m_vecWalls.size(); ++w) m_vecWalls[w].Render();
 
+	//#define SHOW_SLEEP_STATS
+#ifdef SHOW_SLEEP_STATS
+
+	gdi->TextColor(Cgdi::white);
+	gdi->TextAtPos(m_cxClient - 250, 18, "Asleep: " + ttos(m_iNumAsleep) + " sleeps: " + ttos(m_iSleeps) + " wakes: " + ttos(m_iWakes));
+
+#endif
+
+	//#define SHOW_TIME_SLICE_STATS
+#ifdef SHOW_TIME_SLICE_STATS
+
+	gdi->TextColor(Cgdi::white);
+	gdi->TextAtPos(m_cxClient - 250, 3, "Slice budget used: " + ttos(m_pTimeSlicer->MeanUtilization() * 100.0, 1) + "% max: " + ttos(m_pTimeSlicer->MaxUtilization() * 100.0, 1) + "%");
+
+#endif
+
 	//Show the score
 	gdi->TextColor(Cgdi::red);
 	gdi->TextAtPos((m_cxClient / 2) - 50, m_cyClient - 18, "Red: " + ttos(m_pBlueGoal->NumGoalsScored()));
@@ -14,17 +14,28 @@
 #include <Windows.h>
 #include <vector>
 #include <cassert>
+#include <iosfwd>
+#include <string>
 
 #include "constants.h"
 #include "2D/Vector2D.h"
 #include "2D/Wall2D.h"
 
+#include "PlayerMotion.h"
+
 class Region;
 class Goal;
 class SoccerTeam;
 class SoccerBall;
 class SoccerTeam;
 class PlayBase;
+class PitchControl;
+class NonPenetrationSolver;
+class PlayerBase;
+class ThreadPool;
+class TaskGraph;
+class SteeringBatch;
+class TimeSliceScheduler;
 
 class SoccerPitch {
 
@@ -46,6 +57,61 @@ public:
 	//The playing field is broken up into regions that the team can make use of to implement strategies.
 	std::vector<Region*> m_Regions;
 
+	//Dimensions of the region grid.
+	int m_iRegionsHorizontal;
+	int m_iRegionsVertical;
+	double m_dRegionWidth;
+	double m_dRegionHeight;
+
+	//The indices of the regions sharing an edge or a corner with each region.
+	std::vector<std::vector<int> > m_RegionNeighbours;
+
+	//Number of players of each team inside each region, counted once per tick.
+	std::vector<int> m_RedOccupancy;
+	std::vector<int> m_BlueOccupancy;
+
+	//The players inside each region at the same time, as indices into m_Players. Those of region r are
+	//m_RegionPlayers[m_RegionStart[r]] up to m_RegionPlayers[m_RegionStart[r + 1]], and m_PlayerRegion[p] is
+	//the region of player p.
+	std::vector<int> m_RegionStart;
+	std::vector<int> m_RegionPlayers;
+	std::vector<int> m_PlayerRegion;
+
+	//Time-to-reach map of both teams over the playing area.
+	PitchControl* m_pPitchControl;
+
+	//Separates the overlapping players once all of them have moved.
+	NonPenetrationSolver* m_pNonPenetrationSolver;
+
+	//The players of both teams, red first.
+	std::vector<PlayerBase*> m_Players;
+
+	//Threads the players steer on during a buffered update. NULL when they steer on the calling thread.
+	ThreadPool* m_pUpdatePool;
+
+	//The tasks of one update when it is run as a graph. NULL otherwise.
+	TaskGraph* m_pTickGraph;
+
+	//Works out the steering forces of all the players together during a buffered update. NULL if the players
+	//work out their own.
+	SteeringBatch* m_pSteeringBatch;
+
+	//Moves the field players and the goal keepers during a buffered update. Entry i of the goal keepers'
+	//set is goal keeper i, entry i of the field players' set is field player m_AwakeFieldPlayers[i] since
+	//the sleeping ones are left out. NULL if the players move themselves.
+	PlayerMotion* m_pFieldPlayerMotion;
+	PlayerMotion* m_pGoalKeeperMotion;
+	std::vector<int> m_AwakeFieldPlayers;
+
+	std::vector<PlayerBase*> m_FieldPlayers;
+	std::vector<PlayerBase*> m_GoalKeepers;
+
+	//Runs the AI work that is spread over several updates, at the end of each update.
+	TimeSliceScheduler* m_pTimeSlicer;
+
+	//The thread both teams' background support spot scans run on, one at a time. NULL unless bAsyncSupportSpots is set.
+	ThreadPool* m_pScanPool;
+
 	//True if a goal keeper has possession
 	bool m_bGoalKeeperHasBall;
 
@@ -55,12 +121,77 @@ public:
 	//Set true to pause the motion
 	bool m_bPaused;
 
+	//Number of updates since the pitch was created. Used to timestamp per-tick caches.
+	int m_iTick;
+
+	//The value of m_iTick when the current match started.
+	int m_iMatchStartTick;
+
+	//The ball's touch count at the end of the last update, the number of updates in play since it last went up,
+	//and the most of those this match.
+	int m_iBallTouches;
+	int m_iUntouchedTicks;
+	int m_iLongestUntouched;
+
+	//Number of updates between two decisions of a team or a player.
+	int m_iDecisionInterval;
+
+	//Where each player was at the end of the last update, which of them have moved since, and which of them were
+	//asleep then. Entry i is player i of m_Players.
+	std::vector<Vector2D> m_LastPositions;
+	std::vector<bool> m_Moved;
+	std::vector<bool> m_WasAsleep;
+
+	//Sleep statistics. The number of players asleep at the end of the last update, the sum of those numbers
+	//over the match, and the number of times a player was put to sleep and woken.
+	int m_iNumAsleep;
+	int m_iSleepingPlayerTicks;
+	int m_iSleeps;
+	int m_iWakes;
+
 	//Local copy of client window dimensions
 	int m_cxClient, m_cyClient;
 
 	//This instantiates the regions the players used to position themselves
 	void CreateRegions(double width, double height);
 
+	//Fills m_RegionNeighbours.
+	void CalculateRegionNeighbours();
+
+	//Recounts the players in each region and sorts them by region.
+	void UpdateRegionOccupancy();
+
+	//Wakes the sleeping field players something has come near and puts the idle ones with nothing near them
+	//to sleep, if bPlayerSleep is set.
+	void UpdateSleep();
+
+	//True if a player in the region other than player p has moved since the last update and is within
+	//SleepWakeRange of him.
+	bool IsMovingPlayerNear(int p, int region)const;
+
+	//Forgets where the players were and clears the sleep statistics.
+	void ResetSleep();
+
+	//Updates the players in phases so that each of them works from the state of the pitch at the start of the update.
+	void UpdatePlayersBuffered();
+
+	//Runs the steering phase of the players from index 'first' up to, but not including, 'last'.
+	void SteerPlayers(int first, int last);
+
+	//Works out the next move of every player from his steering force, all of them together.
+	void MovePlayers();
+
+	//Builds m_pTickGraph and runs it.
+	void BuildTickGraph();
+	void RunTickGraph();
+
+	//Adds the state machine tasks of a team to the tick graph, one after the other, the first waiting
+	//for the tasks in 'after'. Returns the last one.
+	int AddThinkTasks(SoccerTeam* team, const std::string& name, const std::vector<int>& after);
+
+	//Fills the pitch control map if a team is going to use it for its support spots this tick.
+	void UpdatePitchControl();
+
 public:
 	SoccerPitch(int cxClient, int cyClient);
 	~SoccerPitch();
@@ -68,9 +199,53 @@ public:
 	void Update();
 	bool Render();
 
+	//The steps of a buffered update, for MatchLanes to run the ball and player physics of several pitches
+	//together. Update does the same as AdvanceTick, the ball's update, ThinkPlayers, CalculateSteeringForces,
+	//every player's Steer, CommitPlayers and EndUpdate, in that order.
+	void AdvanceTick() { ++m_iTick; }
+
+	//Runs the state machines of the teams and players, holding back their ball touches.
+	void ThinkPlayers();
+
+	//Works out the steering forces of the players, all of them together if they are batched.
+	void CalculateSteeringForces();
+
+	//Moves the players to where they steered to and applies the ball touches held back during a buffered update.
+	void CommitPlayers();
+
+	//Separates the players, recounts the regions and checks for a goal.
+	void EndUpdate();
+
+	//Gets the pitch ready for a new match, reusing everything that has already been created.
+	void Reset();
+
+	//Writes the tasks of an update and their dependencies in the Graphviz dot format, even if the parameters
+	//don't ask for the updates to be run as a graph.
+	void WriteTickGraph(std::ostream& os);
+
 	void TogglePause() { m_bPaused = !m_bPaused; }
 	bool Paused()const { return m_bPaused; }
 
+	int TickCount()const { return m_iTick; }
+
+	//Number of updates since the match started.
+	int MatchTicks()const { return m_iTick - m_iMatchStartTick; }
+
+	//Number of updates the game has been in play since a player last kicked or trapped the ball, and the most
+	//of them this match. A match whose ball nobody can get to again stops being touched for good.
+	int UntouchedTicks()const { return m_iUntouchedTicks; }
+	int LongestUntouched()const { return m_iLongestUntouched; }
+
+	//The teams and the players make their decisions every DecisionInterval updates. Each of them is given an
+	//offset so they don't all decide on the same update. IsDecisionTick is true on the updates the one with the
+	//given offset decides on.
+	int DecisionInterval()const { return m_iDecisionInterval; }
+	bool IsDecisionTick(int offset)const { return (m_iDecisionInterval <= 1) || ((MatchTicks() + offset) % m_iDecisionInterval == 0); }
+
+	//Goals scored by each team this match.
+	int RedScore()const;
+	int BlueScore()const;
+
 	//Various getters and setters
 	int cxClient()const { return m_cxClient; }
 	int cyClient()const { return m_cyClient; }
@@ -82,11 +257,42 @@ public:
 	const std::vector<Wall2D>& Walls() { return m_vecWalls; }
 	SoccerBall*const Ball()const { return m_pBall; }
 
+	SoccerTeam*const RedTeam()const { return m_pRedTeam; }
+	SoccerTeam*const BlueTeam()const { return m_pBlueTeam; }
+
+	const std::vector<PlayerBase*>& Players()const { return m_Players; }
+
+	PitchControl*const GetPitchControl()const { return m_pPitchControl; }
+
+	TimeSliceScheduler*const TimeSlicer()const { return m_pTimeSlicer; }
+
+	ThreadPool*const ScanPool()const { return m_pScanPool; }
+
+	int NumAsleep()const { return m_iNumAsleep; }
+	int SleepingPlayerTicks()const { return m_iSleepingPlayerTicks; }
+	int Sleeps()const { return m_iSleeps; }
+	int Wakes()const { return m_iWakes; }
+
 	const Region* const GetRegionFromIndex(int idx) {
-		assert((idx > 0) && (idx < m_Regions.size()));
+		assert((idx >= 0) && (idx < m_Regions.size()));
 		return m_Regions[idx];
 	}
 
+	int NumRegions()const { return (int)m_Regions.size(); }
+	int NumRegionsHorizontal()const { return m_iRegionsHorizontal; }
+	int NumRegionsVertical()const { return m_iRegionsVertical; }
+
+	//Index of the region containing pos, without searching. Positions outside the playing area give the nearest region.
+	int RegionIndexFromPosition(Vector2D pos)const;
+
+	const std::vector<int>& RegionNeighbours(int idx)const { return m_RegionNeighbours[idx]; }
+
+	//Number of players of the team in the region when the last update finished.
+	int RegionOccupancy(const SoccerTeam* team, int idx)const;
+
+	//Number of players of both teams in the region when the last update finished.
+	int RegionOccupancy(int idx)const { return m_RedOccupancy[idx] + m_BlueOccupancy[idx]; }
+
 	bool GameOn()const { return m_bGameOn; }
 	void SetGameOn() { m_bGameOn = true; }
 	void SetGameOff() { m_bGameOn = false; }
@@ -3,23 +3,29 @@
 #include "Debug/DebugConsole.h"
 #include "Game/EntityManager.h"
 #include "Messaging/MessageDispatcher.h"
+#include "misc/FastMath.h"
 #include "misc/utils.h"
 #include "FieldPlayer.h"
+#include "FormationLoader.h"
 #include "Goal.h"
 #include "GoalKeeper.h"
 #include "GoalKeeperStates.h"
 #include "ParamLoader.h"
+#include "PassMatrix.h"
+#include "PassSafetyField.h"
+#include "PassSearch.h"
 #include "PlayerBase.h"
 #include "SoccerMessages.h"
 #include "SoccerPitch.h"
 #include "SoccerTeam.h"
+#include "ThinkTiers.h"
 #include "SteeringBehaviors.h"
 #include "TeamStates.h"
 
 using std::vector;
 
 SoccerTeam::SoccerTeam(Goal* home_goal, Goal* opponents_goal, SoccerPitch* pitch, team_color color) :
-	m_pOpponentGoal(opponents_goal), m_pHomeGoal(home_goal), m_pOpponents(NULL), m_pPitch(pitch), m_Color(color), m_dDistSqToBallOfClosestPlayer(0.0), m_pSupportingPlayer(NULL), m_pReceivingPlayer(NULL), m_pControllingPlayer(NULL), m_pPlayerClosestToBall(NULL) {
+	m_pOpponentGoal(opponents_goal), m_pHomeGoal(home_goal), m_pOpponents(NULL), m_pPitch(pitch), m_Color(color), m_dDistSqToBallOfClosestPlayer(0.0), m_pSupportingPlayer(NULL), m_pReceivingPlayer(NULL), m_pControllingPlayer(NULL), m_pPlayerClosestToBall(NULL), m_bPrescoreSupportSpots(false), m_iNumShots(0), m_iPossessionTicks(0) {
 
 	//Setup the state machine
 	m_pStateMachine = new StateMachine<SoccerTeam>(this);
@@ -37,6 +43,18 @@ SoccerTeam::SoccerTeam(Goal* home_goal, Goal* opponents_goal, SoccerPitch* pitch
 	//Create the sweet spot calculator.
 	m_pSupportSpotCalc = new SupportSpotCalculator(Prm.NumSupportSpotsX, Prm.NumSupportSpotsY, this);
 
+	//Create the pass matrix. It is sized from the team members so it must be created after the players.
+	m_pPassMatrix = new PassMatrix(this);
+
+	//Create the pass safety field.
+	m_pPassSafetyField = new PassSafetyField(this, Prm.PassSafetyCellsX, Prm.PassSafetyCellsY, Prm.MaxPassingForce);
+
+	//Create the pass search.
+	m_pPassSearch = new PassSearch(this);
+
+	//Create the think tiers. They are sized from the team members too.
+	m_pThinkTiers = new ThinkTiers(this);
+
 }
 
 SoccerTeam::~SoccerTeam() {
@@ -48,6 +66,14 @@ SoccerTeam::~SoccerTeam() {
 
 	delete m_pSupportSpotCalc;
 
+	delete m_pPassMatrix;
+
+	delete m_pPassSafetyField;
+
+	delete m_pPassSearch;
+
+	delete m_pThinkTiers;
+
 }
 
 //----------------------------------------Update----------------------------------------
@@ -57,16 +83,137 @@ SoccerTeam::~SoccerTeam() {
 void SoccerTeam::Update() {
 
 	//This information is used frequently so it's more efficient to calculate it just once each frame.
-	CalculateClosestPlayerToBall();
+	if (IsDecisionTick()) {
+
+		CalculateClosestPlayerToBall();
+
+		m_pThinkTiers->Assign();
+
+	}
 
 	//The team state machine switches between attack/defense behavior. It also handles the 'kick off' state
 	//where a team must return to their kick off positions before the whistle is blown.
-	m_pStateMachine->Update();
+	UpdateStateMachine();
 
 	//Now update each player.
 	std::vector<PlayerBase*>::iterator it = m_Players.begin();
 	for (it; it != m_Players.end(); ++it) (*it)->Update();
 
+	EndTick();
+
+}
+
+//---------------------------------------BeginTick--------------------------------------
+//---------------------------------------------------------------------------------------
+void SoccerTeam::BeginTick() {
+
+	if (!IsDecisionTick()) return;
+
+	CalculateClosestPlayerToBall();
+
+	m_pThinkTiers->Assign();
+
+}
+
+//-----------------------------------------Think----------------------------------------
+//---------------------------------------------------------------------------------------
+void SoccerTeam::Think() {
+
+	UpdateStateMachine();
+
+	std::vector<PlayerBase*>::iterator it = m_Players.begin();
+	for (it; it != m_Players.end(); ++it) (*it)->Think();
+
+}
+
+//------------------------------------IsDecisionTick------------------------------------
+//
+// Blue decides half way between the updates red decides on.
+//---------------------------------------------------------------------------------------
+bool SoccerTeam::IsDecisionTick()const {
+
+	return Pitch()->IsDecisionTick((m_Color == blue) ? Pitch()->DecisionInterval() / 2 : 0);
+
+}
+
+//----------------------------------UpdateStateMachine----------------------------------
+//---------------------------------------------------------------------------------------
+void SoccerTeam::UpdateStateMachine() {
+
+	if (IsDecisionTick()) m_pStateMachine->Update();
+
+}
+
+//----------------------------------------EndTick---------------------------------------
+//---------------------------------------------------------------------------------------
+void SoccerTeam::EndTick() {
+
+	if (InControl()) ++m_iPossessionTicks;
+
+	//Pick up the best spot of a background scan that has finished.
+	m_pSupportSpotCalc->CollectBackgroundScan();
+
+}
+
+//------------------------------------PlanSupportSpots----------------------------------
+//
+// The regulator reads this thread's clock so it has to be asked here.
+//---------------------------------------------------------------------------------------
+void SoccerTeam::PlanSupportSpots() {
+
+	m_bPrescoreSupportSpots = InControl() && m_pStateMachine->isInState(*Attacking::Instance()) && m_pSupportSpotCalc->IsDue();
+
+}
+
+//----------------------------------PrescoreSupportSpots--------------------------------
+//---------------------------------------------------------------------------------------
+void SoccerTeam::PrescoreSupportSpots() {
+
+	if (m_bPrescoreSupportSpots) m_pSupportSpotCalc->Prescore();
+
+}
+
+//------------------------------------UpdatePassSafety----------------------------------
+//
+// Passes are looked for by the team with the ball, so only its field is filled here. The
+// field still fills itself the first time it is asked if anything else needs it.
+//---------------------------------------------------------------------------------------
+void SoccerTeam::UpdatePassSafety() {
+
+	if (Prm.bPassSafetyField && InControl()) m_pPassSafetyField->Refresh();
+
+}
+
+//-----------------------------------------Reset----------------------------------------
+//
+// Mirrors the constructor so a pitch can be reused for another match.
+//---------------------------------------------------------------------------------------
+void SoccerTeam::Reset() {
+
+	m_pStateMachine->SetCurrentState(Defending::Instance());
+	m_pStateMachine->SetPreviousState(Defending::Instance());
+
+	m_pControllingPlayer = NULL;
+	m_pSupportingPlayer = NULL;
+	m_pReceivingPlayer = NULL;
+	m_pPlayerClosestToBall = NULL;
+	m_dDistSqToBallOfClosestPlayer = 0.0;
+
+	std::vector<PlayerBase*>::iterator it = m_Players.begin();
+	for (it; it != m_Players.end(); ++it) {
+
+		(*it)->Reset(KickOffHeading());
+		(*it)->Steering()->SeparationOn();
+
+	}
+
+	m_pSupportSpotCalc->Reset();
+
+	m_pThinkTiers->Reset();
+
+	m_iNumShots = 0;
+	m_iPossessionTicks = 0;
+
 }
 
 //-----------------------------CalculateClosestPlayerToBall------------------------------
@@ -76,6 +223,7 @@ void SoccerTeam::Update() {
 void SoccerTeam::CalculateClosestPlayerToBall() {
 
 	double ClosestSoFar = MaxFloat;
+	double ClosestFieldPlayerSoFar = MaxFloat;
 	std::vector<PlayerBase*>::iterator it = m_Players.begin();
 	for (it; it != m_Players.end(); ++it) {
 
@@ -84,9 +232,11 @@ void SoccerTeam::CalculateClosestPlayerToBall() {
 
 		//Keep a record of this value for each player.
 		(*it)->SetDistSqToBall(dist);
-		if (dist < ClosestSoFar) {
+		ClosestSoFar = MinOf(ClosestSoFar, dist);
+
+		if (((*it)->Role() != PlayerBase::goal_keeper) && (dist < ClosestFieldPlayerSoFar)) {
 
-			ClosestSoFar = dist;
+			ClosestFieldPlayerSoFar = dist;
 			m_pPlayerClosestToBall = *it;
 
 		}
@@ -137,13 +287,18 @@ PlayerBase* SoccerTeam::DetermineBestSupportingAttacker() {
 //
 // The best pass is considered to be the pass that cannot be intercepted by an opponent
 // and that is as far forward of the receiver as possible.
+// The receivers are examined in order of the best pass they could possibly get, and the
+// search stops as soon as no remaining receiver can beat the best pass found so far.
 //---------------------------------------------------------------------------------------
-bool SoccerTeam::FindPass(const PlayerBase*const passer, PlayerBase*& receiver, Vector2D& PassTarget, double power, double MinPassingDistance)const {
+static bool HigherBound(const std::pair<double, PlayerBase*>& lhs, const std::pair<double, PlayerBase*>& rhs) {
+	return lhs.first > rhs.first;
+}
 
-	std::vector<PlayerBase*>::const_iterator curPlyr = Members().begin();
+bool SoccerTeam::FindPass(const PlayerBase*const passer, PlayerBase*& receiver, Vector2D& PassTarget, double power, double MinPassingDistance, Vector2D* ReceiveTarget)const {
+
+	std::vector<std::pair<double, PlayerBase*> > receivers;
 
-	double ClosestToGoalSoFar = MaxFloat;
-	Vector2D Target;
+	std::vector<PlayerBase*>::const_iterator curPlyr = Members().begin();
 
 	//Iterate through all this player's team members and calculate which one is in a position to be passed the ball.
 	for (curPlyr; curPlyr != Members().end(); ++curPlyr) {
@@ -151,18 +306,38 @@ bool SoccerTeam::FindPass(const PlayerBase*const passer, PlayerBase*& receiver,
 		//Make sure the potential receiver being examined is not this player and that it is further away than the minimum pass distance.
 		if ((*curPlyr != passer) && Vec2DDistanceSq(passer->Pos(), (*curPlyr)->Pos()) > MinPassingDistance * MinPassingDistance) {
 
-			//If the pass target is the closest to the opponent's goal line found so far, keep a record of it.
-			double Dist2Goal = fabs(Target.x - OpponentsGoal()->Center().x);
+			receivers.push_back(std::make_pair(m_pPassSearch->UpperBound(*curPlyr, power), *curPlyr));
+
+		}
+
+	}
+
+	//Stable so receivers with the same bound keep the team order, as before.
+	std::stable_sort(receivers.begin(), receivers.end(), HigherBound);
+
+	double BestScoreSoFar = -MaxDouble;
+	Vector2D Target, Receive;
+
+	for (unsigned int r = 0; r < receivers.size(); ++r) {
+
+		//Nothing left can beat the best pass found.
+		if (receivers[r].first <= BestScoreSoFar) break;
+
+		if (GetBestPassToReceiver(passer, receivers[r].second, Target, power, &Receive)) {
 
-			if (Dist2Goal < ClosestToGoalSoFar) {
+			//If the receive target is the closest to the opponent's goal line found so far, keep a record of it.
+			double score = -fabs(Receive.x - OpponentsGoal()->Center().x);
 
-				ClosestToGoalSoFar = Dist2Goal;
+			if (score > BestScoreSoFar) {
+
+				BestScoreSoFar = score;
 
 				//Keep a record of this player.
-				receiver = *curPlyr;
+				receiver = receivers[r].second;
 
-				//And the target.
+				//And the targets.
 				PassTarget = Target;
+				if (ReceiveTarget) *ReceiveTarget = Receive;
 
 			}
 
@@ -177,80 +352,65 @@ bool SoccerTeam::FindPass(const PlayerBase*const passer, PlayerBase*& receiver,
 
 //---------------------------------GetBestPassToReceiver--------------------------------
 //
-// Three potential passes are calculated. One directly toward the receiver's current position
-// and two that are the tangents from the ball position to the circle of radius 'range' from the receiver.
+// Candidate passes are calculated toward the receiver's current position, the tangents from the
+// ball position to circles around the receiver, where he is heading, the space ahead of him and off the walls.
 // These passes are then tested to see if they can be intercepted by an opponent
 // and to make sure they terminate within the playing area.
 // If all the passes are invalidated the function returns false, otherwise the function returns
 // the pass that takes the ball closest to the opponent's goal area.
+// The passes are always made from the ball position, so the answer for a receiver is the same
+// whoever the passer is and it is looked up in the pass matrix.
 //---------------------------------------------------------------------------------------
-bool SoccerTeam::GetBestPassToReceiver(const PlayerBase* const passer, const PlayerBase* const receiver, Vector2D& PassTarget, double power)const {
-
-	//First calculate how much time it will take for the ball to reach this receiver, if the receiver was to remain motionless.
-	double time = Pitch()->Ball()->TimeToCoverDistance(Pitch()->Ball()->Pos(), receiver->Pos(), power);
+bool SoccerTeam::GetBestPassToReceiver(const PlayerBase* const passer, const PlayerBase* const receiver, Vector2D& PassTarget, double power, Vector2D* ReceiveTarget)const {
+	return m_pPassMatrix->GetBestPassToReceiver(receiver, PassTarget, power, ReceiveTarget);
+}
 
-	//Return false if ball cannot reach the receiver after having been kicked with the given power.
-	if (time < 0) return false;
+//------------------------------CalculateBestPassToReceiver------------------------------
+//---------------------------------------------------------------------------------------
+bool SoccerTeam::CalculateBestPassToReceiver(const PlayerBase* const receiver, Vector2D& PassTarget, double power, Vector2D* ReceiveTarget)const {
 
-	//The maximum distance the receiver can cover in this time.
-	double InterceptRange = time * receiver->MaxSpeed();
+	Vector2D Receive;
 
-	//Scale the intercept range.
-	const double ScalingFactor = 0.3;
-	InterceptRange *= ScalingFactor;
+	if (!m_pPassSearch->FindBestPass(receiver, power, PassTarget, Receive)) return false;
 
-	//Now calculate the pass targets which are positioned at the intercepts of the tangents from the ball to the receiver's range circle.
-	Vector2D ip1, ip2;
-	GetTangentPoints(receiver->Pos(), InterceptRange, Pitch()->Ball()->Pos(), ip1, ip2);
-	const int NumPassesToTry = 3;
-	Vector2D Passes[NumPassesToTry] = { ip1, receiver->Pos(), ip2 };
+	if (ReceiveTarget) *ReceiveTarget = Receive;
 
-	//This pass is the best found so far if it is:
-	//
-	// 1) Further upfield than the closest valid pass for this receiver found so far.
-	// 2) Within the playing area.
-	// 3) Cannot be intercepted by any opponents.
-	double ClosestSoFar = MaxFloat;
-	bool bResult = false;
+	return true;
 
-	for (int pass = 0; pass < NumPassesToTry; ++pass) {
+}
 
-		double dist = fabs(Passes[pass].x - OpponentsGoal()->Center().x);
+//--------------------------------IsPassSafeFromOpponent--------------------------------
+//
+// Test if a pass 'from' to 'to' can be intercepted by an opposing player.
+//---------------------------------------------------------------------------------------
+bool SoccerTeam::IsPassSafeFromOpponent(Vector2D from, Vector2D target, const PlayerBase* const receiver, const PlayerBase* const opp, double PassingForce)const {
 
-		if ((dist < ClosestSoFar) && Pitch()->PlayingArea()->Inside(Passes[pass]) && IsPassSafeFromAllOpponents(Pitch()->Ball()->Pos(), Passes[pass], receiver, power)) {
+	return IsPassSafeFromOpponent(from, target, receiver, ShotOpponent(opp->Pos(), opp->MaxSpeed(), opp->BRadius()), PassingForce);
 
-			ClosestSoFar = dist;
-			PassTarget = Passes[pass];
-			bResult = true;
+}
 
-		}
+bool SoccerTeam::IsPassSafeFromOpponent(Vector2D from, Vector2D target, const PlayerBase* const receiver, const ShotOpponent& opp, double PassingForce)const {
 
-	}
-
-	return bResult;
+	return IsPassSafeFromOpponent(from, target, receiver, opp, PassingForce, Pitch()->Ball()->Mass(), Pitch()->Ball()->BRadius());
 
 }
 
-//--------------------------------IsPassSafeFromOpponent--------------------------------
-//
-// Test if a pass 'from' to 'to' can be intercepted by an opposing player.
-//---------------------------------------------------------------------------------------
-bool SoccerTeam::IsPassSafeFromOpponent(Vector2D from, Vector2D target, const PlayerBase* const receiver, const PlayerBase* const opp, double PassingForce)const {
+bool SoccerTeam::IsPassSafeFromOpponent(Vector2D from, Vector2D target, const PlayerBase* const receiver, const ShotOpponent& opp, double PassingForce, double BallMass, double BallRadius) {
 
 	//Move the opponent into local space.
 	Vector2D ToTarget = target - from;
-	Vector2D ToTargetNormalized = Vec2DNormalize(ToTarget);
-	Vector2D LocalPosOpp = PointToLocalSpace(opp->Pos(), ToTargetNormalized, ToTargetNormalized.Perp(), from);
+	Vector2D ToTargetNormalized = FastMath::Normalize(ToTarget);
+	Vector2D LocalPosOpp = PointToLocalSpace(opp.m_vPos, ToTargetNormalized, ToTargetNormalized.Perp(), from);
 
 	//If opponent is behind the kicker then pass is considered okay.
 	if (LocalPosOpp.x < 0) return true;
 
 	//if the opponent is further away than the target we need to consider if the opponent can reach the position before the receiver.
-	if (Vec2DDistanceSq(from, target) < Vec2DDistanceSq(opp->Pos(), from)) {
+	if (Vec2DDistanceSq(from, target) < Vec2DDistanceSq(opp.m_vPos, from)) {
 
 		if (receiver) {
 
-			if (Vec2DDistanceSq(target, opp->Pos()) > Vec2DDistanceSq(target, receiver->Pos())) return true;
+			if (Vec2DDistanceSq(target, opp.m_vPos) > Vec2DDistanceSq(target, receiver->Pos())) return true;
 			else return false;
 
 		}
@@ -260,10 +420,10 @@ bool SoccerTeam::IsPassSafeFromOpponent(Vector2D from, Vector2D target, const Pl
 	}
 
 	//Calculate how long it takes the ball to cover the distance to the position orthogonal to the opponents position.
-	double TimeForBall = Pitch()->Ball()->TimeToCoverDistance(Vector2D(0, 0), Vector2D(LocalPosOpp.x, 0), PassingForce);
+	double TimeForBall = SoccerBall::TimeToCoverDistance(Vector2D(0, 0), Vector2D(LocalPosOpp.x, 0), PassingForce, BallMass);
 
 	//Now calculate how far the opponent can run in this time.
-	double reach = opp->MaxSpeed() * TimeForBall + Pitch()->Ball()->BRadius() + opp->BRadius();
+	double reach = opp.m_dMaxSpeed * TimeForBall + BallRadius + opp.m_dBRadius;
 
 	//If the distance to the opponent's y position is less than his running range plus the radius of the ball
 	//and the opponents radius then the ball can be intercepted.
@@ -299,41 +459,53 @@ bool SoccerTeam::IsPassSafeFromAllOpponents(Vector2D from, Vector2D target, cons
 
 //---------------------------------------CanShoot---------------------------------------
 //
-// Given a ball position, a kicking power and a reference to a Vector2D this function will sample
-// random positions along the opponent's goal-mouth and check to see if a goal can be scored
-// if the ball was to be kicked in that direction with the given power.
-// If a possible shot is found, the function will immediately return true, with the target position
-// stored in the vector ShotTarget.
+// Given a ball position, a kicking power and a reference to a Vector2D this function works out
+// which parts of the opponent's goal-mouth can be reached by a shot kicked with the given power
+// without being intercepted. If there are any, the function returns true, with the target position
+// with the most clearance stored in the vector ShotTarget.
 //---------------------------------------------------------------------------------------
 bool SoccerTeam::CanShoot(Vector2D BallPos, double power, Vector2D& ShotTarget)const {
 
-	//The number of randomly created shot targets this method will test.
-	int NumAttempts = Prm.NumAttempsToFindValidStrike;
-	
-	while (NumAttempts--) {
+	ShotTarget = OpponentsGoal()->Center();
+
+	std::vector<ShotInterval> open;
+	GetOpenShotIntervals(BallPos, power, open);
+
+	const ShotInterval* best = GetBestShotInterval(open);
 
-		//Choose a random position along the opponent's goal mouth.
-		ShotTarget = OpponentsGoal()->Center();
+	if (!best) return false;
 
-		//The y value of the shot position should lay somewhere between two goalposts.
-		int MinYVal = OpponentsGoal()->LeftPost().y + Pitch()->Ball()->BRadius();
-		int MaxYVal = OpponentsGoal()->RightPost().y - Pitch()->Ball()->BRadius();
+	ShotTarget.y = best->Center();
 
-		ShotTarget.y = (double)RandInt(MinYVal, MaxYVal);
+	return true;
 
-		//Make sure striking the ball with the given power is enough to drive the ball over the goal line.
-		double time = Pitch()->Ball()->TimeToCoverDistance(BallPos, ShotTarget, power);
+}
 
-		//If it is, this shot is then tested to see if any of the opponents can intercept it.
-		if (time >= 0) {
+//---------------------------------GetOpenShotIntervals---------------------------------
+//
+// The y value of the shot position should lay somewhere between two goalposts, leaving
+// room for the ball.
+//---------------------------------------------------------------------------------------
+void SoccerTeam::GetOpenShotIntervals(Vector2D BallPos, double power, std::vector<ShotInterval>& open)const {
 
-			if (IsPassSafeFromAllOpponents(BallPos, ShotTarget, NULL, power)) return true;
+	std::vector<ShotOpponent> opponents;
+	opponents.reserve(Opponents()->Members().size());
 
-		}
+	std::vector<PlayerBase*>::const_iterator opp = Opponents()->Members().begin();
+	for (opp; opp != Opponents()->Members().end(); ++opp) opponents.push_back(ShotOpponent((*opp)->Pos(), (*opp)->MaxSpeed(), (*opp)->BRadius()));
 
-	}
+	GetOpenShotIntervals(BallPos, power, opponents, open);
 
-	return false;
+}
+
+void SoccerTeam::GetOpenShotIntervals(Vector2D BallPos, double power, const std::vector<ShotOpponent>& opponents, std::vector<ShotInterval>& open)const {
+
+	const SoccerBall* ball = Pitch()->Ball();
+
+	double MinY = MinOf(OpponentsGoal()->LeftPost().y, OpponentsGoal()->RightPost().y) + ball->BRadius();
+	double MaxY = MaxOf(OpponentsGoal()->LeftPost().y, OpponentsGoal()->RightPost().y) - ball->BRadius();
+
+	::GetOpenShotIntervals(BallPos, power / ball->Mass(), ball->BRadius(), Prm.Friction, OpponentsGoal()->Center().x, MinY, MaxY, opponents, open);
 
 }
 
@@ -378,6 +550,13 @@ void SoccerTeam::Render()const {
 	//Render the sweet spots.
 	if (Prm.bSupportSpots && InControl()) m_pSupportSpotCalc->Render();
 
+	//#define SHOW_PASS_SAFETY_FIELD
+#ifdef SHOW_PASS_SAFETY_FIELD
+
+	if (InControl()) m_pPassSafetyField->Render();
+
+#endif
+
 	//#define SHOW_TEAM_STATE
 #ifdef SHOW_TEAM_STATE
 
@@ -420,43 +599,63 @@ void SoccerTeam::Render()const {
 
 #endif 
 
-}
+	//#define SHOW_PASS_MATRIX_STATS
+#ifdef SHOW_PASS_MATRIX_STATS
 
-//------------------------------------CreatePlayers-------------------------------------
-//
-// Creates the players
-//---------------------------------------------------------------------------------------
-void SoccerTeam::CreatePlayers() {
+	gdi->TextColor(Cgdi::white);
+	if (Color() == red) gdi->TextAtPos(160, 3, "Pass matrix hits: " + ttos(m_pPassMatrix->HitRate() * 100.0, 1) + "%");
+	else gdi->TextAtPos(160, Pitch()->cyClient() - 18, "Pass matrix hits: " + ttos(m_pPassMatrix->HitRate() * 100.0, 1) + "%");
 
-	if (Color() == blue) {
+#endif
 
-		//Goalkeeper.
-		m_Players.push_back(new GoalKeeper(this, 1, TendGoal::Instance(), Vector2D(0, 1), Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale));
+	//#define SHOW_THINK_TIER_STATS
+#ifdef SHOW_THINK_TIER_STATS
 
-		//Create players.
-		m_Players.push_back(new FieldPlayer(this, 6, Wait::Instance(), Vector2D(0, 1), Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale, PlayerBase::attacker));
+	gdi->TextColor(Cgdi::white);
+	std::string tiers = "Thinks skipped: " + ttos(m_pThinkTiers->SkipRate() * 100.0, 1) + "% woken: " + ttos(m_pThinkTiers->Wakes());
+	if (Color() == red) gdi->TextAtPos(160, 18, tiers);
+	else gdi->TextAtPos(160, Pitch()->cyClient() - 33, tiers);
 
-		m_Players.push_back(new FieldPlayer(this, 8, Wait::Instance(), Vector2D(0, 1), Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale, PlayerBase::attacker));
+#endif
 
-		m_Players.push_back(new FieldPlayer(this, 3, Wait::Instance(), Vector2D(0, 1), Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale, PlayerBase::defender));
+	//#define SHOW_SUPPORT_SPOT_STALENESS
+#ifdef SHOW_SUPPORT_SPOT_STALENESS
 
-		m_Players.push_back(new FieldPlayer(this, 5, Wait::Instance(), Vector2D(0, 1), Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale, PlayerBase::defender));
+	gdi->TextColor(Cgdi::white);
+	std::string staleness = "Support spot age: " + ttos(m_pSupportSpotCalc->Staleness()) + " mean latency: " + ttos(m_pSupportSpotCalc->MeanLatency(), 1) + " max: " + ttos(m_pSupportSpotCalc->MaxLatency());
+	if (Color() == red) gdi->TextAtPos(160, 33, staleness);
+	else gdi->TextAtPos(160, Pitch()->cyClient() - 48, staleness);
 
-	}
+#endif
 
-	else{
+	//#define SHOW_PASS_SEARCH_STATS
+#ifdef SHOW_PASS_SEARCH_STATS
 
-		//Goalkeeper.
-		m_Players.push_back(new GoalKeeper(this, 16, TendGoal::Instance(), Vector2D(0, -1), Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale));
+	gdi->TextColor(Cgdi::white);
+	std::string stats = "Pass candidates: " + ttos(m_pPassSearch->CandidatesGenerated()) + " pruned: " + ttos(m_pPassSearch->CandidatesPruned()) + " tested: " + ttos(m_pPassSearch->FullTests());
+	if (Color() == red) gdi->TextAtPos(320, 3, stats);
+	else gdi->TextAtPos(320, Pitch()->cyClient() - 18, stats);
 
-		//Create players.
-		m_Players.push_back(new FieldPlayer(this, 9, Wait::Instance(), Vector2D(0, -1), Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale, PlayerBase::attacker));
+#endif
 
-		m_Players.push_back(new FieldPlayer(this, 11, Wait::Instance(), Vector2D(0, -1), Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale, PlayerBase::attacker));
+}
 
-		m_Players.push_back(new FieldPlayer(this, 12, Wait::Instance(), Vector2D(0, -1), Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale, PlayerBase::defender));
+//------------------------------------CreatePlayers-------------------------------------
+//
+// Creates the players
+//---------------------------------------------------------------------------------------
+void SoccerTeam::CreatePlayers() {
+
+	Vector2D heading = KickOffHeading();
+
+	for (int plyr = 0; plyr < Frm.TeamSize(); ++plyr) {
+
+		//Players start in their defending home region.
+		int region = Frm.HomeRegion(this, FormationLoader::defending, plyr);
+
+		if (Frm.Role(plyr) == PlayerBase::goal_keeper) m_Players.push_back(new GoalKeeper(this, region, TendGoal::Instance(), heading, Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale));
 
-		m_Players.push_back(new FieldPlayer(this, 14, Wait::Instance(), Vector2D(0, -1), Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale, PlayerBase::defender));
+		else m_Players.push_back(new FieldPlayer(this, region, Wait::Instance(), heading, Vector2D(0.0, 0.0), Prm.PlayerMass, Prm.PlayerMaxForce, Prm.PlayerMaxSpeedWithoutBall, Prm.PlayerMaxTurnRate, Prm.PlayerScale, Frm.Role(plyr)));
 
 	}
 
@@ -467,6 +666,14 @@ void SoccerTeam::CreatePlayers() {
 
 }
 
+//------------------------------------KickOffHeading------------------------------------
+//
+// The blue team faces down the screen at kickoff and the red team up.
+//---------------------------------------------------------------------------------------
+Vector2D SoccerTeam::KickOffHeading()const {
+	return (Color() == blue) ? Vector2D(0, 1) : Vector2D(0, -1);
+}
+
 PlayerBase* SoccerTeam::GetPlayerFromID(int id)const {
 
 	std::vector<PlayerBase*>::const_iterator it = m_Players.begin();
@@ -506,6 +713,9 @@ void SoccerTeam::UpdateTargetsOfWaitingPlayers()const {
 //-----------------------------------AllPlayersAtHome-----------------------------------
 //
 // Returns false if any of the team are not located within their home region.
+// The pitch's region occupancy isn't used: it is counted at the end of the update and the
+// other team may have moved since, and a field player has to be inside the middle half of
+// his home region anyway, which only his position can tell.
 //---------------------------------------------------------------------------------------
 bool SoccerTeam::AllPlayersAtHome()const {
 
@@ -530,7 +740,7 @@ void SoccerTeam::RequestPass(FieldPlayer* requester)const {
 	//Maybe put a restriction here.
 	if (RandFloat() > 0.1) return;
 
-	if (IsPassSafeFromAllOpponents(ControllingPlayer()->Pos(), requester->Pos(), requester, Prm.MaxPassingForce)) {
+	if (m_pPassMatrix->IsPassSafe(ControllingPlayer(), requester, Prm.MaxPassingForce)) {
 
 		//Tell the player to make the pass let the receiver know a pass is coming.
 		Dispatcher->DispatchMsg(SEND_MSG_IMMEDIATELY, requester->ID(), ControllingPlayer()->ID(), Msg_PassToMe, requester);
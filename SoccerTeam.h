@@ -15,6 +15,7 @@
 
 #include "FSM/StateMachine.h"
 #include "Game/Region.h"
+#include "ShotSolver.h"
 #include "SupportSpotCalculator.h"
 
 class Goal;
@@ -23,6 +24,10 @@ class FieldPlayer;
 class SoccerPitch;
 class GoalKeeper;
 class SupportSpotCalculator;
+class PassMatrix;
+class PassSafetyField;
+class PassSearch;
+class ThinkTiers;
 
 class SoccerTeam {
 
@@ -61,7 +66,8 @@ private:
 	//When a player kicks the ball toward another player, the player waiting to receive the ball is the receiver.
 	PlayerBase* m_pReceivingPlayer;
 
-	//The team member who is currently closest to the ball.
+	//The field player who is currently closest to the ball. The goalkeeper only goes for balls near his goal, so
+	//he is left out, otherwise a loose ball he is nearest to but can't reach would be left where it is.
 	PlayerBase* m_pPlayerClosestToBall;
 
 	//The squared distance the closest player is from the ball.
@@ -70,10 +76,33 @@ private:
 	//Players use this to determine strategic position on the playing field.
 	SupportSpotCalculator* m_pSupportSpotCalc;
 
+	//Per-tick cache of pass safety and best pass targets shared by all the pass queries of the team.
+	PassMatrix* m_pPassMatrix;
+
+	//Grid of the cells a pass from the ball can reach without being intercepted.
+	PassSafetyField* m_pPassSafetyField;
+
+	//Generates and tests the candidate passes to a receiver.
+	PassSearch* m_pPassSearch;
+
+	//Decides which field players think each update.
+	ThinkTiers* m_pThinkTiers;
+
+	//True if the support spots are to be scored ahead of the team's state machine this tick.
+	bool m_bPrescoreSupportSpots;
+
+	//Match statistics. The number of shots taken and the number of updates the team has had the ball.
+	int m_iNumShots;
+	int m_iPossessionTicks;
+
 	//Creates all the player for this team.
 	void CreatePlayers();
 
-	//Called each frame. Sets m_pClosestPlayerToBall to point to the player closest to the ball.
+	//The direction the players face at kickoff.
+	Vector2D KickOffHeading()const;
+
+	//Called each frame. Sets m_pPlayerClosestToBall to point to the field player closest to the ball, and
+	//m_dDistSqToBallOfClosestPlayer to the distance of the closest of all the players.
 	void CalculateClosestPlayerToBall();
 
 public:
@@ -83,30 +112,71 @@ public:
 	void Render()const;
 	void Update();
 
+	//Puts the players back in their kickoff positions and states and clears the match statistics, as if the team had just been created.
+	void Reset();
+
+	//The team's part of a buffered update (see SoccerPitch::UpdatePlayersBuffered). BeginTick finds the player closest
+	//to the ball, Think runs the team and player state machines and EndTick counts possession. The players are moved
+	//by the pitch in between.
+	void BeginTick();
+	void Think();
+	void EndTick();
+
+	//True on the updates the team makes its decisions on. See SoccerPitch::IsDecisionTick.
+	bool IsDecisionTick()const;
+
+	//Runs the team's state machine if the team makes its decisions this update.
+	void UpdateStateMachine();
+
+	//Work taken out of the team's state machine so the tick graph (see SoccerPitch::BuildTickGraph) can run it
+	//earlier, on any thread. PlanSupportSpots decides on the main thread whether the Attacking state will score the
+	//support spots this tick, PrescoreSupportSpots then scores them and UpdatePassSafety fills the pass safety field.
+	void PlanSupportSpots();
+	void PrescoreSupportSpots();
+	bool PrescoringSupportSpots()const { return m_bPrescoreSupportSpots; }
+	void UpdatePassSafety();
+
 	//Calling this changes the state of all field players to that of ReturnToHomeRegion.
 	//Mainly used when a goal keeper has possession.
 	void ReturnAllFieldPlayersToHome()const;
 
-	//Returns true if player has a clean shot at the goal and sets ShotTarget to a normalized vector pointing
-	//in the direction the shot should be made. Else returns false and sets heading to a zero vector.
+	//Returns true if player has a clean shot at the goal and sets ShotTarget to the position on the goal line
+	//with the most clearance from the opponents. Else returns false and sets ShotTarget to the center of the goal.
 	bool CanShoot(Vector2D BallPos, double power, Vector2D& ShotTarget = Vector2D())const;
 
+	//Fills 'open' with the intervals of the opponent's goal mouth that a ball kicked from BallPos with the given
+	//power reaches without any opponent being able to intercept it.
+	void GetOpenShotIntervals(Vector2D BallPos, double power, std::vector<ShotInterval>& open)const;
+	void GetOpenShotIntervals(Vector2D BallPos, double power, const std::vector<ShotOpponent>& opponents, std::vector<ShotInterval>& open)const;
+
 	//The best pass is considered to be the pass that cannot be intercepted by an opponent
 	//and that is as far forward of the receiver as possible.
 	//If a pass is found, the receiver's address is returned in the reference 'receiver'
 	//and the position the pass will be made to is returned in the reference 'PassTarget'.
-	bool FindPass(const PlayerBase*const passer, PlayerBase*& receiver, Vector2D& PassTarget, double power, double MinPassingDistance)const;
+	//If ReceiveTarget is given it is set to where the receiver collects the ball, which differs from PassTarget
+	//for a pass played off a wall.
+	bool FindPass(const PlayerBase*const passer, PlayerBase*& receiver, Vector2D& PassTarget, double power, double MinPassingDistance, Vector2D* ReceiveTarget = NULL)const;
 
-	//Three potential passes are calculated. One directly toward the receiver's current position 
-	//and two that are the tangents from the ball position to the circle of radius 'range' from the receiver.
+	//Candidate passes are generated toward the receiver's current position, the tangents from the ball position to circles
+	//of several radii around the receiver, where the receiver is heading, into the space ahead of him and off the walls.
 	//These passes are then tested to see if they can be intercepted by an opponent and to make sure they terminate within the playing area.
 	//If all the passes are invalidated the function returns false. Otherwise the function returns the pass
 	//that takes the ball closest to the opponent's goal area.
-	bool GetBestPassToReceiver(const PlayerBase* const passer, const PlayerBase* const receiver, Vector2D& PassTarget, const double power)const;
+	//The result is cached in the pass matrix for the rest of the tick.
+	bool GetBestPassToReceiver(const PlayerBase* const passer, const PlayerBase* const receiver, Vector2D& PassTarget, const double power, Vector2D* ReceiveTarget = NULL)const;
+
+	//Uncached version of GetBestPassToReceiver. Used by the pass matrix to fill its entries.
+	bool CalculateBestPassToReceiver(const PlayerBase* const receiver, Vector2D& PassTarget, const double power, Vector2D* ReceiveTarget = NULL)const;
 
 	//Test if a pass from positions 'from' to 'target' kicked with force 'PassingForce' can be intercepted by an opposing player.
 	bool IsPassSafeFromOpponent(Vector2D from, Vector2D target, const PlayerBase* const receiver, const PlayerBase* const opp, double PassingForce)const;
 
+	//The same test against a snapshot of the opponent.
+	bool IsPassSafeFromOpponent(Vector2D from, Vector2D target, const PlayerBase* const receiver, const ShotOpponent& opp, double PassingForce)const;
+
+	//The same test for a ball of the given mass and radius. Doesn't read the pitch, so it can be asked while the players move.
+	static bool IsPassSafeFromOpponent(Vector2D from, Vector2D target, const PlayerBase* const receiver, const ShotOpponent& opp, double PassingForce, double BallMass, double BallRadius);
+
 	//Test if a pass from positions 'from' to 'target' against each member of the opposing player.
 	//Returns true if the pass can be made without getting intercepted
 	bool IsPassSafeFromAllOpponents(Vector2D from, Vector2D target, const PlayerBase* const receiver, double PassingForce)const;
@@ -140,7 +210,13 @@ public:
 
 	double ClosestDistToBallSq()const { return m_dDistSqToBallOfClosestPlayer; }
 
+	//The best supporting spot published by the support spot calculator. It may have been scored a few ticks ago,
+	//SupportSpotStaleness tells how many.
 	Vector2D GetSupportSpot()const { return m_pSupportSpotCalc->GetBestSupportingSpot(); }
+	int SupportSpotStaleness()const { return m_pSupportSpotCalc->Staleness(); }
+
+	//Stops the support spot calculator's background scan, if there is one, without publishing it.
+	void CancelSupportSpotScan()const { m_pSupportSpotCalc->CancelBackgroundScan(); }
 
 	PlayerBase* SupportingPlayer()const { return m_pSupportingPlayer; }
 	void SetSupportingPlayer(PlayerBase* plyr) { m_pSupportingPlayer = plyr; }
@@ -149,7 +225,8 @@ public:
 	void SetReceiver(PlayerBase* plyr) { m_pReceivingPlayer = plyr; }
 
 	PlayerBase* ControllingPlayer()const { return m_pControllingPlayer; }
-	void SetControllingPlayer(PlayerBase* plyr) { m_pControllingPlayer = plyr; }
+	//Only one team can control the ball, so the opponents lose control when a player of this team takes it.
+	void SetControllingPlayer(PlayerBase* plyr) { m_pControllingPlayer = plyr; m_pOpponents->LostControl(); }
 
 	bool InControl()const { if (m_pControllingPlayer) return true; else return false; }
 	void LostControl() { m_pControllingPlayer = NULL; }
@@ -160,6 +237,14 @@ public:
 
 	void DetermineBestSupportingPosition()const { m_pSupportSpotCalc->DetermineBestSupportingPosition(); }
 
+	PassMatrix* const GetPassMatrix()const { return m_pPassMatrix; }
+
+	PassSafetyField* const PassSafety()const { return m_pPassSafetyField; }
+
+	PassSearch* const GetPassSearch()const { return m_pPassSearch; }
+
+	ThinkTiers* const GetThinkTiers()const { return m_pThinkTiers; }
+
 	void UpdateTargetsOfWaitingPlayers()const;
 
 	//Returns false if any of the team are not located within their home region.
@@ -167,6 +252,11 @@ public:
 
 	std::string Name()const { if (m_Color == blue) return "Blue"; return "Red"; }
 
+	int NumShots()const { return m_iNumShots; }
+	void IncrementShots() { ++m_iNumShots; }
+
+	int PossessionTicks()const { return m_iPossessionTicks; }
+
 };
 
 #endif // SOCCERTEAM_H
@@ -0,0 +1,430 @@
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "ParamLoader.h"
+#include "PlayerBase.h"
+#include "SoccerBall.h"
+#include "SoccerPitch.h"
+#include "SteeringBatch.h"
+#include "SteeringBehaviors.h"
+
+//The deceleration tweaker of SteeringBehaviors::Arrive times the fast and normal decelerations.
+const double FastDeceleration = 1.0 * 0.3;
+const double NormalDeceleration = 2.0 * 0.3;
+
+#ifdef SIMD_SSE2
+//Picks a where the mask is set and b where it isn't.
+inline __m128d Select(__m128d mask, __m128d a, __m128d b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+
+inline __m128d Length(__m128d x, __m128d y) { return _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y))); }
+
+//Vec2DNormalize, which leaves vectors no longer than epsilon as they are.
+inline void Normalize(__m128d& x, __m128d& y) {
+
+	__m128d length = Length(x, y);
+	__m128d divides = _mm_cmpgt_pd(length, _mm_set1_pd(std::numeric_limits<double>::epsilon()));
+
+	x = Select(divides, _mm_div_pd(x, length), x);
+	y = Select(divides, _mm_div_pd(y, length), y);
+
+}
+
+//SteeringBehaviors::Arrive.
+inline void Arrive(__m128d tx, __m128d ty, __m128d px, __m128d py, __m128d vx, __m128d vy, __m128d MaxSpeed, double deceleration, __m128d& ax, __m128d& ay) {
+
+	__m128d ToX = _mm_sub_pd(tx, px);
+	__m128d ToY = _mm_sub_pd(ty, py);
+
+	__m128d dist = Length(ToX, ToY);
+	__m128d away = _mm_cmpgt_pd(dist, _mm_setzero_pd());
+
+	__m128d speed = _mm_div_pd(dist, _mm_set1_pd(deceleration));
+	speed = Select(_mm_cmplt_pd(speed, MaxSpeed), speed, MaxSpeed);
+
+	ax = _mm_and_pd(away, _mm_sub_pd(_mm_div_pd(_mm_mul_pd(ToX, speed), dist), vx));
+	ay = _mm_and_pd(away, _mm_sub_pd(_mm_div_pd(_mm_mul_pd(ToY, speed), dist), vy));
+
+}
+
+//SteeringBehaviors::AccumulateForce for the lanes in 'active'. The lanes that run out of force are added to 'done'.
+inline void Accumulate(__m128d active, __m128d fx, __m128d fy, __m128d MaxForce, __m128d& sfx, __m128d& sfy, __m128d& done) {
+
+	active = _mm_andnot_pd(done, active);
+
+	__m128d remaining = _mm_sub_pd(MaxForce, Length(sfx, sfy));
+	__m128d used = _mm_cmple_pd(remaining, _mm_setzero_pd());
+
+	done = _mm_or_pd(done, _mm_and_pd(active, used));
+	active = _mm_andnot_pd(used, active);
+
+	__m128d add = Length(fx, fy);
+	add = Select(_mm_cmpgt_pd(add, remaining), remaining, add);
+
+	Normalize(fx, fy);
+
+	sfx = Select(active, _mm_add_pd(sfx, _mm_mul_pd(fx, add)), sfx);
+	sfy = Select(active, _mm_add_pd(sfy, _mm_mul_pd(fy, add)), sfy);
+
+}
+#else
+//SteeringBehaviors::Arrive.
+inline Vector2D Arrive(Vector2D TargetPos, Vector2D pos, Vector2D velocity, double MaxSpeed, double deceleration) {
+
+	Vector2D ToTarget = TargetPos - pos;
+	double dist = ToTarget.Length();
+
+	if (dist > 0) {
+
+		double speed = min(dist / deceleration, MaxSpeed);
+		return ToTarget * speed / dist - velocity;
+
+	}
+
+	return Vector2D(0, 0);
+
+}
+
+//SteeringBehaviors::AccumulateForce.
+inline bool Accumulate(Vector2D& sf, Vector2D ForceToAdd, double MaxForce) {
+
+	double MagnitudeRemaining = MaxForce - sf.Length();
+	if (MagnitudeRemaining <= 0.0) return false;
+
+	double MagnitudeToAdd = ForceToAdd.Length();
+	if (MagnitudeToAdd > MagnitudeRemaining) MagnitudeToAdd = MagnitudeRemaining;
+
+	sf += Vec2DNormalize(ForceToAdd) * MagnitudeToAdd;
+
+	return true;
+
+}
+#endif
+
+SteeringBatch::SteeringBatch(SoccerPitch* pitch) :m_pPitch(pitch), m_iNumPlayers((int)pitch->Players().size()) {
+
+	int size = (m_iNumPlayers + SimdDoubleWidth - 1) / SimdDoubleWidth * SimdDoubleWidth;
+
+	m_PosX.assign(size, 0.0);
+	m_PosY.assign(size, 0.0);
+	m_VelX.assign(size, 0.0);
+	m_VelY.assign(size, 0.0);
+	m_MaxSpeed.assign(size, 0.0);
+	m_MaxForce.assign(size, 0.0);
+	m_TargetX.assign(size, 0.0);
+	m_TargetY.assign(size, 0.0);
+	m_InterposeDist.assign(size, 0.0);
+	m_SeparationMult.assign(size, 0.0);
+	m_ViewDistSq.assign(size, 0.0);
+	m_Index.assign(size, -1.0);
+	m_Flags.assign(size, 0);
+	m_ForceX.assign(size, 0.0);
+	m_ForceY.assign(size, 0.0);
+	m_Pursued.assign(size, false);
+
+}
+
+//----------------------------------------Calculate-------------------------------------
+//---------------------------------------------------------------------------------------
+void SteeringBatch::Calculate() {
+
+	Gather();
+
+	for (int p = 0; p < m_iNumPlayers; p += SimdDoubleWidth) {
+		if (!LanesAsleep(p)) CalculateLanes(p);
+	}
+
+	Scatter();
+
+}
+
+//-----------------------------------------Gather---------------------------------------
+//---------------------------------------------------------------------------------------
+void SteeringBatch::Gather() {
+
+	const std::vector<PlayerBase*>& players = m_pPitch->Players();
+
+	for (int p = 0; p < m_iNumPlayers; ++p) {
+
+		SteeringBehaviors* steering = players[p]->Steering();
+
+		m_PosX[p] = players[p]->Pos().x;
+		m_PosY[p] = players[p]->Pos().y;
+		m_VelX[p] = players[p]->Velocity().x;
+		m_VelY[p] = players[p]->Velocity().y;
+		m_MaxSpeed[p] = players[p]->MaxSpeed();
+		m_MaxForce[p] = players[p]->MaxForce();
+		m_TargetX[p] = steering->Target().x;
+		m_TargetY[p] = steering->Target().y;
+		m_InterposeDist[p] = steering->InterposeDistance();
+		m_SeparationMult[p] = steering->SeparationMultiplier();
+		m_ViewDistSq[p] = steering->ViewDistance() * steering->ViewDistance();
+		m_Index[p] = (double)p;
+
+		m_Flags[p] = steering->Flags();
+
+	}
+
+}
+
+//-----------------------------------------Scatter--------------------------------------
+//---------------------------------------------------------------------------------------
+void SteeringBatch::Scatter()const {
+
+	const std::vector<PlayerBase*>& players = m_pPitch->Players();
+
+	for (int p = 0; p < m_iNumPlayers; ++p) {
+
+		if (players[p]->IsAsleep()) continue;
+
+		SteeringBehaviors* steering = players[p]->Steering();
+
+		if (m_Pursued[p]) steering->SetTarget(Vector2D(m_TargetX[p], m_TargetY[p]));
+
+		steering->SetForce(Vector2D(m_ForceX[p], m_ForceY[p]));
+
+	}
+
+}
+
+//---------------------------------------LanesAsleep------------------------------------
+//
+// The padding players have no behaviours, so they count as asleep.
+//---------------------------------------------------------------------------------------
+bool SteeringBatch::LanesAsleep(int first)const {
+
+	const std::vector<PlayerBase*>& players = m_pPitch->Players();
+
+	for (int p = first; (p < first + SimdDoubleWidth) && (p < m_iNumPlayers); ++p) {
+		if (!players[p]->IsAsleep()) return false;
+	}
+
+	return true;
+
+}
+
+//--------------------------------------CalculateLanes----------------------------------
+//
+// Follows SteeringBehaviors::SumForces and Calculate step by step. Every behaviour is
+// worked out for both lanes and only kept where it is switched on, so the sums see the
+// same additions in the same order as they do there.
+//---------------------------------------------------------------------------------------
+void SteeringBatch::CalculateLanes(int first) {
+
+	const SoccerBall* ball = m_pPitch->Ball();
+
+	//Where pursuit predicts the ball to be is worked out from the ball's velocity.
+	Vector2D BallHeading = Vec2DNormalize(ball->Velocity());
+	double BallSpeed = ball->Speed();
+	double HalfFriction = 0.5 * Prm.Friction;
+
+#ifdef SIMD_SSE2
+	const __m128d zero = _mm_setzero_pd();
+
+	__m128d px = _mm_loadu_pd(&m_PosX[first]);
+	__m128d py = _mm_loadu_pd(&m_PosY[first]);
+	__m128d vx = _mm_loadu_pd(&m_VelX[first]);
+	__m128d vy = _mm_loadu_pd(&m_VelY[first]);
+	__m128d MaxSpeed = _mm_loadu_pd(&m_MaxSpeed[first]);
+	__m128d MaxForce = _mm_loadu_pd(&m_MaxForce[first]);
+	__m128d tx = _mm_loadu_pd(&m_TargetX[first]);
+	__m128d ty = _mm_loadu_pd(&m_TargetY[first]);
+
+	//A behaviour's mask has a lane set if the lane's player has it switched on. SSE2 only compares 32 bits
+	//at a time, so the halves of each lane are compared apart and then and-ed together.
+	__m128i flags = _mm_loadu_si128((const __m128i*)&m_Flags[first]);
+	__m128d on[SteeringBehaviors::interpose + 1];
+
+	for (int bt = SteeringBehaviors::seek; bt <= SteeringBehaviors::interpose; bt <<= 1) {
+
+		__m128i bit = _mm_set_epi32(0, bt, 0, bt);
+		__m128i set = _mm_cmpeq_epi32(_mm_and_si128(flags, bit), bit);
+
+		on[bt] = _mm_castsi128_pd(_mm_and_si128(set, _mm_shuffle_epi32(set, _MM_SHUFFLE(2, 3, 0, 1))));
+
+	}
+
+	__m128d fx = zero;
+	__m128d fy = zero;
+	__m128d sfx = zero;
+	__m128d sfy = zero;
+	__m128d done = zero;
+
+	//Separation, from every player in view except the player himself.
+	__m128d sx = zero;
+	__m128d sy = zero;
+
+	__m128d ViewDistSq = _mm_loadu_pd(&m_ViewDistSq[first]);
+	__m128d index = _mm_loadu_pd(&m_Index[first]);
+
+	for (int n = 0; n < m_iNumPlayers; ++n) {
+
+		__m128d ToX = _mm_sub_pd(px, _mm_set1_pd(m_PosX[n]));
+		__m128d ToY = _mm_sub_pd(py, _mm_set1_pd(m_PosY[n]));
+
+		__m128d DistSq = _mm_add_pd(_mm_mul_pd(ToX, ToX), _mm_mul_pd(ToY, ToY));
+		__m128d neighbour = _mm_and_pd(_mm_cmplt_pd(DistSq, ViewDistSq), _mm_cmpneq_pd(index, _mm_set1_pd((double)n)));
+
+		__m128d dist = _mm_sqrt_pd(DistSq);
+
+		Normalize(ToX, ToY);
+
+		sx = _mm_add_pd(sx, _mm_and_pd(neighbour, _mm_div_pd(ToX, dist)));
+		sy = _mm_add_pd(sy, _mm_and_pd(neighbour, _mm_div_pd(ToY, dist)));
+
+	}
+
+	__m128d mult = _mm_loadu_pd(&m_SeparationMult[first]);
+
+	fx = Select(on[SteeringBehaviors::separation], _mm_add_pd(fx, _mm_mul_pd(sx, mult)), fx);
+	fy = Select(on[SteeringBehaviors::separation], _mm_add_pd(fy, _mm_mul_pd(sy, mult)), fy);
+	Accumulate(on[SteeringBehaviors::separation], fx, fy, MaxForce, sfx, sfy, done);
+
+	//Seek.
+	__m128d bx = _mm_sub_pd(tx, px);
+	__m128d by = _mm_sub_pd(ty, py);
+
+	Normalize(bx, by);
+
+	fx = Select(on[SteeringBehaviors::seek], _mm_add_pd(fx, _mm_sub_pd(_mm_mul_pd(bx, MaxSpeed), vx)), fx);
+	fy = Select(on[SteeringBehaviors::seek], _mm_add_pd(fy, _mm_sub_pd(_mm_mul_pd(by, MaxSpeed), vy)), fy);
+	Accumulate(on[SteeringBehaviors::seek], fx, fy, MaxForce, sfx, sfy, done);
+
+	//Arrive.
+	Arrive(tx, ty, px, py, vx, vy, MaxSpeed, FastDeceleration, bx, by);
+
+	fx = Select(on[SteeringBehaviors::arrive], _mm_add_pd(fx, bx), fx);
+	fy = Select(on[SteeringBehaviors::arrive], _mm_add_pd(fy, by), fy);
+	Accumulate(on[SteeringBehaviors::arrive], fx, fy, MaxForce, sfx, sfy, done);
+
+	//Pursuit. The target becomes the predicted position of the ball for the lanes that get this far.
+	__m128d BallX = _mm_set1_pd(ball->Pos().x);
+	__m128d BallY = _mm_set1_pd(ball->Pos().y);
+
+	__m128d look = zero;
+	if (BallSpeed != 0.0) look = _mm_div_pd(Length(_mm_sub_pd(BallX, px), _mm_sub_pd(BallY, py)), _mm_set1_pd(BallSpeed));
+
+	__m128d HalfATSquared = _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(HalfFriction), look), look);
+
+	__m128d FutureX = _mm_add_pd(_mm_add_pd(BallX, _mm_mul_pd(_mm_set1_pd(ball->Velocity().x), look)), _mm_mul_pd(_mm_set1_pd(BallHeading.x), HalfATSquared));
+	__m128d FutureY = _mm_add_pd(_mm_add_pd(BallY, _mm_mul_pd(_mm_set1_pd(ball->Velocity().y), look)), _mm_mul_pd(_mm_set1_pd(BallHeading.y), HalfATSquared));
+
+	__m128d pursued = _mm_andnot_pd(done, on[SteeringBehaviors::pursuit]);
+
+	tx = Select(pursued, FutureX, tx);
+	ty = Select(pursued, FutureY, ty);
+
+	Arrive(tx, ty, px, py, vx, vy, MaxSpeed, FastDeceleration, bx, by);
+
+	fx = Select(on[SteeringBehaviors::pursuit], _mm_add_pd(fx, bx), fx);
+	fy = Select(on[SteeringBehaviors::pursuit], _mm_add_pd(fy, by), fy);
+	Accumulate(on[SteeringBehaviors::pursuit], fx, fy, MaxForce, sfx, sfy, done);
+
+	//Interpose, between the target and the ball.
+	__m128d InterposeDist = _mm_loadu_pd(&m_InterposeDist[first]);
+
+	bx = _mm_sub_pd(BallX, tx);
+	by = _mm_sub_pd(BallY, ty);
+
+	Normalize(bx, by);
+
+	Arrive(_mm_add_pd(tx, _mm_mul_pd(bx, InterposeDist)), _mm_add_pd(ty, _mm_mul_pd(by, InterposeDist)), px, py, vx, vy, MaxSpeed, NormalDeceleration, bx, by);
+
+	fx = Select(on[SteeringBehaviors::interpose], _mm_add_pd(fx, bx), fx);
+	fy = Select(on[SteeringBehaviors::interpose], _mm_add_pd(fy, by), fy);
+	Accumulate(on[SteeringBehaviors::interpose], fx, fy, MaxForce, sfx, sfy, done);
+
+	//Truncate to the max force.
+	__m128d TooStrong = _mm_cmpgt_pd(Length(sfx, sfy), MaxForce);
+
+	bx = sfx;
+	by = sfy;
+
+	Normalize(bx, by);
+
+	_mm_storeu_pd(&m_ForceX[first], Select(TooStrong, _mm_mul_pd(bx, MaxForce), sfx));
+	_mm_storeu_pd(&m_ForceY[first], Select(TooStrong, _mm_mul_pd(by, MaxForce), sfy));
+	_mm_storeu_pd(&m_TargetX[first], tx);
+	_mm_storeu_pd(&m_TargetY[first], ty);
+
+	int mask = _mm_movemask_pd(pursued);
+
+	for (int lane = 0; lane < SimdDoubleWidth; ++lane) m_Pursued[first + lane] = (mask & (1 << lane)) != 0;
+#else
+	for (int p = first; p < first + SimdDoubleWidth; ++p) {
+
+		Vector2D pos(m_PosX[p], m_PosY[p]);
+		Vector2D velocity(m_VelX[p], m_VelY[p]);
+		Vector2D target(m_TargetX[p], m_TargetY[p]);
+		long long flags = m_Flags[p];
+
+		Vector2D force;
+		Vector2D sf;
+
+		m_Pursued[p] = false;
+
+		do {
+
+			if (flags & SteeringBehaviors::separation) {
+
+				Vector2D sum;
+
+				for (int n = 0; n < m_iNumPlayers; ++n) {
+
+					Vector2D ToAgent = pos - Vector2D(m_PosX[n], m_PosY[n]);
+					if ((n != p) && (ToAgent.LengthSq() < m_ViewDistSq[p])) sum += Vec2DNormalize(ToAgent) / ToAgent.Length();
+
+				}
+
+				force += sum * m_SeparationMult[p];
+				if (!Accumulate(sf, force, m_MaxForce[p])) break;
+
+			}
+
+			if (flags & SteeringBehaviors::seek) {
+
+				force += Vec2DNormalize(target - pos) * m_MaxSpeed[p] - velocity;
+				if (!Accumulate(sf, force, m_MaxForce[p])) break;
+
+			}
+
+			if (flags & SteeringBehaviors::arrive) {
+
+				force += Arrive(target, pos, velocity, m_MaxSpeed[p], FastDeceleration);
+				if (!Accumulate(sf, force, m_MaxForce[p])) break;
+
+			}
+
+			if (flags & SteeringBehaviors::pursuit) {
+
+				double LookAheadTime = 0.0;
+				if (BallSpeed != 0.0) LookAheadTime = Vec2DDistance(ball->Pos(), pos) / BallSpeed;
+
+				target = ball->Pos() + ball->Velocity() * LookAheadTime + BallHeading * (HalfFriction * LookAheadTime * LookAheadTime);
+				m_Pursued[p] = true;
+
+				force += Arrive(target, pos, velocity, m_MaxSpeed[p], FastDeceleration);
+				if (!Accumulate(sf, force, m_MaxForce[p])) break;
+
+			}
+
+			if (flags & SteeringBehaviors::interpose) {
+
+				force += Arrive(target + Vec2DNormalize(ball->Pos() - target) * m_InterposeDist[p], pos, velocity, m_MaxSpeed[p], NormalDeceleration);
+				if (!Accumulate(sf, force, m_MaxForce[p])) break;
+
+			}
+
+		} while (false);
+
+		sf.Truncate(m_MaxForce[p]);
+
+		m_ForceX[p] = sf.x;
+		m_ForceY[p] = sf.y;
+		m_TargetX[p] = target.x;
+		m_TargetY[p] = target.y;
+
+	}
+#endif
+
+}
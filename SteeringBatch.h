@@ -0,0 +1,85 @@
+#ifndef STEERINGBATCH_H
+#define STEERINGBATCH_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: SteeringBatch.h
+//
+//  Desc: Works out the steering forces of all the players of a pitch at
+//        once. The players' positions, velocities, targets and behaviours
+//        are copied into one array per quantity and the forces are worked
+//        out for a pair of players at a time, one per SSE2 lane. Instead
+//        of branching on the behaviours each lane is masked, and a lane
+//        stops adding forces as soon as its player's max force is used up.
+//
+//        The forces, and the targets pursuit sets, are the same down to the
+//        last bit as the ones SteeringBehaviors::Calculate works out, and
+//        are handed to each player's SteeringBehaviors through SetForce.
+//        Sleeping players still count as neighbours but are handed no
+//        force, and a pair of them is skipped altogether.
+//
+//------------------------------------------------------------------------
+#include <vector>
+
+#include "misc/simd.h"
+
+class SoccerPitch;
+
+class SteeringBatch {
+
+private:
+	SoccerPitch* m_pPitch;
+
+	int m_iNumPlayers;
+
+	//The state of every player, in the order of SoccerPitch::Players. Padded to a whole number of
+	//lanes with players that have no behaviours.
+	std::vector<double> m_PosX;
+	std::vector<double> m_PosY;
+	std::vector<double> m_VelX;
+	std::vector<double> m_VelY;
+	std::vector<double> m_MaxSpeed;
+	std::vector<double> m_MaxForce;
+	std::vector<double> m_TargetX;
+	std::vector<double> m_TargetY;
+	std::vector<double> m_InterposeDist;
+	std::vector<double> m_SeparationMult;
+	std::vector<double> m_ViewDistSq;
+
+	//The player's own index, so separation can leave him out.
+	std::vector<double> m_Index;
+
+	//The behaviours switched on, as SteeringBehaviors::behavior_type bits. 64 bits each so a lane's flags fill a whole double lane.
+	std::vector<long long> m_Flags;
+
+	//The results.
+	std::vector<double> m_ForceX;
+	std::vector<double> m_ForceY;
+
+	//Set for the players whose target was moved by pursuit.
+	std::vector<bool> m_Pursued;
+
+	//Copies the players into the arrays.
+	void Gather();
+
+	//Hands the forces and targets back to the players.
+	void Scatter()const;
+
+	//Works out the forces of the players from 'first' up to, but not including, first + SimdDoubleWidth.
+	void CalculateLanes(int first);
+
+	//Returns true if every player of those lanes is asleep, so they have no forces to work out.
+	bool LanesAsleep(int first)const;
+
+	SteeringBatch(const SteeringBatch&);
+	SteeringBatch& operator=(const SteeringBatch&);
+
+public:
+	SteeringBatch(SoccerPitch* pitch);
+
+	//Works out the steering force of every player and hands it to him.
+	void Calculate();
+
+};
+
+#endif // STEERINGBATCH_H
@@ -1,9 +1,9 @@
 #include "2D/Transformations.h"
-#include "misc/autolist.h"
 #include "misc/utils.h"
 #include "ParamLoader.h"
 #include "PlayerBase.h"
 #include "SoccerBall.h"
+#include "SoccerPitch.h"
 #include "SoccerTeam.h"
 #include "SteeringBehaviors.h"
 
@@ -11,7 +11,7 @@ using std::string;
 using std::vector;
 
 SteeringBehaviors::SteeringBehaviors(PlayerBase* agent, SoccerPitch* world, SoccerBall* ball):
-	m_pPlayer(agent),m_iFlags(0),m_dMultSeparation(Prm.SeparationCoefficient),m_bTagged(false),m_dViewDistance(Prm.ViewDistance),m_pBall(ball),m_dInterposeDist(0.0),m_Antenna(5,Vector2D()){}
+	m_pPlayer(agent),m_pBall(ball),m_dInterposeDist(0.0),m_dMultSeparation(Prm.SeparationCoefficient),m_dViewDistance(Prm.ViewDistance),m_iFlags(none),m_iForceTick(-1),m_pSumForces(m_Pipelines[none]),m_Antenna(5,Vector2D()){}
 
 //------------------------------------AccumulateForce--------------------------------------
 //
@@ -49,6 +49,11 @@ bool SteeringBehaviors::AccumulateForce(Vector2D &sf, Vector2D ForceToAdd) {
 //------------------------------------------------------------------------------------------
 Vector2D SteeringBehaviors::Calculate() {
 
+	if (m_iForceTick == m_pPlayer->Pitch()->TickCount()) return m_vSteeringForce;
+
+	//A player is only put to sleep with no force on him, and nothing that could change that happens until he is woken.
+	if (m_pPlayer->IsAsleep()) return m_vSteeringForce;
+
 	//Reset the force
 	m_vSteeringForce.Zero();
 
@@ -62,48 +67,58 @@ Vector2D SteeringBehaviors::Calculate() {
 
 }
 
-//----------------------------------------SumForces-----------------------------------------
+//-----------------------------------------SetForce-----------------------------------------
+//------------------------------------------------------------------------------------------
+void SteeringBehaviors::SetForce(Vector2D force) {
+
+	m_vSteeringForce = force;
+	m_iForceTick = m_pPlayer->Pitch()->TickCount();
+
+}
+
+//----------------------------------------SumForcesT---------------------------------------
 //
 // This method calls each active steering behavior and accumulates their forces until the max
 // steering force magnitude is reached at which time the function returns the steering force accumulated.
 //
 //------------------------------------------------------------------------------------------
-Vector2D SteeringBehaviors::SumForces() {
+template <int Flags>
+Vector2D SteeringBehaviors::SumForcesT() {
 
 	Vector2D force;
 
-	//The soccer player must always tag their neighbors.
-	FindNeighbours();
+	if (Flags & separation) {
 
-	if (On(separation)) {
+		//Only separation needs the neighbours.
+		FindNeighbours();
 
 		force += Separation() * m_dMultSeparation;
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 
 	}
 
-	if (On(seek)) {
+	if (Flags & seek) {
 
 		force += Seek(m_vTarget);
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 
 	}
 
-	if (On(arrive)) {
+	if (Flags & arrive) {
 
 		force += Arrive(m_vTarget, fast);
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 
 	}
 
-	if (On(pursuit)) {
+	if (Flags & pursuit) {
 
 		force += Pursuit(m_pBall);
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
 
 	}
 
-	if (On(interpose)) {
+	if (Flags & interpose) {
 
 		force += Interpose(m_pBall, m_vTarget, m_dInterposeDist);
 		if (!AccumulateForce(m_vSteeringForce, force)) return m_vSteeringForce;
@@ -114,6 +129,19 @@ Vector2D SteeringBehaviors::SumForces() {
 
 }
 
+const SteeringBehaviors::Pipeline SteeringBehaviors::m_Pipelines[] = {
+
+	&SteeringBehaviors::SumForcesT<0>, &SteeringBehaviors::SumForcesT<1>, &SteeringBehaviors::SumForcesT<2>, &SteeringBehaviors::SumForcesT<3>,
+	&SteeringBehaviors::SumForcesT<4>, &SteeringBehaviors::SumForcesT<5>, &SteeringBehaviors::SumForcesT<6>, &SteeringBehaviors::SumForcesT<7>,
+	&SteeringBehaviors::SumForcesT<8>, &SteeringBehaviors::SumForcesT<9>, &SteeringBehaviors::SumForcesT<10>, &SteeringBehaviors::SumForcesT<11>,
+	&SteeringBehaviors::SumForcesT<12>, &SteeringBehaviors::SumForcesT<13>, &SteeringBehaviors::SumForcesT<14>, &SteeringBehaviors::SumForcesT<15>,
+	&SteeringBehaviors::SumForcesT<16>, &SteeringBehaviors::SumForcesT<17>, &SteeringBehaviors::SumForcesT<18>, &SteeringBehaviors::SumForcesT<19>,
+	&SteeringBehaviors::SumForcesT<20>, &SteeringBehaviors::SumForcesT<21>, &SteeringBehaviors::SumForcesT<22>, &SteeringBehaviors::SumForcesT<23>,
+	&SteeringBehaviors::SumForcesT<24>, &SteeringBehaviors::SumForcesT<25>, &SteeringBehaviors::SumForcesT<26>, &SteeringBehaviors::SumForcesT<27>,
+	&SteeringBehaviors::SumForcesT<28>, &SteeringBehaviors::SumForcesT<29>, &SteeringBehaviors::SumForcesT<30>, &SteeringBehaviors::SumForcesT<31>
+
+};
+
 //-------------------------------------ForwardComponent-------------------------------------
 //
 // Returns the forward component of the steering force
@@ -209,13 +237,12 @@ Vector2D SteeringBehaviors::Separation() {
 
 	//Iterate through all the neighbors and calculate the vector from.
 	Vector2D SteeringForce;
-	std::list<PlayerBase*>&AllPlayers = AutoList<PlayerBase>::GetAllMembers();
-	std::list<PlayerBase*>::iterator curPlyr;
+	std::vector<PlayerBase*>::const_iterator curPlyr;
 
-	for(curPlyr = AllPlayers.begin(); curPlyr != AllPlayers.end(); ++curPlyr){
+	for(curPlyr = m_Neighbours.begin(); curPlyr != m_Neighbours.end(); ++curPlyr){
 
-		//Make sure this agent isn't included in the calculations and that the agent being examined is close enough.
-		if ((*curPlyr != m_pPlayer) && (*curPlyr)->Steering()->Tagged()) {
+		//Make sure this agent isn't included in the calculations.
+		if (*curPlyr != m_pPlayer) {
 
 			Vector2D ToAgent = m_pPlayer->Pos() - (*curPlyr)->Pos();
 
@@ -244,23 +271,28 @@ Vector2D SteeringBehaviors::Interpose(const SoccerBall* ball, Vector2D target, d
 
 //------------------------------------FindNeighbours------------------------------------
 //
-//Tags any players within a predefined radius
+//Lists any players of either team within a predefined radius. Only this player's own
+//list is written so it is safe to call for several players at once.
 //
 //--------------------------------------------------------------------------------------
 void SteeringBehaviors::FindNeighbours() {
 
-	std::list<PlayerBase*>&AllPlayers = AutoList<PlayerBase>::GetAllMembers();
-	std::list<PlayerBase*>::iterator curPlyr;
+	m_Neighbours.clear();
+
+	const SoccerTeam* teams[2] = { m_pPlayer->Pitch()->RedTeam(), m_pPlayer->Pitch()->BlueTeam() };
 
-	for (curPlyr = AllPlayers.begin(); curPlyr != AllPlayers.end(); ++curPlyr) {
+	for (int t = 0; t < 2; ++t) {
 
-		//First clear any current tag
-		(*curPlyr)->Steering()->UnTag();
+		std::vector<PlayerBase*>::const_iterator curPlyr;
 
-		//Work in distance squared to avoid sqrts
-		Vector2D to = (*curPlyr)->Pos() - m_pPlayer->Pos();
+		for (curPlyr = teams[t]->Members().begin(); curPlyr != teams[t]->Members().end(); ++curPlyr) {
 
-		if (to.LengthSq() < (m_dViewDistance * m_dViewDistance)) (*curPlyr)->Steering()->Tag();
+			//Work in distance squared to avoid sqrts
+			Vector2D to = (*curPlyr)->Pos() - m_pPlayer->Pos();
+
+			if (to.LengthSq() < (m_dViewDistance * m_dViewDistance)) m_Neighbours.push_back(*curPlyr);
+
+		}
 
 	}
 
@@ -24,6 +24,19 @@ class CObstacle;
 
 class SteeringBehaviors {
 
+public:
+	//The behaviors, as bits of the flags. SteeringBatch reads them too.
+	enum behavior_type {
+
+		none = 0x0000,
+		seek = 0x0001,
+		arrive = 0x0002,
+		separation = 0x0004,
+		pursuit = 0x0008,
+		interpose = 0x0010
+
+	};
+
 private:
 
 	PlayerBase* m_pPlayer;
@@ -47,19 +60,12 @@ private:
 	//Binary flags to indicate whether or not a behavior should be active
 	int m_iFlags;
 
-	enum behavior_type {
+	//The tick the force was handed in by SetForce, or -1.
+	int m_iForceTick;
 
-		none = 0x0000,
-		seek = 0x0001,
-		arrive = 0x0002,
-		separation = 0x0004,
-		pursuit = 0x0008,
-		interpose = 0x0010
-
-	};
-
-	//Used by group behaviors to tag neighbours
-	bool m_bTagged;
+	//The players within view distance, found at the start of each calculation. Each player keeps
+	//its own list so the players of a pitch can calculate their forces at the same time.
+	std::vector<PlayerBase*> m_Neighbours;
 
 	//Arrive makes use of these to determine how quickly a vehicle should decelerate to its target
 	enum Deceleration { slow = 3, normal = 2, fast = 1 };
@@ -86,7 +92,23 @@ private:
 
 	bool AccumulateForce(Vector2D &sf, Vector2D ForceToAdd);
 
-	Vector2D SumForces();
+	//SumForces for one combination of behaviors. The flags are known at compile time, so the behaviors
+	//that are off are compiled out and the ones that are on run straight through.
+	template <int Flags>
+	Vector2D SumForcesT();
+
+	typedef Vector2D(SteeringBehaviors::*Pipeline)();
+
+	//SumForcesT for every combination of the flags, indexed by them.
+	static const Pipeline m_Pipelines[];
+
+	//The entry of m_Pipelines for the current flags.
+	Pipeline m_pSumForces;
+
+	//Switches the behaviors to the flags and picks their pipeline.
+	void SetFlags(int flags) { m_iFlags = flags; m_pSumForces = m_Pipelines[flags]; }
+
+	Vector2D SumForces() { return (this->*m_pSumForces)(); }
 
 	//A vertex buffer to contain the feelers rqd for dribbling
 	std::vector<Vector2D> m_Antenna;
@@ -95,9 +117,13 @@ public:
 	SteeringBehaviors(PlayerBase* agent, SoccerPitch* world, SoccerBall* ball);
 	//virtual ~SteeringBehaviors();
 
-	//Calculates and sums the steering forces from any active behaviors
+	//Calculates and sums the steering forces from any active behaviors. If a force has been handed in
+	//by SetForce this tick it is returned instead.
 	Vector2D Calculate();
 
+	//Hands in the force worked out for this tick by a SteeringBatch, so Calculate doesn't work it out again.
+	void SetForce(Vector2D force);
+
 	//Calculates the component of the steering force that is parallel with the vehicle heading
 	double ForwardComponent();
 
@@ -106,6 +132,9 @@ public:
 
 	Vector2D Force()const { return m_vSteeringForce; }
 
+	//Turns every behavior off and clears the force and the neighbours, as they are when the player is created.
+	void Reset() { SetFlags(none); m_vSteeringForce.Zero(); m_Neighbours.clear(); m_dInterposeDist = 0.0; m_iForceTick = -1; }
+
 	//Renders visual aids and info for seeing how each behavior is calculated
 	//void RenderInfo();
 	void RenderAids();
@@ -116,22 +145,21 @@ public:
 	double InterposeDistance()const { return m_dInterposeDist; }
 	void SetInterposeDistance(double d) { m_dInterposeDist = d; }
 
-	bool Tagged()const { return m_bTagged; }
-	void Tag() { m_bTagged = true; }
-	void UnTag() { m_bTagged = false; }
+	double SeparationMultiplier()const { return m_dMultSeparation; }
+	double ViewDistance()const { return m_dViewDistance; }
 
-	void SeekOn() { m_iFlags != seek; }
-	void ArriveOn() { m_iFlags != arrive; }
-	void PursuitOn() { m_iFlags != pursuit; }
-	void SeparationOn() { m_iFlags != separation; }
-	void InterposeOn(double d) { m_iFlags != interpose; m_dInterposeDist = d; }
+	void SeekOn() { SetFlags(m_iFlags | seek); }
+	void ArriveOn() { SetFlags(m_iFlags | arrive); }
+	void PursuitOn() { SetFlags(m_iFlags | pursuit); }
+	void SeparationOn() { SetFlags(m_iFlags | separation); }
+	void InterposeOn(double d) { SetFlags(m_iFlags | interpose); m_dInterposeDist = d; }
 
 
-	void SeekOff() { if (On(seek)) m_iFlags ^= seek; }
-	void ArriveOff() { if (On(arrive)) m_iFlags ^= arrive; }
-	void PursuitOff() { if (On(pursuit)) m_iFlags ^= pursuit; }
-	void SeparationOff() { if (On(separation)) m_iFlags ^= separation; }
-	void InterposeOff() { if (On(interpose)) m_iFlags ^= interpose; }
+	void SeekOff() { SetFlags(m_iFlags & ~seek); }
+	void ArriveOff() { SetFlags(m_iFlags & ~arrive); }
+	void PursuitOff() { SetFlags(m_iFlags & ~pursuit); }
+	void SeparationOff() { SetFlags(m_iFlags & ~separation); }
+	void InterposeOff() { SetFlags(m_iFlags & ~interpose); }
 
 	bool IsSeekOn() { return On(seek); }
 	bool IsArriveOn() { return On(arrive); }
@@ -139,6 +167,12 @@ public:
 	bool IsSeparationOn() { return On(separation); }
 	bool IsInterposeOn() { return On(interpose); }
 
+	//The behaviors that are on, as behavior_type bits.
+	int Flags()const { return m_iFlags; }
+
+	//Returns true if no behavior is on other than separation.
+	bool OnlySeparationOn()const { return (m_iFlags & ~separation) == 0; }
+
 
 };
 
@@ -1,20 +1,31 @@
 #include "Debug/DebugConsole.h"
+#include "misc/FastMath.h"
+#include "misc/utils.h"
 #include "time/Regulator.h"
 
 #include "constants.h"
 #include "Goal.h"
 #include "ParamLoader.h"
+#include "PassSafetyField.h"
+#include "PitchControl.h"
 #include "PlayerBase.h"
 #include "SoccerBall.h"
 #include "SoccerTeam.h"
 #include "SoccerPitch.h"
 #include "SupportSpotCalculator.h"
+#include "ThreadPool.h"
 
 SupportSpotCalculator::~SupportSpotCalculator() {
+
+	m_pTeam->Pitch()->TimeSlicer()->Cancel(this);
+
+	CancelBackgroundScan();
+
 	delete m_pRegulator;
+
 }
 
-SupportSpotCalculator::SupportSpotCalculator(int numX, int numY, SoccerTeam* team) :m_pBestSupportingSpot(NULL), m_pTeam(team) {
+SupportSpotCalculator::SupportSpotCalculator(int numX, int numY, SoccerTeam* team) :m_pBestSupportingSpot(NULL), m_pTeam(team), m_iBestScore(-1), m_iScoredTick(-1), m_pScoredController(NULL), m_pScoredSupporter(NULL), m_iScanSpot(-1), m_iScanBest(-1), m_dScanBestScore(0.0), m_iScanTick(-1), m_iAsyncBest(-1), m_bAsyncScanning(false), m_bAsyncDone(false), m_bAsyncCancel(false), m_iBestSpotTick(-1), m_iScansPublished(0), m_iTotalLatency(0), m_iMaxLatency(0) {
 
 	const Region* PlayingField = team->Pitch()->PlayingArea();
 
@@ -39,60 +50,442 @@ SupportSpotCalculator::SupportSpotCalculator(int numX, int numY, SoccerTeam* tea
 
 	}
 
+	m_Scores.assign(m_Spots.size(), 0.0);
+	m_ScanScores.assign(m_Spots.size(), 0.0);
+	m_AsyncScores.assign(m_Spots.size(), 0.0);
+
+	m_Snapshot.m_PassSafe.assign(m_Spots.size(), false);
+	m_Snapshot.m_Controlled.assign(m_Spots.size(), false);
+
 	//Create the regulator
 	m_pRegulator = new Regulator(Prm.SupportSpotUpdateFreq);
 
 }
 
+//------------------------------------------Reset------------------------------------------
+//
+//-----------------------------------------------------------------------------------------
+void SupportSpotCalculator::Reset() {
+
+	m_pBestSupportingSpot = NULL;
+
+	for (unsigned int spt = 0; spt < m_Spots.size(); ++spt) m_Spots[spt].m_dScore = 0.0;
+
+	m_iScoredTick = -1;
+
+	m_pTeam->Pitch()->TimeSlicer()->Cancel(this);
+	m_iScanSpot = -1;
+
+	CancelBackgroundScan();
+
+	m_iBestSpotTick = -1;
+	m_iScansPublished = 0;
+	m_iTotalLatency = 0;
+	m_iMaxLatency = 0;
+
+	m_pRegulator->Restart();
+
+}
+
 //-----------------------------DetermineBestSupportingPosition-----------------------------
 //
 //-----------------------------------------------------------------------------------------
 Vector2D SupportSpotCalculator::DetermineBestSupportingPosition() {
 
+	//A background scan is started when the regulator allows and the last published spot is used in the meantime.
+	if (Prm.bAsyncSupportSpots && m_pBestSupportingSpot) {
+
+		if (!IsScanningInBackground() && m_pTeam->ControllingPlayer() && m_pRegulator->isReady()) StartBackgroundScan();
+
+		return m_pBestSupportingSpot->m_vPos;
+
+	}
+
+	//A time sliced scan is started when the regulator allows and the last spot is used in the meantime.
+	if (Prm.bTimeSlicedSupportSpots && m_pBestSupportingSpot) {
+
+		if (!IsScanning() && m_pRegulator->isReady()) StartScan();
+
+		return m_pBestSupportingSpot->m_vPos;
+
+	}
+
 	//Only update the spots every few frames
 	if (!m_pRegulator->isReady() && m_pBestSupportingSpot) return m_pBestSupportingSpot->m_vPos;
 
-	//Reset the best supporting spot
-	m_pBestSupportingSpot = NULL;
+	//Score the spots unless they were scored earlier in the tick from the same pitch.
+	if (!IsPrescoreCurrent()) m_iBestScore = ScoreSpots(m_Scores);
+
+	m_iScoredTick = -1;
+
+	for (unsigned int spt = 0; spt < m_Spots.size(); ++spt) m_Spots[spt].m_dScore = m_Scores[spt];
+
+	m_pBestSupportingSpot = (m_iBestScore >= 0) ? &m_Spots[m_iBestScore] : NULL;
+	m_iBestSpotTick = m_pTeam->Pitch()->TickCount();
+
+	return m_pBestSupportingSpot->m_vPos;
+
+}
+
+//---------------------------------------ScoreSpots----------------------------------------
+//
+//-----------------------------------------------------------------------------------------
+int SupportSpotCalculator::ScoreSpots(std::vector<double>& scores)const {
+
+	int best = -1;
 
 	double BestScoreSoFar = 0.0;
-	std::vector<SupportSpot>::iterator curSpot;
-	for (curSpot = m_Spots.begin(); curSpot != m_Spots.end(); ++curSpot) {
+	for (unsigned int spt = 0; spt < m_Spots.size(); ++spt) {
+
+		double score = scores[spt] = ScoreSpot(spt);
+
+		//Check to see if this spot has the highest score so far.
+		if (score > BestScoreSoFar) {
+
+			BestScoreSoFar = score;
+			best = spt;
+
+		}
+
+	}
+
+	return best;
+
+}
+
+//----------------------------------------ScoreSpot----------------------------------------
+//
+//-----------------------------------------------------------------------------------------
+double SupportSpotCalculator::ScoreSpot(int spt)const {
+
+	const Vector2D& pos = m_Spots[spt].m_vPos;
+
+	//Test 1: is it possible to make a safe pass from the ball's position to this position?
+	bool PassSafe;
+
+	if (Prm.bPassSafetyField) PassSafe = m_pTeam->PassSafety()->IsSafe(pos);
+	else PassSafe = m_pTeam->IsPassSafeFromAllOpponents(m_pTeam->ControllingPlayer()->Pos(), pos, NULL, Prm.MaxPassingForce);
+
+	//Test 2: determine if a goal can be scored from this position.
+	bool CanScore = m_pTeam->CanShoot(pos, Prm.MaxShootingForce);
+
+	//Test 4: can a team member get to this spot before any opponent?
+	bool controlled = (Prm.Spot_PitchControlScore > 0.0) && m_pTeam->Pitch()->GetPitchControl()->IsControlledBy(m_pTeam, pos);
+
+	return SpotScore(pos, PassSafe, CanScore, m_pTeam->SupportingPlayer() != NULL, m_pTeam->ControllingPlayer()->Pos(), controlled);
+
+}
+
+//----------------------------------------SpotScore----------------------------------------
+//
+//-----------------------------------------------------------------------------------------
+double SupportSpotCalculator::SpotScore(Vector2D pos, bool PassSafe, bool CanScore, bool supporter, Vector2D ControllerPos, bool controlled) {
+
+	//First remove any previous score.
+	double score = 1.0;
+
+	if (PassSafe) score += Prm.Spot_PassSafeScore;
+
+	if (CanScore) score += Prm.Spot_CanScoreFromPositionScore;
+
+	//Test 3: calculate how far this spot is away from the controlling player. The further away, the higher the score.
+	//Any distances further away than OptimalDistance pixels do not receive a score.
+	if (supporter) {
+
+		const double OptimalDistance = 200.0; //TODO ?????
+		double dist = FastMath::Distance(ControllerPos, pos);
+		double temp = fabs(OptimalDistance - dist);
+
+		//Normalize the distance and add it to the score
+		if (temp < OptimalDistance) score += Prm.Spot_DistFromControllingPlayerScore * (OptimalDistance - temp) / OptimalDistance;
+
+	}
+
+	if (controlled) score += Prm.Spot_PitchControlScore;
+
+	return score;
+
+}
+
+//----------------------------------------StartScan----------------------------------------
+//
+//-----------------------------------------------------------------------------------------
+void SupportSpotCalculator::StartScan() {
+
+	m_iScanSpot = 0;
+	m_iScanBest = -1;
+	m_dScanBestScore = 0.0;
+	m_iScanTick = m_pTeam->Pitch()->TickCount();
+
+	m_pTeam->Pitch()->TimeSlicer()->Submit(this);
+
+}
+
+//-------------------------------------------Step------------------------------------------
+//
+// The spots are scored from the pitch as it is when their step runs, so the spots of one
+// scan may be scored a few updates apart.
+//-----------------------------------------------------------------------------------------
+bool SupportSpotCalculator::Step() {
+
+	if (!m_pTeam->ControllingPlayer()) {
+		m_iScanSpot = -1;
+		return true;
+	}
+
+	double score = m_ScanScores[m_iScanSpot] = ScoreSpot(m_iScanSpot);
+
+	if (score > m_dScanBestScore) {
+
+		m_dScanBestScore = score;
+		m_iScanBest = m_iScanSpot;
+
+	}
+
+	if (++m_iScanSpot < (int)m_Spots.size()) return false;
+
+	m_iScanSpot = -1;
+
+	if (m_iScanBest < 0) return true;
+
+	for (unsigned int spt = 0; spt < m_Spots.size(); ++spt) m_Spots[spt].m_dScore = m_ScanScores[spt];
+
+	m_pBestSupportingSpot = &m_Spots[m_iScanBest];
+	m_iBestSpotTick = m_iScanTick;
+
+	return true;
+
+}
+
+//-----------------------------------StartBackgroundScan-----------------------------------
+//
+// Runs on the main thread during the players' thinking, so the positions are the ones the
+// tick started with.
+//-----------------------------------------------------------------------------------------
+void SupportSpotCalculator::StartBackgroundScan() {
+
+	m_Snapshot.m_iTick = m_pTeam->Pitch()->TickCount();
+
+	m_Snapshot.m_vControllerPos = m_pTeam->ControllingPlayer()->Pos();
+	m_Snapshot.m_bSupporter = m_pTeam->SupportingPlayer() != NULL;
+
+	const SoccerBall* ball = m_pTeam->Pitch()->Ball();
+	const Goal* goal = m_pTeam->OpponentsGoal();
+
+	m_Snapshot.m_dBallMass = ball->Mass();
+	m_Snapshot.m_dBallRadius = ball->BRadius();
+
+	m_Snapshot.m_dGoalX = goal->Center().x;
+	m_Snapshot.m_dGoalMinY = MinOf(goal->LeftPost().y, goal->RightPost().y) + ball->BRadius();
+	m_Snapshot.m_dGoalMaxY = MaxOf(goal->LeftPost().y, goal->RightPost().y) - ball->BRadius();
+
+	m_Snapshot.m_Opponents.clear();
 
-		//First remove any previous score.
-		curSpot->m_dScore = 1.0;
+	std::vector<PlayerBase*>::const_iterator opp = m_pTeam->Opponents()->Members().begin();
+	for (; opp != m_pTeam->Opponents()->Members().end(); ++opp) m_Snapshot.m_Opponents.push_back(ShotOpponent((*opp)->Pos(), (*opp)->MaxSpeed(), (*opp)->BRadius()));
 
-		//Test 1: is it possible to make a safe pass from the ball's position to this position?
-		if (m_pTeam->IsPassSafeFromAllOpponents(m_pTeam->ControllingPlayer()->Pos(), curSpot->m_vPos, NULL, Prm.MaxPassingForce)) curSpot->m_dScore += Prm.Spot_PassSafeScore;
+	for (unsigned int spt = 0; spt < m_Spots.size(); ++spt) {
 
-		//Test 2: determine if a goal can be scored from this position.
-		if (m_pTeam->CanShoot(curSpot->m_vPos, Prm.MaxShootingForce)) curSpot->m_dScore += Prm.Spot_CanScoreFromPositionScore;
+		m_Snapshot.m_PassSafe[spt] = Prm.bPassSafetyField && m_pTeam->PassSafety()->IsSafe(m_Spots[spt].m_vPos);
+		m_Snapshot.m_Controlled[spt] = (Prm.Spot_PitchControlScore > 0.0) && m_pTeam->Pitch()->GetPitchControl()->IsControlledBy(m_pTeam, m_Spots[spt].m_vPos);
 
-		//Test 3: calculate how far this spot is away from the controlling player. The further away, the higher the score.
-		//Any distances further away than OptimalDistance pixels do not receive a score.
-		if (m_pTeam->SupportingPlayer()) {
+	}
+
+	m_bAsyncDone = false;
+	m_bAsyncCancel = false;
+	m_bAsyncScanning = true;
+
+	m_pTeam->Pitch()->ScanPool()->Submit(std::bind(&SupportSpotCalculator::RunBackgroundScan, this));
+
+}
+
+//------------------------------------RunBackgroundScan------------------------------------
+//-----------------------------------------------------------------------------------------
+void SupportSpotCalculator::RunBackgroundScan() {
 
-			const double OptimalDistance = 200.0; //TODO ?????
-			double dist = Vec2DDistance(m_pTeam->ControllingPlayer()->Pos(), curSpot->m_vPos);
-			double temp = fabs(OptimalDistance - dist);
+	int best = -1;
+
+	double BestScoreSoFar = 0.0;
+	for (unsigned int spt = 0; (spt < m_Spots.size()) && !m_bAsyncCancel; ++spt) {
+
+		double score = m_AsyncScores[spt] = ScoreSnapshotSpot(spt);
+
+		if (score > BestScoreSoFar) {
+
+			BestScoreSoFar = score;
+			best = spt;
 
-			//Normalize the distance and add it to the score
-			if (temp < OptimalDistance) curSpot->m_dScore += Prm.Spot_DistFromControllingPlayerScore * (OptimalDistance - temp) / OptimalDistance;
-		
 		}
 
-		//Check to see if this spot has the highest score so far.
-		if (curSpot->m_dScore > BestScoreSoFar) {
+	}
 
-			BestScoreSoFar = curSpot->m_dScore;
-			m_pBestSupportingSpot = &(*curSpot);
+	m_iAsyncBest = best;
+
+	//Signalled with the mutex held so a waiter can't miss it between checking the flag and sleeping.
+	{
+		std::lock_guard<std::mutex> lock(m_AsyncMutex);
+		m_bAsyncDone = true;
+		m_AsyncDone.notify_all();
+	}
+
+}
+
+//------------------------------------ScoreSnapshotSpot------------------------------------
+//-----------------------------------------------------------------------------------------
+double SupportSpotCalculator::ScoreSnapshotSpot(int spt) {
 
+	const Vector2D& pos = m_Spots[spt].m_vPos;
+
+	bool PassSafe = m_Snapshot.m_PassSafe[spt];
+
+	if (!Prm.bPassSafetyField) {
+
+		PassSafe = true;
+
+		for (unsigned int opp = 0; (opp < m_Snapshot.m_Opponents.size()) && PassSafe; ++opp) {
+			PassSafe = SoccerTeam::IsPassSafeFromOpponent(m_Snapshot.m_vControllerPos, pos, NULL, m_Snapshot.m_Opponents[opp], Prm.MaxPassingForce, m_Snapshot.m_dBallMass, m_Snapshot.m_dBallRadius);
 		}
 
-		return m_pBestSupportingSpot->m_vPos;
+	}
+
+	GetOpenShotIntervals(pos, Prm.MaxShootingForce / m_Snapshot.m_dBallMass, m_Snapshot.m_dBallRadius, Prm.Friction, m_Snapshot.m_dGoalX, m_Snapshot.m_dGoalMinY, m_Snapshot.m_dGoalMaxY, m_Snapshot.m_Opponents, m_AsyncShotIntervals);
+
+	bool CanScore = GetBestShotInterval(m_AsyncShotIntervals) != NULL;
+
+	return SpotScore(pos, PassSafe, CanScore, m_Snapshot.m_bSupporter, m_Snapshot.m_vControllerPos, m_Snapshot.m_Controlled[spt]);
+
+}
+
+//----------------------------------CollectBackgroundScan----------------------------------
+//
+// On the simulated clock the scan is published a fixed number of ticks after it started,
+// however long it took. That is the only time the main thread waits for it.
+//-----------------------------------------------------------------------------------------
+void SupportSpotCalculator::CollectBackgroundScan() {
+
+	if (!IsScanningInBackground()) return;
+
+	if (RegulatorClock::Simulated()) {
+		if (m_pTeam->Pitch()->TickCount() - m_Snapshot.m_iTick < Prm.AsyncSupportSpotSimulatedLatency) return;
+	}
+
+	else if (!m_bAsyncDone) return;
+
+	PublishBackgroundScan();
+
+}
+
+//----------------------------------WaitForBackgroundScan----------------------------------
+//-----------------------------------------------------------------------------------------
+void SupportSpotCalculator::WaitForBackgroundScan() {
+
+	std::unique_lock<std::mutex> lock(m_AsyncMutex);
+
+	while (!m_bAsyncDone) m_AsyncDone.wait(lock);
+
+}
+
+//----------------------------------PublishBackgroundScan----------------------------------
+//-----------------------------------------------------------------------------------------
+void SupportSpotCalculator::PublishBackgroundScan() {
+
+	WaitForBackgroundScan();
+
+	m_bAsyncScanning = false;
+
+	if (m_iAsyncBest < 0) return;
+
+	for (unsigned int spt = 0; spt < m_Spots.size(); ++spt) m_Spots[spt].m_dScore = m_AsyncScores[spt];
+
+	m_pBestSupportingSpot = &m_Spots[m_iAsyncBest];
+	m_iBestSpotTick = m_Snapshot.m_iTick;
+
+	int latency = m_pTeam->Pitch()->TickCount() - m_Snapshot.m_iTick;
+
+	++m_iScansPublished;
+	m_iTotalLatency += latency;
+	m_iMaxLatency = MaxOf(m_iMaxLatency, latency);
+
+}
+
+//-----------------------------------CancelBackgroundScan----------------------------------
+//-----------------------------------------------------------------------------------------
+void SupportSpotCalculator::CancelBackgroundScan() {
 
+	if (!IsScanningInBackground()) return;
+
+	m_bAsyncCancel = true;
+
+	WaitForBackgroundScan();
+
+	m_bAsyncScanning = false;
+
+}
+
+//----------------------------------------Staleness----------------------------------------
+//-----------------------------------------------------------------------------------------
+int SupportSpotCalculator::Staleness()const {
+
+	if (!m_pBestSupportingSpot) return 0;
+
+	return m_pTeam->Pitch()->TickCount() - m_iBestSpotTick;
+
+}
+
+//---------------------------------------MeanLatency---------------------------------------
+//-----------------------------------------------------------------------------------------
+double SupportSpotCalculator::MeanLatency()const {
+
+	if (m_iScansPublished == 0) return 0.0;
+
+	return (double)m_iTotalLatency / m_iScansPublished;
+
+}
+
+//-----------------------------------------IsDue-------------------------------------------
+//
+//-----------------------------------------------------------------------------------------
+bool SupportSpotCalculator::IsDue()const {
+
+	//Time sliced and background scans are scored away from the players' thinking instead.
+	if (Prm.bTimeSlicedSupportSpots || Prm.bAsyncSupportSpots) return !m_pBestSupportingSpot;
+
+	return !m_pBestSupportingSpot || m_pRegulator->isDue();
+
+}
+
+//----------------------------------------Prescore-----------------------------------------
+//
+//-----------------------------------------------------------------------------------------
+void SupportSpotCalculator::Prescore() {
+
+	m_iBestScore = ScoreSpots(m_Scores);
+
+	m_iScoredTick = m_pTeam->Pitch()->TickCount();
+	m_pScoredController = m_pTeam->ControllingPlayer();
+	m_pScoredSupporter = m_pTeam->SupportingPlayer();
+
+	m_ScoredOppSpeeds.clear();
+
+	std::vector<PlayerBase*>::const_iterator opp = m_pTeam->Opponents()->Members().begin();
+	for (; opp != m_pTeam->Opponents()->Members().end(); ++opp) m_ScoredOppSpeeds.push_back((*opp)->MaxSpeed());
+
+}
+
+//------------------------------------IsPrescoreCurrent------------------------------------
+//
+//-----------------------------------------------------------------------------------------
+bool SupportSpotCalculator::IsPrescoreCurrent()const {
+
+	if ((m_iScoredTick != m_pTeam->Pitch()->TickCount()) || (m_pScoredController != m_pTeam->ControllingPlayer()) || (m_pScoredSupporter != m_pTeam->SupportingPlayer())) return false;
+
+	//A player's top speed depends on whether the ball is within reach, which its state machine decides.
+	for (unsigned int opp = 0; opp < m_ScoredOppSpeeds.size(); ++opp) {
+		if (m_pTeam->Opponents()->Members()[opp]->MaxSpeed() != m_ScoredOppSpeeds[opp]) return false;
 	}
 
+	return true;
+
 }
 
 //----------------------------------GetBestSupportingSpot----------------------------------
@@ -7,12 +7,31 @@
 //
 //  Desc: Class determine the best spots for a supporting soccer player to move to.
 //
+//        With bTimeSlicedSupportSpots set the spots are rescored as a job of the
+//        pitch's TimeSliceScheduler, a spot per step, and the best spot found by
+//        the last finished scan is used until the next one finishes. Only the
+//        very first scan is done all at once.
+//
+//        With bAsyncSupportSpots set the spots are scored on the pitch's scan
+//        thread instead, from a snapshot of the pitch taken when the scan
+//        starts, and the best spot is published once the tick it finishes
+//        on is over. Until then the last published spot is used, so the
+//        update never waits for a scan. On the simulated clock a scan is
+//        published AsyncSupportSpotSimulatedLatency ticks after it started,
+//        waiting for it if need be, so batch matches don't depend on how
+//        fast the machine is. This takes the place of the time slicing.
+//
 //------------------------------------------------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <vector>
 
 #include "2D/Vector2D.h"
 #include "Game/Region.h"
 #include "misc/Cgdi.h"
+#include "ShotSolver.h"
+#include "TimeSliceScheduler.h"
 
 class PlayerBase;
 class Goal;
@@ -20,7 +39,7 @@ class SoccerBall;
 class SoccerTeam;
 class Regulator;
 
-class SupportSpotCalculator {
+class SupportSpotCalculator : public TimeSlicedJob {
 
 private:
 	//A data structure to hold the values and positions of each spot
@@ -32,6 +51,31 @@ private:
 
 	};
 
+	//What a background scan scores the spots from. The pass safety field and the pitch control map are looked up
+	//for every spot when the snapshot is taken, the rest is worked out on the scan's thread. The ball and the goal
+	//are copied too so the scan never reads the pitch, which may be deleted while it runs.
+	struct ScanSnapshot {
+
+		int m_iTick;
+
+		Vector2D m_vControllerPos;
+		bool m_bSupporter;
+
+		double m_dBallMass;
+		double m_dBallRadius;
+
+		//The goal line and the ends of the part of it the ball fits in.
+		double m_dGoalX;
+		double m_dGoalMinY;
+		double m_dGoalMaxY;
+
+		std::vector<ShotOpponent> m_Opponents;
+
+		std::vector<bool> m_PassSafe;
+		std::vector<bool> m_Controlled;
+
+	};
+
 private:
 	SoccerTeam* m_pTeam;
 	std::vector<SupportSpot> m_Spots;
@@ -42,6 +86,81 @@ private:
 	//This will regulate how often the spots are calculated (default is one update per second)
 	Regulator* m_pRegulator;
 
+	//Scores worked out by Prescore, and the index of the best of them.
+	std::vector<double> m_Scores;
+	int m_iBestScore;
+
+	//What the scores were worked out from. They are only used if the controlling and supporting
+	//players are still the same during the same tick. The opponents' top speeds are kept as well
+	//because their state machines can change them between Prescore and the players' thinking.
+	int m_iScoredTick;
+	const PlayerBase* m_pScoredController;
+	const PlayerBase* m_pScoredSupporter;
+	std::vector<double> m_ScoredOppSpeeds;
+
+	//The scores of a time sliced scan, the next spot it will score (-1 if there is no scan going on), and the
+	//best spot and score it has found so far.
+	std::vector<double> m_ScanScores;
+	int m_iScanSpot;
+	int m_iScanBest;
+	double m_dScanBestScore;
+	int m_iScanTick;
+
+	//The snapshot of the background scan, the scores it works out and the index of the best of them, and the
+	//open parts of the goal it found for the spot it is scoring. m_bAsyncScanning is true from when the scan
+	//is submitted until it is published or cancelled. m_bAsyncDone is set by the scan thread when it has
+	//finished, with m_AsyncMutex held, and m_AsyncDone is signalled. m_bAsyncCancel asks it to stop early.
+	ScanSnapshot m_Snapshot;
+	std::vector<double> m_AsyncScores;
+	int m_iAsyncBest;
+	std::vector<ShotInterval> m_AsyncShotIntervals;
+	bool m_bAsyncScanning;
+	std::atomic<bool> m_bAsyncDone;
+	std::atomic<bool> m_bAsyncCancel;
+	std::mutex m_AsyncMutex;
+	std::condition_variable m_AsyncDone;
+
+	//The tick the pitch was at when the best spot was scored from it.
+	int m_iBestSpotTick;
+
+	//Number of background scans published, and the sum and the most of the ticks from their snapshots to
+	//their publication.
+	int m_iScansPublished;
+	int m_iTotalLatency;
+	int m_iMaxLatency;
+
+	//Scores every spot into 'scores' and returns the index of the best one.
+	int ScoreSpots(std::vector<double>& scores)const;
+
+	double ScoreSpot(int spt)const;
+
+	//True if the scores from Prescore were worked out from the pitch as it is now.
+	bool IsPrescoreCurrent()const;
+
+	//Adds up the score of a spot from the answers to its tests. ControllerPos is only used if there is a
+	//supporting player.
+	static double SpotScore(Vector2D pos, bool PassSafe, bool CanScore, bool supporter, Vector2D ControllerPos, bool controlled);
+
+	//Queues a time sliced scan.
+	void StartScan();
+
+	//Takes the snapshot and submits a background scan to the pitch's scan thread.
+	void StartBackgroundScan();
+
+	//The background scan. Only reads the snapshot and the spot positions.
+	void RunBackgroundScan();
+
+	double ScoreSnapshotSpot(int spt);
+
+	//Blocks until the background scan has finished.
+	void WaitForBackgroundScan();
+
+	//Waits for the background scan and makes its best spot the one to use.
+	void PublishBackgroundScan();
+
+	SupportSpotCalculator(const SupportSpotCalculator&);
+	SupportSpotCalculator& operator=(const SupportSpotCalculator&);
+
 public:
 	SupportSpotCalculator(int numX, int numY, SoccerTeam* team);
 	~SupportSpotCalculator();
@@ -53,10 +172,41 @@ public:
 	//This method iterates through each possible spot and calculates its score.
 	Vector2D DetermineBestSupportingPosition();
 
+	//True if the next call to DetermineBestSupportingPosition will score the spots.
+	bool IsDue()const;
+
+	//Scores the spots now so that DetermineBestSupportingPosition can use the scores later in the tick.
+	//Only reads the pitch so it can run on any thread, as long as nothing moves at the same time.
+	void Prescore();
+
 	//Returns the best supporting spot if there is one. If one hasn't been calculated yet,
 	//this method calls DetermineBestSupportingPosiion and returns the result.
 	Vector2D GetBestSupportingSpot();
 
+	//Forgets the scores and the best spot and restarts the regulator.
+	void Reset();
+
+	//Scores the next spot of a time sliced scan, and makes the best spot the one to use once all of them are scored.
+	//A scan is dropped if the team loses the ball.
+	bool Step();
+
+	bool IsScanning()const { return m_iScanSpot >= 0; }
+
+	bool IsScanningInBackground()const { return m_bAsyncScanning; }
+
+	//Publishes the background scan if it is done. Called by the team at the end of each tick.
+	void CollectBackgroundScan();
+
+	//Stops the background scan, if there is one, without publishing it.
+	void CancelBackgroundScan();
+
+	//Number of ticks since the pitch the best spot was scored from. 0 if there is no best spot yet.
+	int Staleness()const;
+
+	int ScansPublished()const { return m_iScansPublished; }
+	double MeanLatency()const;
+	int MaxLatency()const { return m_iMaxLatency; }
+
 };
 
 #endif
@@ -0,0 +1,156 @@
+#include <cassert>
+#include <ostream>
+
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+
+TaskGraph::TaskGraph() :m_pPool(NULL), m_iRemaining(0) {}
+
+TaskGraph::~TaskGraph() {
+
+	for (unsigned int n = 0; n < m_Nodes.size(); ++n) delete m_Nodes[n];
+
+}
+
+//----------------------------------------AddTask---------------------------------------
+//---------------------------------------------------------------------------------------
+int TaskGraph::AddTask(const std::string& name, const Work& work, bool MainThread) {
+
+	m_Nodes.push_back(new Node(name, work, MainThread));
+
+	return (int)m_Nodes.size() - 1;
+
+}
+
+//-------------------------------------AddDependency------------------------------------
+//
+// Only allowing a task to wait for an earlier one keeps the graph free of cycles and
+// makes the order the tasks were added in a valid order to run them in.
+//---------------------------------------------------------------------------------------
+void TaskGraph::AddDependency(int before, int after) {
+
+	assert((before >= 0) && (before < after) && (after < (int)m_Nodes.size()) && "<TaskGraph::AddDependency>: a task can only wait for one added before it");
+
+	m_Nodes[before]->m_Successors.push_back(after);
+	++m_Nodes[after]->m_iNumDependencies;
+
+}
+
+//------------------------------------------Run-----------------------------------------
+//---------------------------------------------------------------------------------------
+void TaskGraph::Run(ThreadPool* pool) {
+
+	if (!pool) {
+
+		for (unsigned int n = 0; n < m_Nodes.size(); ++n) m_Nodes[n]->m_Work();
+		return;
+
+	}
+
+	m_pPool = pool;
+	m_MainReady.clear();
+	m_iRemaining = (int)m_Nodes.size();
+
+	//All the counts must be set before the first task can finish and lower them.
+	for (unsigned int n = 0; n < m_Nodes.size(); ++n) m_Nodes[n]->m_iWaitingFor = m_Nodes[n]->m_iNumDependencies;
+
+	for (unsigned int n = 0; n < m_Nodes.size(); ++n) {
+		if (m_Nodes[n]->m_iNumDependencies == 0) Schedule(n, -1);
+	}
+
+	//Run the main thread tasks as they become ready until everything has finished.
+	std::unique_lock<std::mutex> lock(m_Mutex);
+
+	while (m_iRemaining > 0) {
+
+		if (m_MainReady.empty()) {
+			m_Changed.wait(lock);
+			continue;
+		}
+
+		int node = m_MainReady.front();
+		m_MainReady.pop_front();
+
+		lock.unlock();
+
+		m_Nodes[node]->m_Work();
+		Finish(node, -1);
+
+		lock.lock();
+
+	}
+
+	m_pPool = NULL;
+
+}
+
+//----------------------------------------Schedule--------------------------------------
+//---------------------------------------------------------------------------------------
+void TaskGraph::Schedule(int node, int worker) {
+
+	if (m_Nodes[node]->m_bMainThread) {
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_MainReady.push_back(node);
+		m_Changed.notify_all();
+
+		return;
+
+	}
+
+	ThreadPool::Task task = std::bind(&TaskGraph::RunOnWorker, this, node, std::placeholders::_1);
+
+	//A worker keeps the tasks it releases. The others steal them if they have nothing to do.
+	if (worker >= 0) m_pPool->Submit(task, worker);
+	else m_pPool->Submit(task);
+
+}
+
+//--------------------------------------RunOnWorker-------------------------------------
+//---------------------------------------------------------------------------------------
+void TaskGraph::RunOnWorker(int node, int worker) {
+
+	m_Nodes[node]->m_Work();
+	Finish(node, worker);
+
+}
+
+//-----------------------------------------Finish---------------------------------------
+//---------------------------------------------------------------------------------------
+void TaskGraph::Finish(int node, int worker) {
+
+	const std::vector<int>& successors = m_Nodes[node]->m_Successors;
+
+	for (unsigned int s = 0; s < successors.size(); ++s) {
+		if (--m_Nodes[successors[s]]->m_iWaitingFor == 0) Schedule(successors[s], worker);
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (--m_iRemaining == 0) m_Changed.notify_all();
+
+}
+
+//----------------------------------------WriteDot--------------------------------------
+//---------------------------------------------------------------------------------------
+void TaskGraph::WriteDot(std::ostream& os, const std::string& name)const {
+
+	os << "digraph \"" << name << "\" {\n";
+
+	for (unsigned int n = 0; n < m_Nodes.size(); ++n) {
+
+		os << "  n" << n << " [label=\"" << m_Nodes[n]->m_Name << "\"";
+		if (m_Nodes[n]->m_bMainThread) os << ", shape=box";
+		os << "];\n";
+
+	}
+
+	for (unsigned int n = 0; n < m_Nodes.size(); ++n) {
+
+		const std::vector<int>& successors = m_Nodes[n]->m_Successors;
+		for (unsigned int s = 0; s < successors.size(); ++s) os << "  n" << n << " -> n" << successors[s] << ";\n";
+
+	}
+
+	os << "}\n";
+
+}
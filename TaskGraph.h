@@ -0,0 +1,103 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: TaskGraph.h
+//
+//  Desc: A set of named tasks and the order some of them have to run in.
+//        The graph is built once and can then be run any number of times.
+//        Given a thread pool, a task is handed to the pool as soon as every
+//        task it depends on has finished, so tasks that don't depend on
+//        each other run at the same time. Without a pool the tasks run one
+//        after the other in the order they were added.
+//
+//        Tasks marked as main thread tasks always run on the thread calling
+//        Run. Anything using the message dispatcher, the entity manager, the
+//        regulators or rand() has to be one, since those are per thread.
+//
+//------------------------------------------------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+class TaskGraph {
+
+public:
+	typedef std::function<void()> Work;
+
+private:
+	struct Node {
+
+		std::string m_Name;
+		Work m_Work;
+		bool m_bMainThread;
+
+		//The tasks waiting for this one.
+		std::vector<int> m_Successors;
+
+		int m_iNumDependencies;
+
+		//Dependencies not finished yet during a run.
+		std::atomic<int> m_iWaitingFor;
+
+		Node(const std::string& name, const Work& work, bool MainThread) :m_Name(name), m_Work(work), m_bMainThread(MainThread), m_iNumDependencies(0), m_iWaitingFor(0) {}
+
+	};
+
+	std::vector<Node*> m_Nodes;
+
+	//The pool of the current run.
+	ThreadPool* m_pPool;
+
+	//Guards the two members below. The thread calling Run sleeps on it.
+	std::mutex m_Mutex;
+	std::condition_variable m_Changed;
+
+	//Main thread tasks ready to run.
+	std::deque<int> m_MainReady;
+
+	//Tasks of the current run not finished yet.
+	int m_iRemaining;
+
+	//Hands a task whose dependencies have finished to whoever runs it. 'worker' is the
+	//pool worker doing the handing over, or -1 for the thread calling Run.
+	void Schedule(int node, int worker);
+
+	//Runs a task on a pool worker.
+	void RunOnWorker(int node, int worker);
+
+	//Releases the tasks waiting for the node.
+	void Finish(int node, int worker);
+
+	TaskGraph(const TaskGraph&);
+	TaskGraph& operator=(const TaskGraph&);
+
+public:
+	TaskGraph();
+	~TaskGraph();
+
+	//Adds a task and returns its index.
+	int AddTask(const std::string& name, const Work& work, bool MainThread = false);
+
+	//Makes 'after' wait for 'before'. 'before' must have been added first.
+	void AddDependency(int before, int after);
+
+	//Runs every task once and returns when all of them have finished.
+	void Run(ThreadPool* pool);
+
+	int NumTasks()const { return (int)m_Nodes.size(); }
+
+	//Writes the graph in the Graphviz dot format. Main thread tasks are drawn as boxes.
+	void WriteDot(std::ostream& os, const std::string& name)const;
+
+};
+
+#endif // TASKGRAPH_H
@@ -1,6 +1,6 @@
 #include "Debug/DebugConsole.h"
 #include "Messaging/MessageDispatcher.h"
-#include "constants.h"
+#include "FormationLoader.h"
 #include "PlayerBase.h"
 #include "SoccerMessages.h"
 #include "SoccerPitch.h"
@@ -10,9 +10,9 @@
 //Uncomment to send state info to debug window.
 //#define DEBUG_TEAM_STATES
 
-void ChangePlayerHomeRegions(SoccerTeam* team, const int NewRegions[TeamSize]) {
+void ChangePlayerHomeRegions(SoccerTeam* team, FormationLoader::formation NewFormation) {
 
-	for (int plyr = 0; plyr < TeamSize; ++plyr) team->SetPlayerHomeRegion(plyr, NewRegions[plyr]);
+	for (int plyr = 0; plyr < (int)team->Members().size(); ++plyr) team->SetPlayerHomeRegion(plyr, Frm.HomeRegion(team, NewFormation, plyr));
 
 }
 
@@ -34,6 +34,11 @@ void PrepareForKickOff::Enter(SoccerTeam* team) {
 
 	//Send Msg_GoHome to each player.
 	team->ReturnAllFieldPlayersToHome();
+
+	//And to the goalkeeper, who may have been about to put the ball back in play from where it was.
+	for (unsigned int plyr = 0; plyr < team->Members().size(); ++plyr) {
+		if (team->Members()[plyr]->Role() == PlayerBase::goal_keeper) Dispatcher->DispatchMsg(SEND_MSG_IMMEDIATELY, 1, team->Members()[plyr]->ID(), Msg_GoHome, NULL);
+	}
 
 }
 
@@ -62,13 +67,8 @@ void Defending::Enter(SoccerTeam* team) {
 		debug_con << team->Name() << " entering Defending state" << "";
 	#endif
 
-	//These define the home regions for this state of each of the players.
-	const int BlueRegions[TeamSize] = { 1,6,8,3,5 };
-	const int RedRegions[TeamSize] = { 16,9,11,12,14 };
-
-	//Setup the player's home regions.
-	if (team->Color() == SoccerTeam::blue) ChangePlayerHomeRegions(team, BlueRegions);
-	else ChangePlayerHomeRegions(team, RedRegions);
+	//Setup the player's home regions from the defending formation.
+	ChangePlayerHomeRegions(team, FormationLoader::defending);
 
 	//If a player is in either the Wait or ReturnToHomeRegion states, its steering target must be updated
 	//to that of its new home region to enable it to move into the correct position.
@@ -78,8 +78,8 @@ void Defending::Enter(SoccerTeam* team) {
 
 void Defending::Execute(SoccerTeam* team) {
 
-	//If this team is no longer in control change states
-	if (!team->InControl()) {
+	//If this team has taken control change states
+	if (team->InControl()) {
 		team->GetFSM()->ChangeState(Attacking::Instance());
 		return;
 	}
@@ -102,13 +102,8 @@ void Attacking::Enter(SoccerTeam* team) {
 	debug_con << team->Name() << " entering Attacking state" << "";
 #endif
 
-	//These define the home regions for this state of each of the players.
-	const int BlueRegions[TeamSize] = { 1,12,14,6,4 };
-	const int RedRegions[TeamSize] = { 16,3,5,9,13 };
-
-	//Setup the player's home regions.
-	if (team->Color() == SoccerTeam::blue) ChangePlayerHomeRegions(team, BlueRegions);
-	else ChangePlayerHomeRegions(team, RedRegions);
+	//Setup the player's home regions from the attacking formation.
+	ChangePlayerHomeRegions(team, FormationLoader::attacking);
 
 	//If a player is in either the Wait or ReturnToHomeRegion states, its steering target must be updated
 	//to that of its new home region to enable it to move into the correct position.
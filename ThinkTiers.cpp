@@ -0,0 +1,149 @@
+#include "misc/utils.h"
+
+#include "ParamLoader.h"
+#include "PlayerBase.h"
+#include "SoccerPitch.h"
+#include "SoccerTeam.h"
+#include "ThinkTiers.h"
+
+ThinkTiers::ThinkTiers(SoccerTeam* team) :m_pTeam(team) {
+
+	m_Tiers.resize(team->Members().size());
+	m_Woken.resize(team->Members().size());
+
+	Reset();
+
+}
+
+//----------------------------------------Reset-----------------------------------------
+//---------------------------------------------------------------------------------------
+void ThinkTiers::Reset() {
+
+	m_Tiers.assign(m_Tiers.size(), near_tier);
+	m_Woken.assign(m_Woken.size(), false);
+
+	ResetStatistics();
+
+}
+
+//---------------------------------------IndexOf----------------------------------------
+//---------------------------------------------------------------------------------------
+int ThinkTiers::IndexOf(const PlayerBase* const player)const {
+
+	return (player->Team() == m_pTeam) ? player->TeamIndex() : -1;
+
+}
+
+//-------------------------------------IsKeyPlayer--------------------------------------
+//---------------------------------------------------------------------------------------
+bool ThinkTiers::IsKeyPlayer(const PlayerBase* const player)const {
+
+	return (player->Role() == PlayerBase::goal_keeper) ||
+		(player == m_pTeam->ControllingPlayer()) ||
+		(player == m_pTeam->SupportingPlayer()) ||
+		(player == m_pTeam->Receiver()) ||
+		(player == m_pTeam->PlayerClosestToBall());
+
+}
+
+//----------------------------------------Assign----------------------------------------
+//
+// The distances to the ball were worked out by SoccerTeam::CalculateClosestPlayerToBall.
+//---------------------------------------------------------------------------------------
+void ThinkTiers::Assign() {
+
+	if (!Prm.bThinkTiers) return;
+
+	const std::vector<PlayerBase*>& Members = m_pTeam->Members();
+
+	for (unsigned int p = 0; p < Members.size(); ++p) {
+
+		double DistSq = Members[p]->DistSqToBall();
+
+		if (IsKeyPlayer(Members[p]) || (DistSq < Prm.ThinkTierNearRangeSq)) m_Tiers[p] = near_tier;
+		else if (DistSq < Prm.ThinkTierFarRangeSq) m_Tiers[p] = mid_tier;
+		else m_Tiers[p] = far_tier;
+
+		++m_iTierCounts[m_Tiers[p]];
+
+	}
+
+}
+
+//----------------------------------------IsDue-----------------------------------------
+//
+// The player's ID staggers the players of a tier across the updates.
+//---------------------------------------------------------------------------------------
+bool ThinkTiers::IsDue(const PlayerBase* const player) {
+
+	int p = IndexOf(player);
+
+	if (p < 0) {
+		++m_iThinks;
+		return true;
+	}
+
+	int interval = m_pTeam->Pitch()->DecisionInterval();
+
+	if (Prm.bThinkTiers && (m_Tiers[p] == mid_tier)) interval *= Prm.ThinkTierMidInterval;
+	else if (Prm.bThinkTiers && (m_Tiers[p] == far_tier)) interval *= Prm.ThinkTierFarInterval;
+
+	bool due = (interval <= 1) || ((m_pTeam->Pitch()->MatchTicks() + player->ID()) % interval == 0);
+
+	if (!due && m_Woken[p]) {
+		due = true;
+		++m_iWakes;
+	}
+
+	m_Woken[p] = false;
+
+	if (due) ++m_iThinks;
+	else ++m_iSkips;
+
+	return due;
+
+}
+
+//-----------------------------------------Wake-----------------------------------------
+//---------------------------------------------------------------------------------------
+void ThinkTiers::Wake(const PlayerBase* const player) {
+
+	int p = IndexOf(player);
+
+	if (p >= 0) m_Woken[p] = true;
+
+}
+
+//----------------------------------------TierOf----------------------------------------
+//---------------------------------------------------------------------------------------
+int ThinkTiers::TierOf(const PlayerBase* const player)const {
+
+	int p = IndexOf(player);
+
+	return (p < 0) ? near_tier : m_Tiers[p];
+
+}
+
+//---------------------------------------SkipRate---------------------------------------
+//---------------------------------------------------------------------------------------
+double ThinkTiers::SkipRate()const {
+
+	int total = m_iThinks + m_iSkips;
+
+	if (total == 0) return 0.0;
+
+	return (double)m_iSkips / total;
+
+}
+
+//-----------------------------------ResetStatistics------------------------------------
+//---------------------------------------------------------------------------------------
+void ThinkTiers::ResetStatistics() {
+
+	for (int t = 0; t < NumTiers; ++t) m_iTierCounts[t] = 0;
+
+	m_iThinks = 0;
+	m_iSkips = 0;
+	m_iWakes = 0;
+
+}
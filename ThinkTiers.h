@@ -0,0 +1,93 @@
+#ifndef THINKTIERS_H
+#define THINKTIERS_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: ThinkTiers.h
+//
+//  Desc: Level of detail for the thinking of a team's players. On each
+//        update the team decides on, every player is put in a tier by his
+//        part in play and his distance to the ball, and a player only runs
+//        his state machine on the updates his tier is due. Steering and
+//        movement still happen every update, so a player who skips a think
+//        carries on with what he last decided.
+//
+//        The key players (the controlling, supporting and receiving
+//        players and the one closest to the ball), the goal keeper and
+//        anyone within ThinkTierNearRange of the ball think every update.
+//        The rest think every ThinkTierMidInterval updates up to
+//        ThinkTierFarRange and every ThinkTierFarInterval updates beyond.
+//        The players of a tier take their turns on different updates, and
+//        a player who is sent a message thinks on the next update whatever
+//        his tier.
+//
+//        Every player is in the near tier unless bThinkTiers is set. All
+//        the intervals are multiplied by the pitch's decision interval,
+//        which is 1 unless DecisionRate is below FrameRate.
+//
+//------------------------------------------------------------------------
+#include <vector>
+
+class PlayerBase;
+class SoccerTeam;
+
+class ThinkTiers {
+
+public:
+	enum tier { near_tier, mid_tier, far_tier };
+
+	enum { NumTiers = 3 };
+
+private:
+	SoccerTeam* m_pTeam;
+
+	//The tier of each team member, in the order of the team's member list.
+	std::vector<int> m_Tiers;
+
+	//Set for a team member who has been sent a message since he last thought.
+	std::vector<bool> m_Woken;
+
+	//Number of times a player has been put in each tier.
+	int m_iTierCounts[NumTiers];
+
+	//Number of thinks run and skipped, and the number run only because of a message.
+	int m_iThinks;
+	int m_iSkips;
+	int m_iWakes;
+
+	//Returns the index of the player in the team's member list, or -1 if it isn't a member. Read off the player.
+	int IndexOf(const PlayerBase* const player)const;
+
+	bool IsKeyPlayer(const PlayerBase* const player)const;
+
+public:
+	ThinkTiers(SoccerTeam* team);
+
+	//Puts each team member in a tier. Call once per update, after the team has found the player closest to the ball.
+	void Assign();
+
+	//Returns true if the player is to think this update and counts the answer.
+	bool IsDue(const PlayerBase* const player);
+
+	//Makes the player think on his next chance.
+	void Wake(const PlayerBase* const player);
+
+	//The tier the player was put in this update.
+	int TierOf(const PlayerBase* const player)const;
+
+	int TierCount(int t)const { return m_iTierCounts[t]; }
+	int Thinks()const { return m_iThinks; }
+	int Skips()const { return m_iSkips; }
+	int Wakes()const { return m_iWakes; }
+
+	//Fraction of the thinks that were skipped.
+	double SkipRate()const;
+
+	void ResetStatistics();
+
+	//Forgets any messages as well.
+	void Reset();
+
+};
+
+#endif // THINKTIERS_H
@@ -0,0 +1,151 @@
+#include <cassert>
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int NumWorkers, const Task& OnWorkerExit) :m_OnWorkerExit(OnWorkerExit), m_iQueued(0), m_iPending(0), m_bQuit(false), m_iNextQueue(0), m_iNumSteals(0) {
+
+	assert((NumWorkers > 0) && "<ThreadPool::ThreadPool>: a pool needs at least one worker");
+
+	//All the queues must exist before any worker starts looking for tasks to steal.
+	for (int w = 0; w < NumWorkers; ++w) m_Queues.push_back(new WorkerQueue());
+
+	for (int w = 0; w < NumWorkers; ++w) m_Threads.push_back(std::thread(&ThreadPool::WorkerLoop, this, w));
+
+}
+
+ThreadPool::~ThreadPool() {
+
+	WaitForAll();
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bQuit = true;
+	}
+
+	m_WorkAvailable.notify_all();
+
+	for (unsigned int w = 0; w < m_Threads.size(); ++w) m_Threads[w].join();
+
+	for (unsigned int w = 0; w < m_Queues.size(); ++w) delete m_Queues[w];
+
+}
+
+//-----------------------------------------Submit---------------------------------------
+//---------------------------------------------------------------------------------------
+void ThreadPool::Submit(const Task& task) {
+
+	Submit(task, m_iNextQueue++ % m_Queues.size());
+
+}
+
+void ThreadPool::Submit(const Task& task, int worker) {
+
+	assert((worker >= 0) && (worker < (int)m_Queues.size()) && "<ThreadPool::Submit>: no such worker");
+
+	WorkerQueue* queue = m_Queues[worker];
+
+	{
+		std::lock_guard<std::mutex> lock(queue->m_Mutex);
+		queue->m_Tasks.push_back(task);
+	}
+
+	//The count is raised with m_Mutex held so a worker about to sleep can't miss it.
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		++m_iPending;
+		++m_iQueued;
+	}
+
+	m_WorkAvailable.notify_one();
+
+}
+
+//--------------------------------------WaitForAll--------------------------------------
+//---------------------------------------------------------------------------------------
+void ThreadPool::WaitForAll() {
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+
+	while (m_iPending > 0) m_AllDone.wait(lock);
+
+}
+
+//----------------------------------------PopTask---------------------------------------
+//
+// A worker takes the newest task from its own queue.
+//---------------------------------------------------------------------------------------
+bool ThreadPool::PopTask(int worker, Task& task) {
+
+	WorkerQueue* queue = m_Queues[worker];
+
+	std::lock_guard<std::mutex> lock(queue->m_Mutex);
+
+	if (queue->m_Tasks.empty()) return false;
+
+	task = queue->m_Tasks.back();
+	queue->m_Tasks.pop_back();
+	--m_iQueued;
+
+	return true;
+
+}
+
+//---------------------------------------StealTask--------------------------------------
+//
+// Looks through the other queues, starting with the next worker's, and takes the oldest
+// task of the first one that isn't empty.
+//---------------------------------------------------------------------------------------
+bool ThreadPool::StealTask(int worker, Task& task) {
+
+	for (unsigned int i = 1; i < m_Queues.size(); ++i) {
+
+		WorkerQueue* queue = m_Queues[(worker + i) % m_Queues.size()];
+
+		std::lock_guard<std::mutex> lock(queue->m_Mutex);
+
+		if (queue->m_Tasks.empty()) continue;
+
+		task = queue->m_Tasks.front();
+		queue->m_Tasks.pop_front();
+		--m_iQueued;
+		++m_iNumSteals;
+
+		return true;
+
+	}
+
+	return false;
+
+}
+
+//---------------------------------------WorkerLoop-------------------------------------
+//---------------------------------------------------------------------------------------
+void ThreadPool::WorkerLoop(int worker) {
+
+	while (true) {
+
+		Task task;
+
+		if (PopTask(worker, task) || StealTask(worker, task)) {
+
+			task(worker);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (--m_iPending == 0) m_AllDone.notify_all();
+
+			continue;
+
+		}
+
+		//Nothing to do. Sleep until a task is submitted or the pool is stopped.
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		while (!m_bQuit && (m_iQueued == 0)) m_WorkAvailable.wait(lock);
+
+		if (m_bQuit && (m_iQueued == 0)) break;
+
+	}
+
+	if (m_OnWorkerExit) m_OnWorkerExit(worker);
+
+}
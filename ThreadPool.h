@@ -0,0 +1,91 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: ThreadPool.h
+//
+//  Desc: A fixed number of worker threads running tasks with work stealing.
+//        Every worker has its own queue. Submitted tasks are dealt out to
+//        the queues in turn; a worker takes the newest task from its own
+//        queue and, when that is empty, steals the oldest task from the
+//        queue of another worker. Tasks are given the index of the worker
+//        running them so they can keep per-worker data.
+//
+//------------------------------------------------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+
+public:
+	typedef std::function<void(int)> Task;
+
+private:
+	struct WorkerQueue {
+
+		std::deque<Task> m_Tasks;
+		std::mutex m_Mutex;
+
+	};
+
+	std::vector<WorkerQueue*> m_Queues;
+	std::vector<std::thread> m_Threads;
+
+	//Called by each worker on its own thread just before it exits.
+	Task m_OnWorkerExit;
+
+	//Guards m_iPending and m_bQuit. Idle workers and WaitForAll sleep on it.
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+	std::condition_variable m_AllDone;
+
+	//Tasks submitted but not taken from a queue yet.
+	std::atomic<int> m_iQueued;
+
+	//Tasks submitted but not finished yet.
+	int m_iPending;
+
+	bool m_bQuit;
+
+	//The queue the next submitted task goes to.
+	std::atomic<unsigned int> m_iNextQueue;
+
+	//Number of tasks run by a worker other than the one they were given to.
+	std::atomic<int> m_iNumSteals;
+
+	bool PopTask(int worker, Task& task);
+	bool StealTask(int worker, Task& task);
+
+	void WorkerLoop(int worker);
+
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+public:
+	ThreadPool(int NumWorkers, const Task& OnWorkerExit = Task());
+
+	//Waits for the submitted tasks to finish before stopping the workers.
+	~ThreadPool();
+
+	void Submit(const Task& task);
+
+	//Puts the task on the given worker's own queue. A task submitting follow-on work uses this
+	//with its own index so the work stays on its thread unless another worker runs out.
+	void Submit(const Task& task, int worker);
+
+	//Blocks until every submitted task has finished.
+	void WaitForAll();
+
+	int NumWorkers()const { return (int)m_Threads.size(); }
+
+	int NumSteals()const { return m_iNumSteals; }
+
+};
+
+#endif // THREADPOOL_H
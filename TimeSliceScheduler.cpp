@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <chrono>
+
+#include "time/Regulator.h"
+
+#include "ParamLoader.h"
+#include "TimeSliceScheduler.h"
+
+TimeSliceScheduler::TimeSliceScheduler(double budget) :m_dBudget(budget) {
+
+	ResetStatistics();
+
+}
+
+//----------------------------------------Submit----------------------------------------
+//---------------------------------------------------------------------------------------
+void TimeSliceScheduler::Submit(TimeSlicedJob* job) {
+
+	if (!IsQueued(job)) m_Jobs.push_back(job);
+
+}
+
+//----------------------------------------Cancel----------------------------------------
+//---------------------------------------------------------------------------------------
+void TimeSliceScheduler::Cancel(TimeSlicedJob* job) {
+
+	m_Jobs.erase(std::remove(m_Jobs.begin(), m_Jobs.end(), job), m_Jobs.end());
+
+}
+
+//---------------------------------------IsQueued---------------------------------------
+//---------------------------------------------------------------------------------------
+bool TimeSliceScheduler::IsQueued(const TimeSlicedJob* job)const {
+
+	return std::find(m_Jobs.begin(), m_Jobs.end(), job) != m_Jobs.end();
+
+}
+
+//-----------------------------------------Run------------------------------------------
+//
+// The jobs take a step each in turn, so a long job doesn't hold up the ones behind it.
+//---------------------------------------------------------------------------------------
+void TimeSliceScheduler::Run() {
+
+	if (m_Jobs.empty()) return;
+
+	bool simulated = RegulatorClock::Simulated();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	double used = 0.0;
+
+	do {
+
+		TimeSlicedJob* job = m_Jobs.front();
+		m_Jobs.pop_front();
+
+		if (job->Step()) ++m_iJobsFinished;
+		else m_Jobs.push_back(job);
+
+		++m_iSteps;
+
+		if (simulated) used += Prm.TimeSliceSimulatedStepCost;
+		else used = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+	} while (!m_Jobs.empty() && (used < m_dBudget));
+
+	m_dLastUsed = used;
+	m_dMaxUsed = std::max(m_dMaxUsed, used);
+	m_dTotalUsed += used;
+	++m_iBusyTicks;
+
+}
+
+//-----------------------------------MeanUtilization------------------------------------
+//---------------------------------------------------------------------------------------
+double TimeSliceScheduler::MeanUtilization()const {
+
+	if (m_iBusyTicks == 0) return 0.0;
+
+	return m_dTotalUsed / (m_iBusyTicks * m_dBudget);
+
+}
+
+//-----------------------------------ResetStatistics------------------------------------
+//---------------------------------------------------------------------------------------
+void TimeSliceScheduler::ResetStatistics() {
+
+	m_dLastUsed = 0.0;
+	m_dMaxUsed = 0.0;
+	m_dTotalUsed = 0.0;
+	m_iBusyTicks = 0;
+	m_iSteps = 0;
+	m_iJobsFinished = 0;
+
+}
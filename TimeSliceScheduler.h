@@ -0,0 +1,87 @@
+#ifndef TIMESLICESCHEDULER_H
+#define TIMESLICESCHEDULER_H
+#pragma warning (disable:4786)
+//------------------------------------------------------------------------
+//
+//  Name: TimeSliceScheduler.h
+//
+//  Desc: Spreads long pieces of AI work over several updates. A job is
+//        split into small steps and handed to the scheduler, which runs
+//        the steps of its jobs in turn at the end of each update until
+//        the update's budget of TimeSliceBudget microseconds is spent,
+//        and carries on where it stopped on the next update. A job is
+//        dropped from the queue once its last step has run.
+//
+//        When the thread runs on the simulated clock (see RegulatorClock)
+//        every step is charged TimeSliceSimulatedStepCost microseconds
+//        instead of the time it took, so a batch match is sliced the same
+//        way on any machine.
+//
+//------------------------------------------------------------------------
+#include <deque>
+
+//A piece of work that can be done a step at a time.
+class TimeSlicedJob {
+
+public:
+	virtual ~TimeSlicedJob() {}
+
+	//Does the next step of the job. Returns true when the job is finished.
+	virtual bool Step() = 0;
+
+};
+
+class TimeSliceScheduler {
+
+private:
+	//The jobs waiting to be finished, the one to step next at the front.
+	std::deque<TimeSlicedJob*> m_Jobs;
+
+	//Microseconds of work allowed per update.
+	double m_dBudget;
+
+	//Statistics. The microseconds used by the last update that had work, and the most and the total
+	//used by any of them, the number of updates that had work, and the number of steps and jobs run.
+	double m_dLastUsed;
+	double m_dMaxUsed;
+	double m_dTotalUsed;
+	int m_iBusyTicks;
+	int m_iSteps;
+	int m_iJobsFinished;
+
+public:
+	TimeSliceScheduler(double budget);
+
+	//Queues the job. It must stay alive until it finishes or is cancelled.
+	void Submit(TimeSlicedJob* job);
+
+	//Takes the job off the queue if it is on it.
+	void Cancel(TimeSlicedJob* job);
+
+	//Takes every job off the queue.
+	void CancelAll() { m_Jobs.clear(); }
+
+	bool IsQueued(const TimeSlicedJob* job)const;
+
+	int NumJobs()const { return (int)m_Jobs.size(); }
+
+	//Steps the jobs until the budget is spent or there are none left. At least one step is run if there is
+	//a job, so a budget too small for any step still gets the jobs done.
+	void Run();
+
+	double Budget()const { return m_dBudget; }
+
+	//Fraction of the budget used by the last update that had work, and on average and at most by all of them.
+	double LastUtilization()const { return m_dLastUsed / m_dBudget; }
+	double MeanUtilization()const;
+	double MaxUtilization()const { return m_dMaxUsed / m_dBudget; }
+
+	int BusyTicks()const { return m_iBusyTicks; }
+	int Steps()const { return m_iSteps; }
+	int JobsFinished()const { return m_iJobsFinished; }
+
+	void ResetStatistics();
+
+};
+
+#endif // TIMESLICESCHEDULER_H
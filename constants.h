@@ -4,8 +4,5 @@
 const int WindowWidth = 700;
 const int WindowHeight = 400;
 
-//Defines the size of a team
-const int TeamSize = 5;
-
 #endif // !CONSTANTS_H
 
@@ -2,16 +2,25 @@
 
 #include <Windows.h>
 #include <time.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include "BatchRunner.h"
 #include "constants.h"
+#include "DecisionAgreement.h"
 #include "ParamLoader.h"
 #include "Resource.h"
 #include "SoccerPitch.h"
 #include "Debug/DebugConsole.h"
 #include "misc/Cgdi.h"
+#include "misc/FastMath.h"
 #include "misc/utils.h"
 #include "misc/WindowUtils.h"
 #include "time/PrecisionTimer.h"
+#include "time/Regulator.h"
 
 //GLOBALS
 char* g_szApplicationName = "SimpleSoccer";
@@ -19,9 +28,6 @@ char* g_szWindowClassName = "MyWindowClass";
 
 SoccerPitch* g_SoccerPitch;
 
-//Create a timer.
-PrecisionTimer timer(Prm.FrameRate);
-
 //Used when a user clicks on a menu item to ensure the option is 'checked' correctly.
 void CheckAllMenuItemsAppropriately(HWND hwnd) {
 
@@ -62,7 +68,9 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 			cyClient = rect.bottom;
 
 			//Seed random number generator
-			srand((unsigned)time(NULL));
+			DetMath::Use(Prm.bDeterministicMath);
+			FastMath::Use(Prm.bFastDecisionMath);
+			SeedRandom((unsigned)time(NULL));
 
 			//Create a surface to render to backbuffer
 			hdcBackBuffer = CreateCompatibleDC(NULL);
@@ -239,6 +247,277 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 
 }
 
+//----------------------------------------RunBatch----------------------------------------
+//
+// Plays matches without a window. The arguments following -batch on the command line are
+//
+//   NumMatches [FirstSeed] [NumWorkers] [ParamFile] [ResultFile]
+//
+// The matches are seeded with FirstSeed, FirstSeed + 1 and so on. NumWorkers defaults to
+// the number of hardware threads and ResultFile to BatchResults.csv.
+//----------------------------------------------------------------------------------------
+int RunBatch(std::istringstream& args) {
+
+	int NumMatches = 0;
+	unsigned int FirstSeed = 0;
+	int NumWorkers = (int)std::thread::hardware_concurrency();
+	std::string ParamFile = "Params.ini";
+	std::string ResultFile = "BatchResults.csv";
+
+	if (!(args >> NumMatches) || (NumMatches <= 0)) {
+
+		MessageBox(NULL, "Usage: -batch NumMatches [FirstSeed] [NumWorkers] [ParamFile] [ResultFile]", "Error", 0);
+		return 1;
+
+	}
+
+	args >> FirstSeed >> NumWorkers >> ParamFile >> ResultFile;
+
+	if (NumWorkers < 1) NumWorkers = 1;
+
+	//This must happen before anything reads a parameter.
+	ParamLoader::SetFileName(ParamFile);
+
+	std::vector<unsigned int> seeds;
+	for (int match = 0; match < NumMatches; ++match) seeds.push_back(FirstSeed + match);
+
+	std::vector<MatchResult> results;
+
+	BatchRunner* runner = new BatchRunner(NumWorkers, WindowWidth, WindowHeight);
+	runner->Run(seeds, results);
+	delete runner;
+
+	std::ofstream out(ResultFile.c_str());
+	BatchRunner::WriteResults(out, results);
+
+	//A stalled match means the players got stuck, so the batch doesn't count as a clean run.
+	int stalled = BatchRunner::NumStalled(results);
+
+	if (stalled > 0) {
+
+		MessageBox(NULL, (ttos(stalled) + " of " + ttos(NumMatches) + " matches stalled, see " + ResultFile).c_str(), "Error", 0);
+		return 1;
+
+	}
+
+	return 0;
+
+}
+
+//------------------------------------ComparePrecision------------------------------------
+//
+// Plays the same matches on match lanes in double and in single precision and writes
+// how the statistics of the two batches differ. The arguments following
+// -compareprecision on the command line are
+//
+//   NumMatches [FirstSeed] [NumWorkers] [ParamFile] [ReportFile]
+//
+// ReportFile defaults to PrecisionReport.csv. Both batches are moved the fast way, so
+// only the precision differs.
+//----------------------------------------------------------------------------------------
+int ComparePrecision(std::istringstream& args) {
+
+	int NumMatches = 0;
+	unsigned int FirstSeed = 0;
+	int NumWorkers = (int)std::thread::hardware_concurrency();
+	std::string ParamFile = "Params.ini";
+	std::string ReportFile = "PrecisionReport.csv";
+
+	if (!(args >> NumMatches) || (NumMatches <= 0)) {
+
+		MessageBox(NULL, "Usage: -compareprecision NumMatches [FirstSeed] [NumWorkers] [ParamFile] [ReportFile]", "Error", 0);
+		return 1;
+
+	}
+
+	args >> FirstSeed >> NumWorkers >> ParamFile >> ReportFile;
+
+	if (NumWorkers < 1) NumWorkers = 1;
+
+	ParamLoader::SetFileName(ParamFile);
+
+	std::vector<unsigned int> seeds;
+	for (int match = 0; match < NumMatches; ++match) seeds.push_back(FirstSeed + match);
+
+	if (!Prm.bDoubleBufferedUpdate) {
+
+		MessageBox(NULL, "ComparePrecision needs bDoubleBufferedUpdate", "Error", 0);
+		return 1;
+
+	}
+
+	BatchSettings settings;
+	settings.m_bMatchLanes = true;
+	settings.m_bFastMotion = true;
+
+	std::vector<MatchResult> reference;
+	std::vector<MatchResult> results;
+
+	//A runner keeps its workers' lanes, so each precision gets its own.
+	settings.m_bFloatLanes = false;
+
+	BatchRunner* runner = new BatchRunner(NumWorkers, WindowWidth, WindowHeight, settings);
+	runner->Run(seeds, reference);
+	delete runner;
+
+	settings.m_bFloatLanes = true;
+
+	runner = new BatchRunner(NumWorkers, WindowWidth, WindowHeight, settings);
+	runner->Run(seeds, results);
+	delete runner;
+
+	std::ofstream out(ReportFile.c_str());
+	BatchRunner::WriteComparison(out, reference, results);
+
+	return 0;
+
+}
+
+//-------------------------------------CompareResults-------------------------------------
+//
+// Writes how the statistics of two batches written by -batch differ. The batches can come
+// from different builds, so the ReleaseFloat build, which keeps the whole game in single
+// precision, can be compared with a double build. The arguments following -compareresults
+// on the command line are
+//
+//   ReferenceFile ResultFile [ReportFile]
+//
+// ReportFile defaults to ComparisonReport.csv.
+//----------------------------------------------------------------------------------------
+int CompareResults(std::istringstream& args) {
+
+	std::string ReferenceFile;
+	std::string ResultFile;
+	std::string ReportFile = "ComparisonReport.csv";
+
+	if (!(args >> ReferenceFile >> ResultFile)) {
+
+		MessageBox(NULL, "Usage: -compareresults ReferenceFile ResultFile [ReportFile]", "Error", 0);
+		return 1;
+
+	}
+
+	args >> ReportFile;
+
+	std::vector<MatchResult> reference;
+	std::vector<MatchResult> results;
+
+	std::ifstream ReferenceIn(ReferenceFile.c_str());
+	std::ifstream ResultIn(ResultFile.c_str());
+
+	if (!BatchRunner::ReadResults(ReferenceIn, reference) || !BatchRunner::ReadResults(ResultIn, results)) {
+
+		MessageBox(NULL, "CompareResults couldn't read the batch results", "Error", 0);
+		return 1;
+
+	}
+
+	std::ofstream out(ReportFile.c_str());
+	BatchRunner::WriteComparison(out, reference, results);
+
+	return 0;
+
+}
+
+//------------------------------------FastMathReport--------------------------------------
+//
+// Times the approximate math of FastMath against the exact math, then plays matches with
+// exact math and asks every player's pass and shot decisions both ways on every update.
+// The arguments following -fastmathreport on the command line are
+//
+//   NumMatches [FirstSeed] [ParamFile] [ReportFile]
+//
+// ReportFile defaults to FastMathReport.csv. The matches are played one after the other
+// until MatchTickLimit.
+//----------------------------------------------------------------------------------------
+int FastMathReport(std::istringstream& args) {
+
+	int NumMatches = 0;
+	unsigned int FirstSeed = 0;
+	std::string ParamFile = "Params.ini";
+	std::string ReportFile = "FastMathReport.csv";
+
+	if (!(args >> NumMatches) || (NumMatches <= 0)) {
+
+		MessageBox(NULL, "Usage: -fastmathreport NumMatches [FirstSeed] [ParamFile] [ReportFile]", "Error", 0);
+		return 1;
+
+	}
+
+	args >> FirstSeed >> ParamFile >> ReportFile;
+
+	ParamLoader::SetFileName(ParamFile);
+
+	if (Prm.MatchTickLimit <= 0) {
+
+		MessageBox(NULL, "FastMathReport needs a MatchTickLimit", "Error", 0);
+		return 1;
+
+	}
+
+	DetMath::Use(Prm.bDeterministicMath);
+
+	std::ofstream out(ReportFile.c_str());
+
+	DecisionAgreement::WriteBenchmark(out, 10000000);
+
+	out << "\n";
+
+	//The matches are played with exact math so they are the ones a batch would play.
+	FastMath::Use(false);
+
+	SoccerPitch* pitch = new SoccerPitch(WindowWidth, WindowHeight);
+	DecisionAgreement agreement;
+
+	const double TickMilliseconds = 1000.0 / Prm.FrameRate;
+
+	for (int match = 0; match < NumMatches; ++match) {
+
+		SeedRandom(FirstSeed + match);
+		RegulatorClock::UseSimulatedTime();
+
+		pitch->Reset();
+
+		while (pitch->MatchTicks() < Prm.MatchTickLimit) {
+
+			RegulatorClock::Advance(TickMilliseconds);
+			pitch->Update();
+
+			agreement.Sample(pitch);
+
+		}
+
+	}
+
+	delete pitch;
+
+	agreement.Write(out);
+
+	return 0;
+
+}
+
+//--------------------------------------WriteTaskGraph------------------------------------
+//
+// Writes the tasks of one update of the pitch, in the Graphviz dot format, to the file
+// following -taskgraph on the command line, or to TickGraph.dot.
+//----------------------------------------------------------------------------------------
+int WriteTaskGraph(std::istringstream& args) {
+
+	std::string DotFile = "TickGraph.dot";
+	args >> DotFile;
+
+	SoccerPitch* pitch = new SoccerPitch(WindowWidth, WindowHeight);
+
+	std::ofstream out(DotFile.c_str());
+	pitch->WriteTickGraph(out);
+
+	delete pitch;
+
+	return 0;
+
+}
+
 //----------------------------------------WndMain-----------------------------------------
 //
 // The entry point of the window program.
@@ -246,6 +525,18 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 //----------------------------------------------------------------------------------------
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR szCmdLine, int iCmdShow) {
 
+	//Play a batch of matches or write out the task graph instead of showing a match if asked to.
+	std::istringstream args(szCmdLine);
+	std::string mode;
+
+	if (args >> mode) {
+		if (mode == "-batch") return RunBatch(args);
+		if (mode == "-taskgraph") return WriteTaskGraph(args);
+		if (mode == "-compareprecision") return ComparePrecision(args);
+		if (mode == "-compareresults") return CompareResults(args);
+		if (mode == "-fastmathreport") return FastMathReport(args);
+	}
+
 	//Handle to our window
 	HWND hWnd;
 
@@ -280,7 +571,8 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR szCmdLine
 	//Mame sure the window creation has gone OK
 	if(!hWnd) MessageBox(NULL, "CreateWindowwEx failed!", "Error", 0);
 
-	//Start timer
+	//Create and start the timer.
+	PrecisionTimer timer(Prm.FrameRate);
 	timer.Start();
 
 	MSG msg;
@@ -0,0 +1,291 @@
+#ifndef DETMATH_H
+#define DETMATH_H
+//------------------------------------------------------------------------
+//
+//  Name:   DetMath.h
+//
+//  Desc:   sin, cos, tan, acos and atan2 worked out with nothing but +,
+//          -, *, / and sqrt, which IEEE 754 rounds exactly, and a random
+//          number generator that is fully specified here instead of by the C
+//          runtime. The library versions of these differ from one compiler
+//          and runtime to the next, so the same seed can play a different
+//          match elsewhere. These give the same bits on every x64 build,
+//          provided the compiler neither fuses a*b+c into one instruction
+//          nor keeps intermediates at extended precision (SSE2 code never
+//          does). The project builds with /fp:precise and this header
+//          switches contraction off for the rest of any file including it
+//          with MSVC and Clang. GCC ignores the pragma, so build with
+//          -ffp-contract=off there.
+//
+//          DetMath::Sin and friends call the library functions until
+//          DetMath::Use(true) is called, so the game plays exactly as it
+//          always has unless deterministic math is asked for.
+//
+//          The polynomials are the ones of fdlibm, good to an ulp or two.
+//
+//------------------------------------------------------------------------
+#include <math.h>
+
+#if defined(_MSC_VER)
+  #pragma fp_contract(off)
+#elif defined(__clang__)
+  #pragma STDC FP_CONTRACT OFF
+#endif
+
+
+//------------------------------- DetSin/DetCos --------------------------
+//
+//  the argument is reduced to r in [-pi/4, pi/4] plus a whole number of
+//  quarter turns, with pi/2 split in two so the reduction is exact for
+//  any angle the game will see
+//------------------------------------------------------------------------
+inline double DetSinKernel(double r)
+{
+  const double S1 = -1.66666666666666324348e-01;
+  const double S2 =  8.33333333332248946124e-03;
+  const double S3 = -1.98412698298579493134e-04;
+  const double S4 =  2.75573137070700676789e-06;
+  const double S5 = -2.50507602534068634195e-08;
+  const double S6 =  1.58969099521155010221e-10;
+
+  double z = r*r;
+
+  return r + z*r*(S1 + z*(S2 + z*(S3 + z*(S4 + z*(S5 + z*S6)))));
+}
+
+inline double DetCosKernel(double r)
+{
+  const double C1 =  4.16666666666666019037e-02;
+  const double C2 = -1.38888888888741095749e-03;
+  const double C3 =  2.48015872894767294178e-05;
+  const double C4 = -2.75573143513906633035e-07;
+  const double C5 =  2.08757232129817482790e-09;
+  const double C6 = -1.13596475577881948265e-11;
+
+  double z = r*r;
+
+  return 1.0 - 0.5*z + z*z*(C1 + z*(C2 + z*(C3 + z*(C4 + z*(C5 + z*C6)))));
+}
+
+//returns the quadrant of x and sets r to what is left of it
+inline int DetReduce(double x, double& r)
+{
+  const double TwoOverPi = 6.36619772367581382433e-01;
+  const double PiOver2Hi = 1.57079632673412561417e+00;
+  const double PiOver2Lo = 6.07710050650619224932e-11;
+
+  double k = floor(x*TwoOverPi + 0.5);
+
+  r = (x - k*PiOver2Hi) - k*PiOver2Lo;
+
+  return (int)((long long)k & 3);
+}
+
+inline double DetSin(double x)
+{
+  double r;
+
+  switch (DetReduce(x, r))
+  {
+  case 0:  return  DetSinKernel(r);
+  case 1:  return  DetCosKernel(r);
+  case 2:  return -DetSinKernel(r);
+  default: return -DetCosKernel(r);
+  }
+}
+
+inline double DetCos(double x)
+{
+  double r;
+
+  switch (DetReduce(x, r))
+  {
+  case 0:  return  DetCosKernel(r);
+  case 1:  return -DetSinKernel(r);
+  case 2:  return -DetCosKernel(r);
+  default: return  DetSinKernel(r);
+  }
+}
+
+inline double DetTan(double x)
+{
+  double r;
+
+  if (DetReduce(x, r) & 1) return -DetCosKernel(r)/DetSinKernel(r);
+
+  return DetSinKernel(r)/DetCosKernel(r);
+}
+
+//---------------------------------- DetAcos -----------------------------
+//
+//  x must be in [-1, 1]
+//------------------------------------------------------------------------
+inline double DetAcos(double x)
+{
+  const double pS0 =  1.66666666666666657415e-01;
+  const double pS1 = -3.25565818622400915405e-01;
+  const double pS2 =  2.01212532134862925881e-01;
+  const double pS3 = -4.00555345006794114027e-02;
+  const double pS4 =  7.91534994289814532176e-04;
+  const double pS5 =  3.47933107596021167570e-05;
+  const double qS1 = -2.40339491173441421878e+00;
+  const double qS2 =  2.02094576023350569471e+00;
+  const double qS3 = -6.88283971605453293030e-01;
+  const double qS4 =  7.70381505559019352791e-02;
+
+  const double PiOver2Hi = 1.57079632679489655800e+00;
+  const double PiOver2Lo = 6.12323399573676603587e-17;
+
+  //asin(sqrt(z)) = sqrt(z) + sqrt(z)*R(z) near zero
+  double z = (fabs(x) < 0.5) ? x*x : (1.0 - fabs(x))*0.5;
+
+  double R = z*(pS0 + z*(pS1 + z*(pS2 + z*(pS3 + z*(pS4 + z*pS5))))) /
+             (1.0 + z*(qS1 + z*(qS2 + z*(qS3 + z*qS4))));
+
+  if (fabs(x) < 0.5)
+  {
+    return PiOver2Hi - (x - (PiOver2Lo - x*R));
+  }
+
+  double s = sqrt(z);
+
+  if (x < 0)
+  {
+    return 2.0*PiOver2Hi - 2.0*(s + (R*s - PiOver2Lo));
+  }
+
+  return 2.0*(s + R*s);
+}
+
+//---------------------------------- DetAtan2 ----------------------------
+//
+//  the smaller of |x| and |y| over the larger is in [0, 1], and is taken
+//  down to [-tan(pi/8), tan(pi/8)] with atan(a) = pi/4 + atan((a-1)/(a+1))
+//  if it is above tan(pi/8). Returns 0 for the origin
+//------------------------------------------------------------------------
+inline double DetAtan2(double y, double x)
+{
+  const double aT[] =
+  {
+     3.33333333333329318027e-01,
+    -1.99999999998764832476e-01,
+     1.42857142725034663711e-01,
+    -1.11111104054623557880e-01,
+     9.09088713343650656196e-02,
+    -7.69187620504482999495e-02,
+     6.66107313738753120669e-02,
+    -5.83357013379057348645e-02,
+     4.97687799461593236017e-02,
+    -3.65315727442169155270e-02,
+     1.62858201153657823623e-02
+  };
+
+  const double PiOver4   = 7.85398163397448278999e-01;
+  const double PiOver2   = 1.57079632679489655800e+00;
+  const double Pi        = 3.14159265358979311600e+00;
+  const double TanPiOver8 = 4.14213562373095034165e-01;
+
+  double ax = fabs(x);
+  double ay = fabs(y);
+
+  if (ax == 0 && ay == 0) return 0.0;
+
+  bool swapped = ay > ax;
+
+  double a = swapped ? ax/ay : ay/ax;
+  double offset = 0.0;
+
+  if (a > TanPiOver8)
+  {
+    a = (a - 1.0)/(a + 1.0);
+    offset = PiOver4;
+  }
+
+  double z = a*a;
+  double w = z*z;
+
+  double s1 = z*(aT[0] + w*(aT[2] + w*(aT[4] + w*(aT[6] + w*(aT[8] + w*aT[10])))));
+  double s2 = w*(aT[1] + w*(aT[3] + w*(aT[5] + w*(aT[7] + w*aT[9]))));
+
+  double angle = offset + (a - a*(s1 + s2));
+
+  if (swapped) angle = PiOver2 - angle;
+  if (x < 0)   angle = Pi - angle;
+
+  return (y < 0) ? -angle : angle;
+}
+
+
+//------------------------------------------------------------------------
+//
+//  switches the game between the library functions and the ones above.
+//  The switches are for the whole program and should be set before any
+//  threads are started. The random number generator is kept per thread
+//  on every platform, which rand() only is with MSVC, and can be switched
+//  on by itself with UseRandom
+//------------------------------------------------------------------------
+class DetMath
+{
+private:
+
+  static bool& InUseFlag()
+  {
+    static bool bInUse = false;
+
+    return bInUse;
+  }
+
+  static bool& RandomInUseFlag()
+  {
+    static bool bRandomInUse = false;
+
+    return bRandomInUse;
+  }
+
+  static unsigned long long& RandomState()
+  {
+    static thread_local unsigned long long state = 0;
+
+    return state;
+  }
+
+public:
+
+  static void Use(bool on){InUseFlag() = on; RandomInUseFlag() = on;}
+
+  static bool InUse(){return InUseFlag();}
+
+  //draws the random numbers from the generator below without changing the math
+  static void UseRandom(bool on){RandomInUseFlag() = on;}
+
+  static bool RandomInUse(){return RandomInUseFlag();}
+
+  static double Sin(double x){return InUse() ? DetSin(x) : sin(x);}
+  static double Cos(double x){return InUse() ? DetCos(x) : cos(x);}
+  static double Tan(double x){return InUse() ? DetTan(x) : tan(x);}
+  static double Acos(double x){return InUse() ? DetAcos(x) : acos(x);}
+  static double Atan2(double y, double x){return InUse() ? DetAtan2(y, x) : atan2(y, x);}
+
+  static float Sin(float x){return InUse() ? (float)DetSin(x) : sinf(x);}
+  static float Cos(float x){return InUse() ? (float)DetCos(x) : cosf(x);}
+
+  //seeds this thread's generator
+  static void SeedRandom(unsigned int seed){RandomState() = seed;}
+
+  //the next 64 random bits of this thread's generator (splitmix64)
+  static unsigned long long Random()
+  {
+    unsigned long long z = (RandomState() += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
+  }
+
+  //a random double in [0, 1)
+  static double RandomDouble(){return (double)(Random() >> 11) * (1.0/9007199254740992.0);}
+};
+
+
+#endif
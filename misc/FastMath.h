@@ -0,0 +1,162 @@
+#ifndef FASTMATH_H
+#define FASTMATH_H
+//------------------------------------------------------------------------
+//
+//  Name:   FastMath.h
+//
+//  Desc:   approximate square roots, normalization, acos and atan2 for the
+//          decision making, where a few parts in a million don't change
+//          what a player decides to do. The square roots start from the
+//          SSE reciprocal square root estimate, or from the usual bit
+//          trick without SSE or when deterministic math is on (the SSE
+//          estimate isn't the same on every CPU), and are refined with
+//          Newton-Raphson steps. acos and atan2 are short polynomials.
+//
+//          FastMath::Sqrt and friends give the exact results until
+//          FastMath::Use(true) is called. Nothing that moves the players
+//          or the ball may use them.
+//
+//------------------------------------------------------------------------
+#include <math.h>
+#include <string.h>
+
+#include "misc/DetMath.h"
+#include "misc/simd.h"
+#include "2D/Vector2D.h"
+
+
+//----------------------------- FastInvSqrt ------------------------------
+//
+//  1/sqrt(x) to about one part in 10^7. x must be a normal positive
+//  number no larger than a float can hold
+//------------------------------------------------------------------------
+inline double FastInvSqrt(double x)
+{
+  double y;
+
+#ifdef SIMD_SSE2
+  if (!DetMath::InUse())
+  {
+    //the estimate is good to 12 bits, one step doubles that
+    y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss((float)x)));
+
+    return y*(1.5 - 0.5*x*y*y);
+  }
+#endif
+
+  //the estimate is good to 4 bits, three steps take it past 30
+  long long i;
+  memcpy(&i, &x, sizeof(i));
+  i = 0x5fe6eb50c7b537a9LL - (i >> 1);
+  memcpy(&y, &i, sizeof(y));
+
+  y = y*(1.5 - 0.5*x*y*y);
+  y = y*(1.5 - 0.5*x*y*y);
+
+  return y*(1.5 - 0.5*x*y*y);
+}
+
+//------------------------------- FastAcos -------------------------------
+//
+//  acos to within 7e-5 radians (Abramowitz and Stegun 4.4.45). x must be
+//  in [-1, 1]
+//------------------------------------------------------------------------
+inline double FastAcos(double x)
+{
+  const double Pi = 3.14159265358979311600e+00;
+
+  double ax = fabs(x);
+
+  double angle = sqrt(1.0 - ax)*(1.5707288 + ax*(-0.2121144 + ax*(0.0742610 - ax*0.0187293)));
+
+  return (x < 0) ? Pi - angle : angle;
+}
+
+//------------------------------ FastAtan2 -------------------------------
+//
+//  atan2 to within 1e-5 radians (Abramowitz and Stegun 4.4.49). Returns 0
+//  for the origin
+//------------------------------------------------------------------------
+inline double FastAtan2(double y, double x)
+{
+  const double PiOver2 = 1.57079632679489655800e+00;
+  const double Pi      = 3.14159265358979311600e+00;
+
+  double ax = fabs(x);
+  double ay = fabs(y);
+
+  if (ax == 0 && ay == 0) return 0.0;
+
+  bool swapped = ay > ax;
+
+  double a = swapped ? ax/ay : ay/ax;
+  double s = a*a;
+
+  double angle = a*(0.9998660 + s*(-0.3302995 + s*(0.1801410 + s*(-0.0851330 + s*0.0208351))));
+
+  if (swapped) angle = PiOver2 - angle;
+  if (x < 0)   angle = Pi - angle;
+
+  return (y < 0) ? -angle : angle;
+}
+
+
+//------------------------------------------------------------------------
+//
+//  switches the decision making between exact and approximate math. The
+//  switch is for the whole program and should be set before any threads
+//  are started
+//------------------------------------------------------------------------
+class FastMath
+{
+private:
+
+  static bool& InUseFlag()
+  {
+    static bool bInUse = false;
+
+    return bInUse;
+  }
+
+  //outside this range the approximations aren't used, so that FastInvSqrt
+  //never sees a zero, a denormal or more than a float holds
+  static bool InRange(double x){return (x > 1e-30) && (x < 1e30);}
+
+public:
+
+  static void Use(bool on){InUseFlag() = on;}
+
+  static bool InUse(){return InUseFlag();}
+
+  static double Sqrt(double x)
+  {
+    if (!InUse() || !InRange(x)) return sqrt(x);
+
+    return x*FastInvSqrt(x);
+  }
+
+  //same as Vec2DDistance, which adds the y term first
+  static double Distance(const Vector2D& v1, const Vector2D& v2)
+  {
+    double ySeparation = v2.y - v1.y;
+    double xSeparation = v2.x - v1.x;
+
+    return Sqrt(ySeparation*ySeparation + xSeparation*xSeparation);
+  }
+
+  static Vector2D Normalize(const Vector2D& v)
+  {
+    double LengthSq = v.LengthSq();
+
+    if (!InUse() || !InRange(LengthSq)) return Vec2DNormalize(v);
+
+    return v*FastInvSqrt(LengthSq);
+  }
+
+  static double Acos(double x){return InUse() ? FastAcos(x) : DetMath::Acos(x);}
+
+  static double Atan2(double y, double x){return InUse() ? FastAtan2(y, x) : DetMath::Atan2(y, x);}
+};
+
+
+#endif
@@ -3,7 +3,7 @@
 
 FrameCounter* FrameCounter::Instance()
 {
-  static FrameCounter instance;
+  static thread_local FrameCounter instance;
 
   return &instance;
 }
\ No newline at end of file
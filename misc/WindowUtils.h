@@ -5,7 +5,12 @@
 #include <windows.h>
 #include <string>
 
-struct Vector2D;
+template <class real> struct Vector2DT;
+#ifdef SINGLE_PRECISION
+typedef Vector2DT<float> Vector2D;
+#else
+typedef Vector2DT<double> Vector2D;
+#endif
 
 //macro to detect keypresses
 #define KEYDOWN(vk_code) ((GetAsyncKeyState(vk_code) & 0x8000) ? 1 : 0)
@@ -10,6 +10,9 @@
 //        automatically be added to the list. Whenever it is destroyed
 //        it will automatically be removed.
 //
+//        The lists are kept per thread, so objects created on one
+//        thread never see the objects created on another.
+//
 //Author: Mat Buckland (fup@ai-junkie.com)
 //
 //------------------------------------------------------------------------
@@ -25,7 +28,7 @@ public:
   
 private:
 
-  static ObjectList m_Members;
+  static thread_local ObjectList m_Members;
 
 protected:
 
@@ -48,7 +51,7 @@ public:
 
 
 template <class T>
-std::list<T*> AutoList<T>::m_Members;
+thread_local std::list<T*> AutoList<T>::m_Members;
 
 
 
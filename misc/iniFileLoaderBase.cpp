@@ -84,7 +84,7 @@ void iniFileLoaderBase::GetParameterValueAsString(string& line)
     }
   }
     
-  line = line.substr(begIdx, endIdx);
+  line = line.substr(begIdx, endIdx - begIdx);
 }
 
 //--------------------------- GetNextToken ------------------------------------
@@ -122,7 +122,7 @@ std::string iniFileLoaderBase::GetNextToken()
     }
   }
     
-  string s = CurrentLine.substr(begIdx, endIdx);
+  string s = CurrentLine.substr(begIdx, endIdx - begIdx);
 
   if (endIdx != CurrentLine.length())
   {
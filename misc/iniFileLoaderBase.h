@@ -48,6 +48,7 @@ public:
   float       GetNextParameterFloat(){if (m_bGoodFile) return (float)atof(GetNextParameter().c_str());throw std::runtime_error("bad file");}
   int         GetNextParameterInt(){if (m_bGoodFile) return atoi(GetNextParameter().c_str());throw std::runtime_error("bad file");}
   bool        GetNextParameterBool(){return (bool)(atoi(GetNextParameter().c_str()));throw std::runtime_error("bad file");}
+  std::string GetNextParameterString(){if (m_bGoodFile) return GetNextParameter();throw std::runtime_error("bad file");}
 
   double      GetNextTokenAsDouble(){if (m_bGoodFile) return atof(GetNextToken().c_str()); throw std::runtime_error("bad file");}
   float       GetNextTokenAsFloat(){if (m_bGoodFile) return (float)atof(GetNextToken().c_str()); throw std::runtime_error("bad file");}
@@ -57,7 +58,7 @@ public:
   bool        eof()const{if (m_bGoodFile) return file.eof(); throw std::runtime_error("bad file");}
   bool        FileIsGood()const{return m_bGoodFile;}
 
-  iniFileLoaderBase(char* filename):CurrentLine(""), m_bGoodFile(true)
+  iniFileLoaderBase(const char* filename):CurrentLine(""), m_bGoodFile(true)
   {
     file.open(filename);
 
@@ -0,0 +1,39 @@
+#ifndef SIMD_H
+#define SIMD_H
+//------------------------------------------------------------------------
+//
+//  Name: simd.h
+//
+//  Desc: defines SIMD_SSE2 when the compiler is targetting a CPU with
+//        SSE2 (always the case for x64 builds, or x86 builds using
+//        /arch:SSE2) and pulls in the intrinsics. Any code using the
+//        intrinsics must provide a scalar path for when SIMD_SSE2 is
+//        not defined.
+//
+//------------------------------------------------------------------------
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+  #define SIMD_SSE2
+  #include <emmintrin.h>
+#endif
+
+//number of floats in an SSE register. Arrays processed by the SIMD
+//kernels are padded to a multiple of this
+const int SimdFloatWidth = 4;
+
+//number of doubles in an SSE register
+const int SimdDoubleWidth = 2;
+
+//number of elements of type T in an SSE register
+template <class T>
+struct SimdWidth
+{
+  enum { value = (int)(16 / sizeof(T)) };
+};
+
+//rounds n up to the next multiple of SimdFloatWidth
+inline int SimdPaddedSize(int n)
+{
+  return (n + SimdFloatWidth - 1) & ~(SimdFloatWidth - 1);
+}
+
+#endif
@@ -17,6 +17,8 @@
 #include <cassert>
 #include <iomanip>
 
+#include "misc/DetMath.h"
+
 
 
 //a few useful constants
@@ -78,13 +80,35 @@ T Maximum(const T& v1, const T& v2)
 
 //----------------------------------------------------------------------------
 //  some random number functions.
+//
+//  they are all built on rand(), or on the generator of DetMath when it is
+//  in use. That one gives the same sequence on every platform and is kept
+//  per thread, so a thread that seeds it gets a repeatable sequence no
+//  matter what the other threads are doing
 //----------------------------------------------------------------------------
 
+//seeds rand() and this thread's DetMath generator
+inline void SeedRandom(unsigned int seed)
+{
+  srand(seed);
+  DetMath::SeedRandom(seed);
+}
+
 //returns a random integer between x and y
-inline int   RandInt(int x,int y) {return rand()%(y-x+1)+x;}
+inline int   RandInt(int x,int y)
+{
+  if (DetMath::RandomInUse()) return (int)(DetMath::Random() % (unsigned int)(y-x+1)) + x;
+
+  return rand()%(y-x+1)+x;
+}
 
 //returns a random double between zero and 1
-inline double RandFloat()      {return ((rand())/(RAND_MAX+1.0));}
+inline double RandFloat()
+{
+  if (DetMath::RandomInUse()) return DetMath::RandomDouble();
+
+  return ((rand())/(RAND_MAX+1.0));
+}
 
 inline double RandInRange(double x, double y)
 {
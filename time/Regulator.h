@@ -19,6 +19,56 @@
 
 
 
+//------------------------------------------------------------------------
+//
+//  the regulators normally read the system timer. A thread that runs the
+//  game faster (or slower) than real time can switch the regulators it
+//  uses over to a simulated clock that it advances itself, once per
+//  update. The clock is kept per thread.
+//------------------------------------------------------------------------
+class RegulatorClock
+{
+private:
+
+  struct ClockState
+  {
+    bool   bSimulated;
+    double dTime;
+
+    ClockState():bSimulated(false), dTime(0.0){}
+  };
+
+  static ClockState& State()
+  {
+    static thread_local ClockState state;
+
+    return state;
+  }
+
+public:
+
+  //switches this thread's regulators to the simulated clock and sets it
+  //to zero
+  static void UseSimulatedTime(){State().bSimulated = true; State().dTime = 0.0;}
+
+  //switches this thread's regulators back to the system timer
+  static void UseSystemTime(){State().bSimulated = false;}
+
+  //true if this thread's regulators are on the simulated clock
+  static bool Simulated(){return State().bSimulated;}
+
+  //moves the simulated clock on by the given number of milliseconds
+  static void Advance(double milliseconds){State().dTime += milliseconds;}
+
+  //the current time in milliseconds
+  static DWORD Now()
+  {
+    if (State().bSimulated) return (DWORD)State().dTime;
+
+    return timeGetTime();
+  }
+};
+
 
 class Regulator
 {
@@ -36,7 +86,7 @@ public:
   
   Regulator(double NumUpdatesPerSecondRqd)
   {
-    m_dwNextUpdateTime = (DWORD)(timeGetTime()+RandFloat()*1000);
+    Restart();
 
     if (NumUpdatesPerSecondRqd > 0)
     {
@@ -55,6 +105,14 @@ public:
   }
 
 
+  //schedules the first update at a random time within the next second so
+  //that regulators created together don't all fire on the same update
+  void Restart()
+  {
+    m_dwNextUpdateTime = (DWORD)(RegulatorClock::Now()+RandFloat()*1000);
+  }
+
+
   //returns true if the current time exceeds m_dwNextUpdateTime
   bool isReady()
   {
@@ -66,7 +124,7 @@ public:
     //never allow the code to flow
     if (m_dUpdatePeriod < 0) return false;
 
-    DWORD CurrentTime = timeGetTime();
+    DWORD CurrentTime = RegulatorClock::Now();
 
     //the number of milliseconds the update period can vary per required
     //update-step. This is here to make sure any multiple clients of this class
@@ -82,6 +140,18 @@ public:
 
     return false;
   }
+
+
+  //returns true if isReady would let the code flow if it were called now.
+  //Unlike isReady this doesn't schedule the next update
+  bool isDue()const
+  {
+    if (isEqual(0.0, m_dUpdatePeriod)) return true;
+
+    if (m_dUpdatePeriod < 0) return false;
+
+    return RegulatorClock::Now() >= m_dwNextUpdateTime;
+  }
 };
 
 